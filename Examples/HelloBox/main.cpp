@@ -21,13 +21,83 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "BogDog.h"
 
-int main(void)
+/**
+ * The RenderThread's frame callback, the capture has to read the frame on the thread that owns the context.
+ */
+static void CaptureOnRenderThread(BogDog::RenderFrame& frame,void* capture)
+{
+  ((BogDog::FrameCapture*)capture)->CaptureFrame();
+}
+
+int main(int argc, char *argv[])
 {
+  //Run with -instanced to draw the boxes with GLShader::DrawInstanced instead of the Batcher.
+  //Run with -trace file.json to save a Chrome trace of the last frames when it exits, needs BD_PROFILE.
+  //Run with -headless to draw offscreen without a display, -frames N to stop after N frames.
+  //Run with -gltrace file.bdt to record the GL calls for tools/bdreplay, needs BD_GL_TRACE.
+  //Run with -threaded to record the boxes into a CommandBuffer and draw them on a RenderThread, overrides -instanced.
+  //Run with -capture file to record the frames to a .y4m, .png (frame.png writes frame00000.png on), or raw file, -capture-every N for every N'th frame.
+  bool instanced = false;
+  bool threaded = false;
+  bool headless = false;
+  int maxFrames = 0;
+  const char* traceFile = NULL;
+  const char* glTraceFile = NULL;
+  const char* captureFile = NULL;
+  int captureInterval = 1;
+  for( int arg = 1 ; arg < argc ; arg++ )
+  {
+	  if( strcmp(argv[arg],"-instanced") == 0 )
+	  {
+		  instanced = true;
+	  }
+	  else if( strcmp(argv[arg],"-threaded") == 0 )
+	  {
+		  threaded = true;
+	  }
+	  else if( strcmp(argv[arg],"-trace") == 0 && arg + 1 < argc )
+	  {
+		  traceFile = argv[++arg];
+	  }
+	  else if( strcmp(argv[arg],"-gltrace") == 0 && arg + 1 < argc )
+	  {
+		  glTraceFile = argv[++arg];
+	  }
+	  else if( strcmp(argv[arg],"-capture") == 0 && arg + 1 < argc )
+	  {
+		  captureFile = argv[++arg];
+	  }
+	  else if( strcmp(argv[arg],"-capture-every") == 0 && arg + 1 < argc )
+	  {
+		  captureInterval = atoi(argv[++arg]);
+	  }
+	  else if( strcmp(argv[arg],"-headless") == 0 )
+	  {
+		  headless = true;
+	  }
+	  else if( strcmp(argv[arg],"-frames") == 0 && arg + 1 < argc )
+	  {
+		  maxFrames = atoi(argv[++arg]);
+	  }
+  }
+
+  if( threaded )
+  {
+	  instanced = false;
+  }
+
   printf("\n**************** Starting app ****************\n");
+  if( glTraceFile != NULL )
+  {
+	  BogDog::GLTrace::Start(glTraceFile);
+  }
+
   BogDog::OpenGLES_2_0 gl;
-  if(gl.Create(false) == false )
+  if( (headless ? gl.CreateHeadless(640,480) : gl.Create(false)) == false )
   {
 	  return 1;
   }
@@ -39,30 +109,63 @@ int main(void)
   theView.SetCamera(0,0,-40,0,0,0);
 
   BogDog::GLShaderColour* colourShader = BogDog::GLShaderColour::Allocate();
-  BogDog::Mesh* box = BogDog::ShapeBuilder::MakeBox(0.7f,0.7f,0.7f)->BuildMesh(true,false);
+  BogDog::Mesh* box = BogDog::ShapeBuilder::MakeBox(0.7f,0.7f,0.7f)->BuildMesh(true,false,true,true);
 
   BogDog::Matrix boxRot;
+  BogDog::Batcher batcher;
+
+  BogDog::GLShaderColourInstanced* instancedShader = BogDog::GLShaderColourInstanced::Allocate();
+  BogDog::Mesh* instancedBox = BogDog::Mesh::CreateInstanced(box,instancedShader->getMaxInstances());
+  BogDog::Matrix boxTransforms[31*31];
+  uint32_t boxColours[31*31];
 
   CHECK_OGL_ERRORS();
 
   BogDog::Timer timer;
   timer.Start();
 
+  BogDog::FramePacer pacer(60.0f);
+
+  BogDog::FrameCapture capture(gl);
+  if( captureFile != NULL && !capture.Start(captureFile,BogDog::FrameCapture::GetFormatFromName(captureFile),captureInterval) )
+  {
+	  return 1;
+  }
+
+  BogDog::RenderThread renderThread(gl);
+  renderThread.SetFrameCallback(CaptureOnRenderThread,&capture);
+  if( threaded && !renderThread.Start() )
+  {
+	  return 1;
+  }
+
   BogDog::Matrix ma,mb;
 
   int numDrawn = 0;
+  int frameCount = 0;
   int n = 0;
   Angle a = 0;
   float time = 0;
-  while(BogDog::OpenGLES_2_0::ApplicationRunning())
+  while(BogDog::OpenGLES_2_0::ApplicationRunning() && (maxFrames == 0 || frameCount++ < maxFrames))
   {
-	  usleep(10000);
 	  a += 200;
 	  theView.SetCamera(BogDog::Sin(a) * -40,0,BogDog::Cos(a) * -40,0,a,0);
 
 	  const BogDog::Matrix& projectionInvCamera = theView.GetProjectionCameraMatrix();
 
-	  gl.Clear(0);
+	  BogDog::RenderFrame* frame = NULL;
+	  if( threaded )
+	  {
+		  frame = renderThread.BeginFrame();
+		  frame->projInvcam = projectionInvCamera;
+		  frame->clearColour = 0;
+		  frame->commands.UseShader(colourShader);
+		  frame->commands.BindMesh(box);
+	  }
+	  else
+	  {
+		  gl.Clear(0);
+	  }
 
 	  n++;
 	  if( n == 60 )
@@ -70,40 +173,95 @@ int main(void)
 		  timer.Stop();
 		  timer.Start();
 		  n = 0;
-		  printf("FPS = %f numDrawn(%d)\n",60.0f / timer.GetSeconds(),numDrawn);
+		  printf("FPS = %f numDrawn(%d) drawCalls(%d)\n",60.0f / timer.GetSeconds(),numDrawn,threaded ? numDrawn : instanced ? (numDrawn + instancedBox->getInstanceCopies() - 1) / instancedBox->getInstanceCopies() : batcher.getDrawCalls());
+#ifdef BD_PROFILE
+		  BogDog::Profiler::PrintLastFrame();
+#endif
 	  }
 
-	  colourShader->Enable(projectionInvCamera);
-
-	  box->Enable();
+	  batcher.SetMaterial(colourShader);
 
 	  boxRot.SetRotation(a,a*3,a*2);
-	  colourShader->setTransform(boxRot);
-	  colourShader->setGlobalColour(1,1,1,1);
 
 	  numDrawn = 0;
-	  for( float x = -15 ; x <= 15 ; x += 1.0f )
 	  {
-		  for( float y = -15 ; y <= 15 ; y += 1.0f )
+		  BD_PROFILE_SCOPE("Simulate");
+		  for( float x = -15 ; x <= 15 ; x += 1.0f )
 		  {
-			  float cs = (BogDog::Sin((Angle)(int)((x + y + time)*2000.0f)) + 1.0f) * 0.5f;
-
-			  colourShader->setGlobalColour(cs,cs,cs,0.2f);
+			  for( float y = -15 ; y <= 15 ; y += 1.0f )
+			  {
+				  float cs = (BogDog::Sin((Angle)(int)((x + y + time)*2000.0f)) + 1.0f) * 0.5f;
 
-			  boxRot[3].x = x;
-			  boxRot[3].y = y;
-			  boxRot[3].z = cs * 10.0f;
-			  colourShader->setTransform(boxRot);
-			  box->Draw();
-			  numDrawn++;
+				  boxRot[3].x = x;
+				  boxRot[3].y = y;
+				  boxRot[3].z = cs * 10.0f;
+				  if( threaded )
+				  {
+					  frame->commands.DrawMesh(box,boxRot,cs,cs,cs,0.2f);
+				  }
+				  else if( instanced )
+				  {
+					  const uint32_t grey = (uint32_t)(cs * 255.0f);
+					  boxTransforms[numDrawn] = boxRot;
+					  boxColours[numDrawn] = (51u<<24) | (grey<<16) | (grey<<8) | grey;
+				  }
+				  else
+				  {
+					  batcher.Submit(box,boxRot,cs,cs,cs,0.2f);
+				  }
+				  numDrawn++;
+			  }
 		  }
 	  }
 	  time += 1.0f;
 
+	  if( threaded )
+	  {
+		  renderThread.SubmitFrame(frame);
+		  pacer.EndFrame();
+		  BD_PROFILE_FRAME();
+		  continue;
+	  }
+
+	  if( instanced )
+	  {
+		  instancedShader->Enable(projectionInvCamera);
+		  instancedShader->DrawInstanced(instancedBox,boxTransforms,boxColours,numDrawn);
+	  }
+	  else
+	  {
+		  batcher.Flush(projectionInvCamera);
+		  batcher.EndFrame();
+	  }
+
+	  capture.CaptureFrame();
 	  gl.Update();
+	  pacer.EndFrame();
+	  BD_PROFILE_FRAME();
   };
 
+  if( threaded )
+  {
+	  renderThread.Stop();
+	  printf("RenderThread: %d frames, simulation waited %.3f seconds, render waited %.3f seconds\n",renderThread.getFramesRendered(),renderThread.getSimulationWaitSeconds(),renderThread.getRenderWaitSeconds());
+  }
+
+  if( traceFile != NULL )
+  {
+	  BogDog::Profiler::WriteChromeTrace(traceFile);
+  }
+  BogDog::GLTrace::Stop();
+  capture.Stop();
+
+  pacer.PrintReport();
+  BogDog::GLResources::PrintReport();
+  BogDog::OpenGLES_2_0::GetStateCache().PrintCounters();
+  BogDog::OpenGLES_2_0::PrintFrameStats();
+
+  delete instancedBox;
+  delete instancedShader;
   delete colourShader;
+  delete box;
 
   return 0;
 }
@@ -105,6 +105,8 @@ int main(void)
   BogDog::Timer timer;
   timer.Start();
 
+  BogDog::FramePacer pacer(60.0f);
+
 //  GLint tex = MakeTexture(gl,256,256);
   GLint tex = LoadTexture(gl);
 
@@ -121,7 +123,7 @@ int main(void)
 
 	  colourShader->Enable(projectionInvCamera);
 	  colourShader->setTexture(0,tex);
-	  box->Enable();
+	  box->Enable(colourShader);
 
 	  boxRot.SetRotation(a,a*3,a*2);
 	  colourShader->setTransform(boxRot);
@@ -130,10 +132,14 @@ int main(void)
 	  time += 1.0f;
 
 	  gl.Update();
+	  pacer.EndFrame();
   };
 
   std::cout << "Application exiting" << std::endl;
 
+  gl.DeleteTexture(tex);
+  delete box;
+  delete boxBuilder;
   delete colourShader;
 
   return 0;
@@ -31,6 +31,9 @@
 #include "Common.h"
 #include "DynamicBuffer.h"
 #include "Timer.h"
+#include "FramePacer.h"
+#include "LiveMetrics.h"
+#include "Profiler.h"
 #include "View.h"
 
 #include "maths/SinCos.h"
@@ -39,13 +42,29 @@
 #include "maths/Vector3.h"
 
 #include "gl/OpenGLES20.h"
+#include "gl/FrameStats.h"
 #include "gl/GLBuffer.h"
+#include "gl/GLResources.h"
+#include "gl/GLStateCache.h"
+#include "gl/GLStreamBuffer.h"
+#include "gl/GLTrace.h"
+#include "gl/NullGL.h"
+#include "gl/VertexFormat.h"
 #include "gl/GLShader.h"
 #include "gl/GLShaderColour.h"
+#include "gl/GLShaderColourInstanced.h"
 #include "gl/GLShaderColourTex.h"
 
+#include "gfx/Material.h"
 #include "gfx/Mesh.h"
 #include "gfx/ShapeBuilder.h"
+#include "gfx/VertexWelder.h"
+#include "gfx/MeshOptimiser.h"
+#include "gfx/Batcher.h"
+#include "gfx/RenderQueue.h"
+#include "gfx/CommandBuffer.h"
+#include "gfx/RenderThread.h"
+#include "gfx/FrameCapture.h"
 #include "gfx/ImageLoader.h"
 
 #endif /* BOGDOG_H_ */
@@ -0,0 +1,212 @@
+/*
+ * FramePacer.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "FramePacer.h"
+#include "gl/OpenGLES20.h"
+
+namespace BogDog
+{
+
+static const int64_t NANOSECONDS = 1000000000;
+static const float MAX_DELTA_SECONDS = 0.1f;
+static const float SMOOTHING = 0.1f;		//!<How much of each new frame time goes into the smoothed one.
+static const int LATE_FRAMES_TO_TEAR = 3;	//!<Misses in a row before vsync is turned off.
+static const int FAST_FRAMES_TO_SYNC = 60;	//!<Frames in a row with time to spare before vsync goes back on.
+
+FramePacer::FramePacer(float pTargetRate)
+{
+	adaptiveGL = NULL;
+	swapInterval = 1;
+	lateRun = 0;
+	fastRun = 0;
+	SetTargetRate(pTargetRate);
+	smoothedSeconds = targetRate > 0.0f ? 1.0f / targetRate : 1.0f / 60.0f;
+	workSeconds = 0.0f;
+	frameSeconds = smoothedSeconds;
+	frameStart = Now();
+	deadline = frameStart + period;
+	ResetStats();
+}
+
+void FramePacer::SetTargetRate(float pTargetRate)
+{
+	targetRate = pTargetRate > 0.0f ? pTargetRate : 0.0f;
+	period = targetRate > 0.0f ? (int64_t)(NANOSECONDS / targetRate) : 0;
+	deadline = Now() + period;
+}
+
+void FramePacer::SetAdaptiveSwapInterval(OpenGLES_2_0* gl)
+{
+	adaptiveGL = gl;
+	swapInterval = 1;
+	lateRun = 0;
+	fastRun = 0;
+	if( adaptiveGL != NULL )
+	{
+		adaptiveGL->SetSwapInterval(swapInterval);
+	}
+}
+
+void FramePacer::EndFrame()
+{
+	int64_t now = Now();
+	const int64_t work = now - frameStart;
+	const bool late = period > 0 && now > deadline;
+
+	if( adaptiveGL != NULL && period > 0 )
+	{
+		AdaptSwapInterval(late,work);
+	}
+
+	if( period > 0 )
+	{
+		if( late )
+		{// Start again from now rather than rushing the next frames to catch up.
+			deadline = now;
+		}
+		else
+		{
+			struct timespec until;
+			until.tv_sec = deadline / NANOSECONDS;
+			until.tv_nsec = deadline % NANOSECONDS;
+			while( clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&until,NULL) == EINTR )
+			{
+			}
+			now = Now();
+		}
+		deadline += period;
+	}
+
+	workSeconds = (float)work / NANOSECONDS;
+	frameSeconds = (float)(now - frameStart) / NANOSECONDS;
+	frameStart = now;
+
+	const float delta = frameSeconds < MAX_DELTA_SECONDS ? frameSeconds : MAX_DELTA_SECONDS;
+	smoothedSeconds += (delta - smoothedSeconds) * SMOOTHING;
+
+	const float milliseconds = frameSeconds * 1000.0f;
+	const int bucket = (int)milliseconds;
+	histogram[bucket < HISTOGRAM_BUCKETS ? bucket : HISTOGRAM_BUCKETS - 1]++;
+	totalMilliseconds += milliseconds;
+	if( milliseconds > worstMilliseconds )
+	{
+		worstMilliseconds = milliseconds;
+	}
+	frameCount++;
+	if( late )
+	{
+		missedFrames++;
+	}
+}
+
+float FramePacer::GetPercentile(float percent)
+{
+	if( frameCount == 0 )
+	{
+		return 0.0f;
+	}
+
+	const int wanted = (int)((frameCount * percent) / 100.0f);
+	int count = 0;
+	for( int n = 0 ; n < HISTOGRAM_BUCKETS ; n++ )
+	{
+		count += histogram[n];
+		if( count > wanted )
+		{
+			return (float)(n + 1);
+		}
+	}
+	return (float)HISTOGRAM_BUCKETS;
+}
+
+float FramePacer::GetAverageMilliseconds()
+{
+	return frameCount > 0 ? (float)(totalMilliseconds / frameCount) : 0.0f;
+}
+
+void FramePacer::PrintReport()
+{
+	printf("FramePacer: %d frames at target %.1f fps, %d missed, swap interval %d\n",frameCount,targetRate,missedFrames,swapInterval);
+	printf("  average %.2fms worst %.2fms, 50%% under %.0fms 90%% under %.0fms 99%% under %.0fms\n",
+			GetAverageMilliseconds(),worstMilliseconds,GetPercentile(50.0f),GetPercentile(90.0f),GetPercentile(99.0f));
+	for( int n = 0 ; n < HISTOGRAM_BUCKETS ; n++ )
+	{
+		if( histogram[n] > 0 )
+		{
+			printf("  %3d%sms %d\n",n,n == HISTOGRAM_BUCKETS - 1 ? "+" : " ",histogram[n]);
+		}
+	}
+}
+
+void FramePacer::ResetStats()
+{
+	memset(histogram,0,sizeof(histogram));
+	frameCount = 0;
+	missedFrames = 0;
+	totalMilliseconds = 0.0;
+	worstMilliseconds = 0.0f;
+}
+
+void FramePacer::AdaptSwapInterval(bool late,int64_t work)
+{
+	if( late )
+	{
+		fastRun = 0;
+		lateRun++;
+		if( swapInterval != 0 && lateRun >= LATE_FRAMES_TO_TEAR )
+		{
+			swapInterval = 0;
+			adaptiveGL->SetSwapInterval(swapInterval);
+		}
+		return;
+	}
+
+	lateRun = 0;
+	if( swapInterval == 0 )
+	{// Only go back to vsync once the frames are well inside the budget, the wait for vsync will add to them.
+		if( work < (period * 3) / 4 )
+		{
+			fastRun++;
+			if( fastRun >= FAST_FRAMES_TO_SYNC )
+			{
+				swapInterval = 1;
+				fastRun = 0;
+				adaptiveGL->SetSwapInterval(swapInterval);
+			}
+		}
+		else
+		{
+			fastRun = 0;
+		}
+	}
+}
+
+int64_t FramePacer::Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (now.tv_sec * NANOSECONDS) + now.tv_nsec;
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,163 @@
+/*
+ * FramePacer.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEPACER_H_
+#define FRAMEPACER_H_
+
+#include <stdint.h>
+#include <time.h>
+
+namespace BogDog
+{
+
+struct OpenGLES_2_0;
+
+/**
+ * Keeps the frame rate at a target by sleeping until each frame's deadline, so the CPU is idle instead of spinning.
+ * Our units are passively cooled, drawing frames nobody needs just makes them throttle.
+ * Call EndFrame once a frame after OpenGLES_2_0::Update. Uses CLOCK_MONOTONIC so changes to the wall clock don't upset it.
+ * Also gives a smoothed frame time to step the simulation with and keeps a histogram of frame times for reports.
+ *
+ * With adaptive swap interval the pacer turns vsync off when frames keep missing the deadline, so a slow patch tears
+ * a little instead of dropping to half rate, and turns it back on once there is time to spare again.
+ */
+struct FramePacer
+{
+	static const int HISTOGRAM_BUCKETS = 100;	//!<1ms each, the last one has everything 99ms and over.
+
+	/**
+	 * @param targetRate Frames per second, 0 for no limit.
+	 */
+	FramePacer(float targetRate = 60.0f);
+
+	/**
+	 * @param targetRate Frames per second, 0 for no limit.
+	 */
+	void SetTargetRate(float targetRate);
+
+	float GetTargetRate()
+	{
+		return targetRate;
+	}
+
+	/**
+	 * Turns on adaptive swap interval, pass NULL to turn it off. The pacer starts with vsync on.
+	 */
+	void SetAdaptiveSwapInterval(OpenGLES_2_0* gl);
+
+	/**
+	 * Records the frame time and sleeps until the next frame is due.
+	 * If a frame is late the next deadline is from now, we don't try to catch up by running fast.
+	 */
+	void EndFrame();
+
+	/**
+	 * @return The smoothed frame time in seconds, use it as the delta time for the simulation.
+	 * Limited to 0.1 of a second so a long stall does not make things jump.
+	 */
+	float GetDeltaSeconds()
+	{
+		return smoothedSeconds;
+	}
+
+	/**
+	 * @return The time of the last frame in seconds, not including the sleep.
+	 */
+	float GetWorkSeconds()
+	{
+		return workSeconds;
+	}
+
+	/**
+	 * @return The time from the start of the last frame to the start of this one, including the sleep.
+	 */
+	float GetFrameSeconds()
+	{
+		return frameSeconds;
+	}
+
+	/**
+	 * @return The number of frames that went past their deadline since the stats were reset.
+	 */
+	int GetMissedFrames()
+	{
+		return missedFrames;
+	}
+
+	int GetFrameCount()
+	{
+		return frameCount;
+	}
+
+	/**
+	 * @return The swap interval the adaptive mode has set, 1 when it is not on.
+	 */
+	int GetSwapInterval()
+	{
+		return swapInterval;
+	}
+
+	/**
+	 * @param percent 0 to 100, for example 99 for the time 99% of frames were faster than.
+	 * @return The frame time in milliseconds, to the histogram's 1ms resolution.
+	 */
+	float GetPercentile(float percent);
+
+	float GetAverageMilliseconds();
+	float GetWorstMilliseconds()
+	{
+		return worstMilliseconds;
+	}
+
+	/**
+	 * Prints the frame count, misses, average, percentiles and the histogram.
+	 */
+	void PrintReport();
+
+	void ResetStats();
+
+private:
+	float targetRate;
+	int64_t period;				//!<Nanoseconds per frame, 0 for no limit.
+	int64_t frameStart;			//!<When this frame started.
+	int64_t deadline;			//!<When the next frame should start.
+
+	float smoothedSeconds;
+	float workSeconds;
+	float frameSeconds;
+
+	OpenGLES_2_0* adaptiveGL;
+	int swapInterval;
+	int lateRun;				//!<Frames in a row that missed.
+	int fastRun;				//!<Frames in a row with time to spare.
+
+	int histogram[HISTOGRAM_BUCKETS];
+	int frameCount;
+	int missedFrames;
+	double totalMilliseconds;
+	float worstMilliseconds;
+
+	void AdaptSwapInterval(bool late,int64_t work);
+	static int64_t Now();
+};
+
+} /* namespace BogDog */
+#endif /* FRAMEPACER_H_ */
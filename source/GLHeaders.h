@@ -11,6 +11,13 @@
 #ifdef TARGET_GLES
 	#include "GLES2/gl2.h"
 	#include "EGL/egl.h"
+	#include "EGL/eglext.h"
+	#ifndef EGL_PLATFORM_SURFACELESS_MESA
+		#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+	#endif
+#endif
+
+#ifdef PLATFORM_MESA
 	#include <gbm.h> //sudo apt install libgbm-dev
 #endif
 
@@ -18,5 +25,6 @@
 	#include "bcm_host.h"
 #endif
 
+#include "gl/GLTrace.h"
 
 #endif //#ifndef __GLHEADERS_H__
@@ -0,0 +1,254 @@
+/*
+ * LiveMetrics.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <malloc.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "LiveMetrics.h"
+
+namespace BogDog
+{
+
+static const int MAX_NAME = 64;
+static const int READ_ATTEMPTS = 100;
+
+LiveMetricsSegment* LiveMetrics::segment = NULL;
+
+static char segmentName[MAX_NAME] = "";
+static LiveMetricsData pending;			// Built here then copied into the segment in one go, so the odd window is short.
+static int64_t lastFrameTime = 0;
+
+static int64_t Now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return ((int64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+}
+
+static uint64_t HeapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+#else
+	struct mallinfo info = mallinfo();
+#endif
+	return (uint64_t)info.uordblks + (uint64_t)info.hblkhd;
+}
+
+static void CloseAtExit()
+{
+	LiveMetrics::Close();
+}
+
+bool LiveMetrics::Open(const char* name)
+{
+	if( segment != NULL )
+	{
+		printf("LiveMetrics::Open: %s is already open\n",segmentName);
+		return false;
+	}
+
+	if( name != NULL )
+		snprintf(segmentName,MAX_NAME,"%s%s",name[0] == '/' ? "" : "/",name);
+	else
+		snprintf(segmentName,MAX_NAME,"/bogdog.%d",(int)getpid());
+
+	const int fd = shm_open(segmentName,O_CREAT | O_RDWR | O_TRUNC,0644);
+	if( fd < 0 )
+	{
+		printf("LiveMetrics::Open: could not create %s\n",segmentName);
+		return false;
+	}
+
+	if( ftruncate(fd,sizeof(LiveMetricsSegment)) != 0 )
+	{
+		printf("LiveMetrics::Open: could not size %s\n",segmentName);
+		close(fd);
+		shm_unlink(segmentName);
+		return false;
+	}
+
+	void* mapped = mmap(NULL,sizeof(LiveMetricsSegment),PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if( mapped == MAP_FAILED )
+	{
+		printf("LiveMetrics::Open: could not map %s\n",segmentName);
+		shm_unlink(segmentName);
+		return false;
+	}
+
+	// The sequence stays odd until the header is filled in, so a reader that attaches early waits.
+	segment = (LiveMetricsSegment*)mapped;
+	segment->sequence.store(1,std::memory_order_relaxed);
+	memset(&pending,0,sizeof(pending));
+	memcpy(segment->magic,"BDLM",4);
+	segment->version = VERSION;
+	segment->size = sizeof(LiveMetricsSegment);
+	segment->pid = (uint32_t)getpid();
+	segment->data = pending;
+	segment->sequence.store(2,std::memory_order_release);
+	lastFrameTime = 0;
+
+	static bool registered = false;
+	if( !registered )
+	{
+		atexit(CloseAtExit);
+		registered = true;
+	}
+
+	printf("Live metrics in /dev/shm%s\n",segmentName);
+	return true;
+}
+
+void LiveMetrics::Close()
+{
+	if( segment == NULL )
+	{
+		return;
+	}
+	munmap(segment,sizeof(LiveMetricsSegment));
+	shm_unlink(segmentName);
+	segment = NULL;
+}
+
+const char* LiveMetrics::GetName()
+{
+	return segmentName;
+}
+
+void LiveMetrics::EndFrame(const FrameStats& frame)
+{
+	if( segment == NULL )
+	{
+		return;
+	}
+
+	const int64_t now = Now();
+	if( lastFrameTime != 0 )
+	{
+		const float milliseconds = (float)(now - lastFrameTime) / 1000000.0f;
+		pending.frameMilliseconds = milliseconds;
+		pending.averageMilliseconds = pending.averageMilliseconds == 0.0f ? milliseconds : pending.averageMilliseconds + (milliseconds - pending.averageMilliseconds) * (1.0f / 60.0f);
+		if( milliseconds > pending.worstMilliseconds )
+		{
+			pending.worstMilliseconds = milliseconds;
+		}
+
+		const int bucket = (int)milliseconds;
+		pending.histogram[bucket < LiveMetricsData::HISTOGRAM_BUCKETS ? bucket : LiveMetricsData::HISTOGRAM_BUCKETS - 1]++;
+	}
+	lastFrameTime = now;
+
+	if( (pending.frameCount % HEAP_SAMPLE_FRAMES) == 0 )
+	{
+		pending.heapBytes = HeapInUse();
+	}
+
+	pending.frameCount++;
+	pending.timestamp = (uint64_t)now;
+	pending.lastFrame = frame;
+	for( int n = 0 ; n < RESOURCE_CATEGORY_COUNT ; n++ )
+	{
+		pending.resourceBytes[n] = GLResources::GetTotal((ResourceCategory)n);
+		pending.resourceHighWater[n] = GLResources::GetHighWater((ResourceCategory)n);
+		pending.resourceCount[n] = GLResources::GetCount((ResourceCategory)n);
+	}
+
+	// Only this thread writes, so a relaxed load of our own sequence is fine.
+	const uint32_t sequence = segment->sequence.load(std::memory_order_relaxed);
+	segment->sequence.store(sequence + 1,std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	memcpy(&segment->data,&pending,sizeof(LiveMetricsData));
+	segment->sequence.store(sequence + 2,std::memory_order_release);
+}
+
+const LiveMetricsSegment* LiveMetrics::Attach(const char* name)
+{
+	char path[MAX_NAME];
+	snprintf(path,MAX_NAME,"%s%s",name[0] == '/' ? "" : "/",name);
+
+	const int fd = shm_open(path,O_RDONLY,0);
+	if( fd < 0 )
+	{
+		return NULL;
+	}
+
+	struct stat info;
+	if( fstat(fd,&info) != 0 || info.st_size < (off_t)sizeof(LiveMetricsSegment) )
+	{
+		close(fd);
+		return NULL;
+	}
+
+	void* mapped = mmap(NULL,sizeof(LiveMetricsSegment),PROT_READ,MAP_SHARED,fd,0);
+	close(fd);
+	if( mapped == MAP_FAILED )
+	{
+		return NULL;
+	}
+
+	const LiveMetricsSegment* attached = (const LiveMetricsSegment*)mapped;
+	if( memcmp(attached->magic,"BDLM",4) != 0 || attached->version != VERSION || attached->size != sizeof(LiveMetricsSegment) )
+	{
+		printf("LiveMetrics::Attach: %s is not a version %d segment\n",path,VERSION);
+		munmap(mapped,sizeof(LiveMetricsSegment));
+		return NULL;
+	}
+	return attached;
+}
+
+void LiveMetrics::Detach(const LiveMetricsSegment* attached)
+{
+	if( attached != NULL )
+	{
+		munmap((void*)attached,sizeof(LiveMetricsSegment));
+	}
+}
+
+bool LiveMetrics::Read(const LiveMetricsSegment* attached,LiveMetricsData& out)
+{
+	for( int attempt = 0 ; attempt < READ_ATTEMPTS ; attempt++ )
+	{
+		const uint32_t before = attached->sequence.load(std::memory_order_acquire);
+		if( before & 1 )
+		{
+			sched_yield();
+			continue;
+		}
+
+		memcpy(&out,(const void*)&attached->data,sizeof(LiveMetricsData));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if( attached->sequence.load(std::memory_order_relaxed) == before )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+} /* namespace BogDog */
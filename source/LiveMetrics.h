@@ -0,0 +1,122 @@
+/*
+ * LiveMetrics.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIVEMETRICS_H_
+#define LIVEMETRICS_H_
+
+#include <stdint.h>
+#include <atomic>
+#include "gl/FrameStats.h"
+#include "gl/GLResources.h"
+
+namespace BogDog
+{
+
+/**
+ * What is published each frame, bdtop reads it. Add to the end and bump LiveMetrics::VERSION when it changes.
+ */
+struct LiveMetricsData
+{
+	static const int HISTOGRAM_BUCKETS = 100;	//!<1ms each, the last one has everything 99ms and over.
+
+	uint64_t frameCount;
+	uint64_t timestamp;							//!<CLOCK_MONOTONIC nanoseconds of the last update, bdtop uses it to see the process has stalled.
+	float frameMilliseconds;					//!<Update to Update.
+	float averageMilliseconds;					//!<Smoothed over about a second.
+	float worstMilliseconds;
+	uint32_t histogram[HISTOGRAM_BUCKETS];		//!<Frame times since the segment was opened.
+	FrameStats lastFrame;
+	uint64_t heapBytes;							//!<malloc'd and in use, sampled every HEAP_SAMPLE_FRAMES.
+	uint64_t resourceBytes[RESOURCE_CATEGORY_COUNT];
+	uint64_t resourceHighWater[RESOURCE_CATEGORY_COUNT];
+	uint32_t resourceCount[RESOURCE_CATEGORY_COUNT];
+};
+
+/**
+ * The layout of the segment. sequence is a seqlock, odd while the writer is part way through data.
+ */
+struct LiveMetricsSegment
+{
+	char magic[4];								//!<"BDLM"
+	uint32_t version;
+	uint32_t size;								//!<sizeof(LiveMetricsSegment) of the writer.
+	uint32_t pid;
+	std::atomic<uint32_t> sequence;
+	uint32_t pad;
+	LiveMetricsData data;
+};
+
+/**
+ * Publishes the frame stats, frame time histogram, heap and GL resource totals in a shared memory segment,
+ * /dev/shm/bogdog.<pid> by default, so monitoring can see inside a running process. Read it with tools/bdtop.
+ * The writer never waits, it bumps a sequence number either side of a memcpy and readers retry if it changed.
+ * OpenGLES_2_0::Update calls EndFrame, all you do is Open, or set BD_METRICS to 1 or a name before creating the context.
+ * The segment is removed at exit, a process killed by a signal leaves it behind. bdtop skips those as the pid is gone,
+ * remove them by hand with rm /dev/shm/bogdog.<pid>.
+ */
+struct LiveMetrics
+{
+	static const uint32_t VERSION = 1;
+	static const int HEAP_SAMPLE_FRAMES = 30;	//!<mallinfo walks the heap's bins, so it is not done every frame.
+
+	/**
+	 * Creates the segment.
+	 * @param name The shm name, for example "/bogdog.game", NULL for "/bogdog.<pid>".
+	 */
+	static bool Open(const char* name = NULL);
+
+	/**
+	 * Unmaps and removes the segment, done for you at exit.
+	 */
+	static void Close();
+
+	static bool IsOpen()
+	{
+		return segment != NULL;
+	}
+
+	static const char* GetName();
+
+	/**
+	 * Records the frame and publishes it. Called by OpenGLES_2_0::Update once a frame.
+	 */
+	static void EndFrame(const FrameStats& frame);
+
+	/**
+	 * Maps a segment read only, for readers.
+	 * @return NULL if it does not exist or is a version we don't know.
+	 */
+	static const LiveMetricsSegment* Attach(const char* name);
+
+	static void Detach(const LiveMetricsSegment* attached);
+
+	/**
+	 * Copies a consistent set of data out of an attached segment.
+	 * @return false if the writer was part way through an update every time we tried, try again later.
+	 */
+	static bool Read(const LiveMetricsSegment* attached,LiveMetricsData& out);
+
+private:
+	static LiveMetricsSegment* segment;
+};
+
+} /* namespace BogDog */
+#endif /* LIVEMETRICS_H_ */
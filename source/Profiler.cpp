@@ -0,0 +1,308 @@
+/*
+ * Profiler.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <algorithm>
+#include "Profiler.h"
+#include "DynamicBuffer.h"
+
+namespace BogDog
+{
+
+static const int FRAME_RING_SIZE = 1024;
+
+thread_local Profiler::ThreadRing* Profiler::threadRing = NULL;
+
+static pthread_mutex_t ringsMutex = PTHREAD_MUTEX_INITIALIZER;
+static Profiler::ThreadRing* rings = NULL;		//!<Every thread's ring, added to the front, never removed.
+static int nextThreadId = 1;
+
+// Written only by the thread calling EndFrame.
+static uint64_t frameStarts[FRAME_RING_SIZE];
+static uint64_t frameEnds[FRAME_RING_SIZE];
+static std::atomic<uint32_t> frameHead(0);
+static uint64_t frameStart = 0;
+static uint32_t frameEventStart = 0;	//!<The calling thread's ring head when the frame started.
+
+static Profiler::Node lastFrame[Profiler::MAX_FRAME_NODES];
+static int lastFrameCount = 0;
+static float lastFrameMilliseconds = 0.0f;
+
+static DynamicBuffer<Profiler::Event> frameEvents;
+
+void Profiler::SetThreadName(const char* name)
+{
+	ThreadRing* ring = GetThreadRing();
+	strncpy(ring->name,name,MAX_NAME - 1);
+	ring->name[MAX_NAME - 1] = 0;
+}
+
+void Profiler::EndFrame()
+{
+	const uint64_t now = Now();
+	ThreadRing* ring = GetThreadRing();
+	const uint32_t head = ring->head.load(std::memory_order_relaxed);
+
+	if( frameStart != 0 )
+	{
+		const uint32_t frameHeadNow = frameHead.load(std::memory_order_relaxed);
+		frameStarts[frameHeadNow & (FRAME_RING_SIZE - 1)] = frameStart;
+		frameEnds[frameHeadNow & (FRAME_RING_SIZE - 1)] = now;
+		frameHead.store(frameHeadNow + 1,std::memory_order_release);
+		lastFrameMilliseconds = (float)(TicksToMicroseconds(now - frameStart) / 1000.0);
+
+		// Only what is still in the ring, a frame with more scopes than the ring holds loses the oldest.
+		uint32_t first = frameEventStart;
+		if( head - first > (uint32_t)RING_SIZE )
+		{
+			first = head - RING_SIZE;
+		}
+
+		// Events are written as scopes end so children come before their parents, put them in the order they started.
+		const int count = (int)(head - first);
+		lastFrameCount = 0;
+		if( count > 0 )
+		{
+			Event* events = frameEvents.Get(count);
+			for( int n = 0 ; n < count ; n++ )
+			{
+				events[n] = ring->events[(first + n) & (RING_SIZE - 1)];
+			}
+			std::sort(events,events + count,[](const Event& a,const Event& b)
+			{
+				return a.start != b.start ? a.start < b.start : a.depth < b.depth;
+			});
+
+			// The node open at each depth. The frame can start part way down, when the ring wrapped or EndFrame
+			// is called inside a scope, so a scope with no parent recorded goes at the root.
+			int stack[64];
+			for( int n = 0 ; n < 64 ; n++ )
+			{
+				stack[n] = -1;
+			}
+
+			for( int n = 0 ; n < count ; n++ )
+			{
+				const Event& event = events[n];
+				const int depth = event.depth < 64 ? event.depth : 63;
+				const int parent = depth > 0 ? stack[depth - 1] : -1;
+				const int nodeDepth = parent < 0 ? 0 : lastFrame[parent].depth + 1;
+
+				int node = -1;
+				for( int i = 0 ; i < lastFrameCount ; i++ )
+				{
+					if( lastFrame[i].parent == parent && lastFrame[i].depth == nodeDepth && strcmp(lastFrame[i].name,event.name) == 0 )
+					{
+						node = i;
+						break;
+					}
+				}
+
+				if( node < 0 )
+				{
+					if( lastFrameCount == MAX_FRAME_NODES )
+					{
+						stack[depth] = -1;
+						continue;
+					}
+					node = lastFrameCount++;
+					lastFrame[node].name = event.name;
+					lastFrame[node].depth = nodeDepth;
+					lastFrame[node].parent = parent;
+					lastFrame[node].calls = 0;
+					lastFrame[node].milliseconds = 0.0f;
+				}
+
+				lastFrame[node].calls++;
+				lastFrame[node].milliseconds += (float)(TicksToMicroseconds(event.end - event.start) / 1000.0);
+				stack[depth] = node;
+			}
+		}
+	}
+
+	frameStart = now;
+	frameEventStart = head;
+}
+
+const Profiler::Node* Profiler::GetLastFrame(int& count)
+{
+	count = lastFrameCount;
+	return lastFrame;
+}
+
+float Profiler::GetLastFrameMilliseconds()
+{
+	return lastFrameMilliseconds;
+}
+
+static void PrintNode(int node,const Profiler::Node* nodes,int count)
+{
+	const Profiler::Node& n = nodes[node];
+	printf("  %*s%-*s %8.3fms %5d\n",n.depth * 2,"",30 - (n.depth * 2),n.name,n.milliseconds,n.calls);
+	for( int child = node + 1 ; child < count ; child++ )
+	{
+		if( nodes[child].parent == node )
+		{
+			PrintNode(child,nodes,count);
+		}
+	}
+}
+
+void Profiler::PrintLastFrame()
+{
+	printf("Profiler: frame %.3fms\n",lastFrameMilliseconds);
+	for( int n = 0 ; n < lastFrameCount ; n++ )
+	{
+		if( lastFrame[n].parent < 0 )
+		{
+			PrintNode(n,lastFrame,lastFrameCount);
+		}
+	}
+}
+
+static void WriteJSONString(FILE* file,const char* text)
+{
+	fputc('"',file);
+	for( ; *text ; text++ )
+	{
+		if( *text == '"' || *text == '\\' )
+		{
+			fputc('\\',file);
+		}
+		fputc(*text,file);
+	}
+	fputc('"',file);
+}
+
+bool Profiler::WriteChromeTrace(const char* filename)
+{
+	FILE* file = fopen(filename,"w");
+	if( file == NULL )
+	{
+		printf("Profiler::WriteChromeTrace: could not open %s\n",filename);
+		return false;
+	}
+
+	// All times are from the oldest frame we have, keeps the numbers small.
+	const uint32_t framesEnd = frameHead.load(std::memory_order_acquire);
+	const uint32_t framesBegin = framesEnd > (uint32_t)FRAME_RING_SIZE ? framesEnd - FRAME_RING_SIZE : 0;
+	uint64_t base = framesBegin < framesEnd ? frameStarts[framesBegin & (FRAME_RING_SIZE - 1)] : Now();
+
+	pthread_mutex_lock(&ringsMutex);
+	ThreadRing* first = rings;
+	pthread_mutex_unlock(&ringsMutex);
+
+	for( ThreadRing* ring = first ; ring != NULL ; ring = ring->next )
+	{
+		const uint32_t head = ring->head.load(std::memory_order_acquire);
+		if( head > 0 && ring->events[(head > (uint32_t)RING_SIZE ? head - RING_SIZE : 0) & (RING_SIZE - 1)].start < base )
+		{
+			base = ring->events[(head > (uint32_t)RING_SIZE ? head - RING_SIZE : 0) & (RING_SIZE - 1)].start;
+		}
+	}
+
+	fprintf(file,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Frames\"}}");
+
+	for( uint32_t n = framesBegin ; n < framesEnd ; n++ )
+	{
+		const uint64_t start = frameStarts[n & (FRAME_RING_SIZE - 1)];
+		const uint64_t end = frameEnds[n & (FRAME_RING_SIZE - 1)];
+		fprintf(file,",\n{\"name\":\"Frame %u\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+				n,TicksToMicroseconds(start - base),TicksToMicroseconds(end - start));
+	}
+
+	for( ThreadRing* ring = first ; ring != NULL ; ring = ring->next )
+	{
+		fprintf(file,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",ring->id);
+		WriteJSONString(file,ring->name);
+		fprintf(file,"}}");
+
+		const uint32_t head = ring->head.load(std::memory_order_acquire);
+		const uint32_t begin = head > (uint32_t)RING_SIZE ? head - RING_SIZE : 0;
+		for( uint32_t n = begin ; n < head ; n++ )
+		{
+			const Event event = ring->events[n & (RING_SIZE - 1)];
+
+			// If the thread has come round the ring to this slot while we were reading it, it may be half written.
+			// The slot is being written from when head reaches n + RING_SIZE, and the fence keeps the copy above before the load.
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const uint32_t headNow = ring->head.load(std::memory_order_relaxed);
+			if( headNow - n >= (uint32_t)RING_SIZE )
+			{
+				continue;
+			}
+			if( event.start < base )
+			{
+				continue;
+			}
+
+			fprintf(file,",\n{\"name\":");
+			WriteJSONString(file,event.name);
+			fprintf(file,",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+					ring->id,TicksToMicroseconds(event.start - base),TicksToMicroseconds(event.end - event.start));
+		}
+	}
+
+	fprintf(file,"\n]}\n");
+	const bool written = ferror(file) == 0;
+	fclose(file);
+
+	if( !written )
+	{
+		printf("Profiler::WriteChromeTrace: failed writing %s\n",filename);
+	}
+	return written;
+}
+
+double Profiler::TicksToMicroseconds(uint64_t ticks)
+{
+#if defined(__aarch64__)
+	static uint64_t frequency = 0;
+	if( frequency == 0 )
+	{
+		asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+	}
+	return (double)ticks * 1000000.0 / (double)frequency;
+#else
+	return (double)ticks / 1000.0;
+#endif
+}
+
+Profiler::ThreadRing* Profiler::AddThreadRing()
+{
+	ThreadRing* ring = new ThreadRing;
+	ring->head.store(0,std::memory_order_relaxed);
+	ring->depth = 0;
+
+	pthread_mutex_lock(&ringsMutex);
+	ring->id = nextThreadId++;
+	snprintf(ring->name,MAX_NAME,"Thread %d",ring->id);
+	ring->next = rings;
+	rings = ring;
+	pthread_mutex_unlock(&ringsMutex);
+
+	return ring;
+}
+
+} /* namespace BogDog */
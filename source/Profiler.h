@@ -0,0 +1,193 @@
+/*
+ * Profiler.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <atomic>
+
+/**
+ * Put BD_PROFILE_SCOPE("name") at the start of a block to time it, the name must be a string literal.
+ * Call BD_PROFILE_FRAME() once a frame, after OpenGLES_2_0::Update, on the main thread.
+ * Define BD_PROFILE to turn them on, without it they compile to nothing.
+ */
+#ifdef BD_PROFILE
+	#define BD_PROFILE_CONCAT_INNER(a,b) a##b
+	#define BD_PROFILE_CONCAT(a,b) BD_PROFILE_CONCAT_INNER(a,b)
+	#define BD_PROFILE_SCOPE(name) BogDog::ProfileScope BD_PROFILE_CONCAT(profileScope,__LINE__)(name)
+	#define BD_PROFILE_FRAME() BogDog::Profiler::EndFrame()
+	#define BD_PROFILE_THREAD_NAME(name) BogDog::Profiler::SetThreadName(name)
+#else
+	#define BD_PROFILE_SCOPE(name)
+	#define BD_PROFILE_FRAME()
+	#define BD_PROFILE_THREAD_NAME(name)
+#endif
+
+namespace BogDog
+{
+
+/**
+ * Records timed scopes into a ring buffer per thread. Only the owning thread writes to it's ring so recording
+ * takes no locks, a scope costs two clock reads and a few stores. The clock is the ARM generic timer on 64 bit ARM
+ * and CLOCK_MONOTONIC everywhere else.
+ * Each frame the main thread's scopes are built into a tree, name, time and calls, see PrintLastFrame.
+ * WriteChromeTrace saves everything still in the rings as a trace for chrome://tracing or ui.perfetto.dev.
+ */
+struct Profiler
+{
+	static const int RING_SIZE = 16384;		//!<Scopes kept per thread, must be a power of 2.
+	static const int MAX_FRAME_NODES = 256;	//!<Different scopes in the frame tree.
+	static const int MAX_NAME = 32;
+
+	/**
+	 * One scope as it appears in the last frame's tree.
+	 */
+	struct Node
+	{
+		const char* name;
+		int depth;				//!<0 for scopes not inside another.
+		int parent;				//!<Index of the parent node, -1 for none.
+		int calls;
+		float milliseconds;		//!<Total of all the calls.
+	};
+
+	/**
+	 * Names the calling thread in the trace.
+	 */
+	static void SetThreadName(const char* name);
+
+	/**
+	 * Marks the end of a frame and builds the tree of the calling thread's scopes in it.
+	 */
+	static void EndFrame();
+
+	/**
+	 * @return The nodes of the last frame's tree, parents come before their children.
+	 */
+	static const Node* GetLastFrame(int& count);
+
+	/**
+	 * @return The time of the last frame in milliseconds.
+	 */
+	static float GetLastFrameMilliseconds();
+
+	/**
+	 * Prints the last frame's tree, indented by depth.
+	 */
+	static void PrintLastFrame();
+
+	/**
+	 * Writes the scopes in the rings and the frames as Chrome trace event JSON.
+	 * Safe to call while other threads are recording, scopes they overwrite while it runs are left out.
+	 * @return false if the file could not be written.
+	 */
+	static bool WriteChromeTrace(const char* filename);
+
+	/**
+	 * @return The current time in ticks, see TicksToMicroseconds.
+	 */
+	static uint64_t Now()
+	{
+#if defined(__aarch64__)
+		uint64_t ticks;
+		asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+		return ticks;
+#else
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC,&now);
+		return (now.tv_sec * (uint64_t)1000000000) + now.tv_nsec;
+#endif
+	}
+
+	static double TicksToMicroseconds(uint64_t ticks);
+
+	/// @cond Doxygen should ignore this
+	struct Event
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+		int depth;
+	};
+
+	struct ThreadRing
+	{
+		Event events[RING_SIZE];
+		std::atomic<uint32_t> head;		//!<Total events written, the ring index is head & (RING_SIZE-1).
+		int depth;						//!<Scopes open on the thread.
+		int id;
+		char name[MAX_NAME];
+		ThreadRing* next;
+	};
+
+	static ThreadRing* GetThreadRing()
+	{
+		if( threadRing == NULL )
+		{
+			threadRing = AddThreadRing();
+		}
+		return threadRing;
+	}
+	/// @endcond
+
+private:
+	static thread_local ThreadRing* threadRing;
+	static ThreadRing* AddThreadRing();
+};
+
+/**
+ * Times the scope it is declared in, use BD_PROFILE_SCOPE rather than this.
+ */
+struct ProfileScope
+{
+	ProfileScope(const char* pName)
+	{
+		name = pName;
+		ring = Profiler::GetThreadRing();
+		depth = ring->depth++;
+		start = Profiler::Now();
+	}
+
+	~ProfileScope()
+	{
+		const uint64_t end = Profiler::Now();
+		const uint32_t head = ring->head.load(std::memory_order_relaxed);
+		Profiler::Event& event = ring->events[head & (Profiler::RING_SIZE - 1)];
+		event.name = name;
+		event.start = start;
+		event.end = end;
+		event.depth = depth;
+		ring->head.store(head + 1,std::memory_order_release);
+		ring->depth--;
+	}
+
+private:
+	const char* name;
+	Profiler::ThreadRing* ring;
+	uint64_t start;
+	int depth;
+};
+
+} /* namespace BogDog */
+#endif /* PROFILER_H_ */
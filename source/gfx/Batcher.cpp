@@ -0,0 +1,383 @@
+/*
+ * Batcher.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <algorithm>
+#include "gfx/Batcher.h"
+#include "gl/GLShader.h"
+#include "maths/Maths.h"
+#include "Profiler.h"
+
+namespace BogDog
+{
+
+/**
+ * Multiplies the four bytes of an ABGR colour by the red, green, blue and alpha scales.
+ */
+static int MulColour(int colour,const float scale[4])
+{
+	const uint32_t source = (uint32_t)colour;
+	uint32_t result = 0;
+	for( int n = 0 ; n < 4 ; n++ )
+	{
+		const float channel = ((source >> (n * 8)) & 0xff) * scale[n];
+		result |= (uint32_t)lrintf(md_clamp(channel,0.0f,255.0f)) << (n * 8);
+	}
+	return (int)result;
+}
+
+Batcher::Batcher(int maxVerticesPerFrame,int maxIndicesPerFrame,int framesInFlight) :
+	vertexStream(maxVerticesPerFrame * BatchFormat::STRIDE * framesInFlight,GL_ARRAY_BUFFER,framesInFlight),
+	indexStream(maxIndicesPerFrame * sizeof(uint16_t) * framesInFlight,GL_ELEMENT_ARRAY_BUFFER,framesInFlight)
+{
+	currentMaterial = -1;
+	activeShader = NULL;
+	drawCalls = 0;
+	submitted = 0;
+}
+
+Batcher::~Batcher()
+{
+}
+
+void Batcher::SetMaterial(GLShader* shader,GLint texture,BLENDMODE blend)
+{
+	Material material;
+	material.Set(shader,texture,blend);
+	currentMaterial = FindMaterial(material);
+}
+
+void Batcher::Submit(Mesh* mesh,const Matrix& transform,float red,float green,float blue,float alpha)
+{
+	const float colour[4] = {red,green,blue,alpha};
+	if( mesh->getSubMeshCount() > 0 )
+	{
+		for( int n = 0 ; n < mesh->getSubMeshCount() ; n++ )
+		{
+			const Mesh::SubMesh& subMesh = mesh->getSubMesh(n);
+			Item* item = AddItem(mesh,transform,colour,FindMaterial(subMesh.material));
+			item->firstTriangle = subMesh.firstTriangle;
+			item->triangleCount = subMesh.triangleCount;
+			item->firstVertex = subMesh.firstVertex;
+			item->vertexCount = subMesh.vertexCount;
+		}
+		return;
+	}
+
+	if( currentMaterial < 0 )
+	{
+		printf("Batcher::Submit: call SetMaterial first\n");
+		return;
+	}
+
+	Item* item = AddItem(mesh,transform,colour,currentMaterial);
+	item->firstTriangle = 0;
+	item->triangleCount = mesh->getTriangleCount();
+	item->firstVertex = 0;
+	item->vertexCount = mesh->getVertexCount();
+}
+
+void Batcher::Flush(const Matrix& projInvcam)
+{
+	BD_PROFILE_SCOPE("Batcher::Flush");
+	drawCalls = 0;
+	submitted = (int)items.GetSize();
+	activeShader = NULL;
+	if( items.GetSize() == 0 )
+	{
+		return;
+	}
+
+	SortItems();
+
+	Item* list = &items[0];
+	const int itemCount = (int)items.GetSize();
+	int bucketStart = 0;
+	while( bucketStart < itemCount )
+	{
+		int bucketEnd = bucketStart + 1;
+		while( bucketEnd < itemCount && list[bucketEnd].material == list[bucketStart].material )
+		{
+			bucketEnd++;
+		}
+
+		SetState(materials[list[bucketStart].material],projInvcam);
+
+		int n = bucketStart;
+		while( n < bucketEnd )
+		{
+			if( !list[n].mesh->hasCPUCopy() )
+			{
+				DrawUnbatched(list[n]);
+				n++;
+				continue;
+			}
+
+			// Gather as many as will fit in 16 bit indices.
+			int vertexCount = 0;
+			int indexCount = 0;
+			int count = 0;
+			while( n + count < bucketEnd && list[n + count].mesh->hasCPUCopy() )
+			{
+				const Item& item = list[n + count];
+				if( vertexCount + item.vertexCount > 0x10000 )
+				{
+					break;
+				}
+				vertexCount += item.vertexCount;
+				indexCount += item.triangleCount * 3;
+				count++;
+			}
+
+			DrawBatch(list + n,count,vertexCount,indexCount);
+			n += count;
+		}
+
+		bucketStart = bucketEnd;
+	}
+
+	items.Reset();
+}
+
+void Batcher::EndFrame()
+{
+	vertexStream.EndFrame();
+	indexStream.EndFrame();
+}
+
+Mesh* Batcher::BuildStatic()
+{
+	int vertexCount = 0;
+	int indexCount = 0;
+	for( size_t n = 0 ; n < items.GetSize() ; n++ )
+	{
+		if( items[n].mesh->hasCPUCopy() )
+		{
+			vertexCount += items[n].vertexCount;
+			indexCount += items[n].triangleCount * 3;
+		}
+		else
+		{
+			printf("Batcher::BuildStatic: mesh has no CPU copy, it has more than %d vertices, skipped\n",Mesh::CPU_COPY_MAX_VERTICES);
+		}
+	}
+
+	Mesh* newMesh = NULL;
+	if( vertexCount > 0x10000 )
+	{
+		printf("Batcher::BuildStatic: more than 65536 vertices, can't index with 16 bits\n");
+	}
+	else if( vertexCount > 0 )
+	{
+		SortItems();
+
+		uint8_t* vertices = new uint8_t[vertexCount * BatchFormat::STRIDE];
+		uint16_t* indices = new uint16_t[indexCount];
+		Mesh::SubMesh* subMeshes = new Mesh::SubMesh[materials.GetSize()];
+		int subMeshCount = 0;
+
+		int baseVertex = 0;
+		int baseIndex = 0;
+		int lastMaterial = -1;
+		for( size_t n = 0 ; n < items.GetSize() ; n++ )
+		{
+			const Item& item = items[n];
+			if( !item.mesh->hasCPUCopy() )
+			{
+				continue;
+			}
+
+			if( item.material != lastMaterial )
+			{
+				Mesh::SubMesh& subMesh = subMeshes[subMeshCount++];
+				subMesh.firstTriangle = baseIndex / 3;
+				subMesh.triangleCount = 0;
+				subMesh.firstVertex = baseVertex;
+				subMesh.vertexCount = 0;
+				subMesh.material = materials[item.material];
+				lastMaterial = item.material;
+			}
+
+			WriteItem(item,vertices + (baseVertex * BatchFormat::STRIDE),indices + baseIndex,baseVertex);
+			baseVertex += item.vertexCount;
+			baseIndex += item.triangleCount * 3;
+
+			subMeshes[subMeshCount - 1].triangleCount += item.triangleCount;
+			subMeshes[subMeshCount - 1].vertexCount += item.vertexCount;
+		}
+
+		newMesh = Mesh::Create<BatchFormat>(vertices,vertexCount,indices,indexCount);
+		newMesh->setSubMeshes(subMeshes,subMeshCount);
+		delete []vertices;
+		delete []indices;
+		delete []subMeshes;
+	}
+
+	items.Reset();
+	return newMesh;
+}
+
+int Batcher::FindMaterial(const Material& material)
+{
+	for( size_t n = 0 ; n < materials.GetSize() ; n++ )
+	{
+		if( materials[n] == material )
+		{
+			return (int)n;
+		}
+	}
+
+	materials.PushBack(material);
+	return (int)materials.GetSize() - 1;
+}
+
+Batcher::Item* Batcher::AddItem(Mesh* mesh,const Matrix& transform,const float colour[4],int material)
+{
+	Item* item = items.PushBack();
+	item->mesh = mesh;
+	item->transform = transform;
+	item->colour[0] = colour[0];
+	item->colour[1] = colour[1];
+	item->colour[2] = colour[2];
+	item->colour[3] = colour[3];
+	item->material = material;
+	return item;
+}
+
+void Batcher::SortItems()
+{
+	// Opaque buckets first, then ones sharing a shader next to each other so the program changes as little as it can.
+	const int materialCount = (int)materials.GetSize();
+	int* order = materialOrder.Get(materialCount);
+	for( int n = 0 ; n < materialCount ; n++ )
+	{
+		order[n] = n;
+	}
+	std::sort(order,order + materialCount,[this](int a,int b)
+	{
+		const Material& ma = materials[a];
+		const Material& mb = materials[b];
+		if( ma.blend != mb.blend )
+			return ma.blend < mb.blend;
+		if( ma.shader != mb.shader )
+			return ma.shader < mb.shader;
+		return ma.texture < mb.texture;
+	});
+	int* rank = materialRank.Get(materialCount);
+	for( int n = 0 ; n < materialCount ; n++ )
+	{
+		rank[order[n]] = n;
+	}
+
+	Item* list = &items[0];
+	std::stable_sort(list,list + items.GetSize(),[rank](const Item& a,const Item& b)
+	{
+		return rank[a.material] < rank[b.material];
+	});
+}
+
+void Batcher::SetState(const Material& material,const Matrix& projInvcam)
+{
+	if( material.shader != activeShader )
+	{
+		material.shader->Enable(projInvcam);
+		activeShader = material.shader;
+	}
+
+	if( material.texture != 0 )
+	{
+		activeShader->setTexture(0,material.texture);
+	}
+
+	material.ApplyBlend();
+}
+
+void Batcher::DrawBatch(const Item* first,int count,int vertexCount,int indexCount)
+{
+	int vertexOffset,indexOffset;
+	uint8_t* vertices = (uint8_t*)vertexStream.Allocate(vertexCount * BatchFormat::STRIDE,4,vertexOffset);
+	uint16_t* indices = vertices != NULL ? (uint16_t*)indexStream.Allocate(indexCount * sizeof(uint16_t),sizeof(uint16_t),indexOffset) : NULL;
+	if( indices == NULL )
+	{// Out of stream space this frame, still draw them but one at a time.
+		for( int n = 0 ; n < count ; n++ )
+		{
+			DrawUnbatched(first[n]);
+		}
+		return;
+	}
+
+	int baseVertex = 0;
+	for( int n = 0 ; n < count ; n++ )
+	{
+		WriteItem(first[n],vertices + (baseVertex * BatchFormat::STRIDE),indices,baseVertex);
+		baseVertex += first[n].vertexCount;
+		indices += first[n].triangleCount * 3;
+	}
+	vertexStream.Flush();
+	indexStream.Flush();
+
+	vertexStream.Bind();
+	BatchFormat::Enable(vertexOffset);
+	indexStream.Bind();
+
+	// Already in world space and coloured.
+	activeShader->setPositionDequantise(NULL);
+	activeShader->setTransformIdentity();
+	activeShader->setGlobalColour(1.0f,1.0f,1.0f,1.0f);
+
+	glDrawElements(GL_TRIANGLES,indexCount,GL_UNSIGNED_SHORT,(const GLvoid*)(size_t)indexOffset);
+	CHECK_OGL_ERRORS();
+	OpenGLES_2_0::CountDraw(indexCount);
+	drawCalls++;
+}
+
+void Batcher::DrawUnbatched(const Item& item)
+{
+	Matrix transform = item.transform;
+	item.mesh->Enable(activeShader);
+	activeShader->setTransform(transform);
+	activeShader->setGlobalColour(item.colour[0],item.colour[1],item.colour[2],item.colour[3]);
+	item.mesh->Draw(item.firstTriangle,item.triangleCount);
+	drawCalls++;
+}
+
+void Batcher::WriteItem(const Item& item,uint8_t* vertices,uint16_t* indices,int baseVertex)
+{
+	Mesh* mesh = item.mesh;
+	VertexSource vertex;
+	for( int n = 0 ; n < item.vertexCount ; n++ )
+	{
+		mesh->ReadVertex(item.firstVertex + n,vertex);
+		vertex.xyz.MatrixMul(&item.transform);
+		vertex.colour = MulColour(vertex.colour,item.colour);
+		BatchFormat::Write(vertices + (n * BatchFormat::STRIDE),vertex);
+	}
+
+	const int firstCorner = item.firstTriangle * 3;
+	const int cornerCount = item.triangleCount * 3;
+	for( int n = 0 ; n < cornerCount ; n++ )
+	{
+		indices[n] = (uint16_t)(baseVertex + mesh->getCornerVertex(firstCorner + n) - item.firstVertex);
+	}
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,153 @@
+/*
+ * Batcher.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCHER_H_
+#define BATCHER_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "GLHeaders.h"
+#include "DynamicBuffer.h"
+#include "maths/Matrix.h"
+#include "gl/GLStreamBuffer.h"
+#include "gl/VertexFormat.h"
+#include "Mesh.h"
+#include "Material.h"
+
+namespace BogDog
+{
+
+struct GLShader;
+
+/**
+ * Collects mesh draws for a frame and draws them with as few GL calls as it can.
+ * Submissions are put into buckets by material, shader, texture and blend mode. Small meshes, ones with a CPU copy, are
+ * transformed and coloured on the CPU into a stream buffer so each bucket is one glDrawElements. Other meshes are
+ * drawn one at a time as normal. Each sub mesh of a mesh goes into the bucket for it's own material.
+ * Also has a static mode, BuildStatic, that does the same merge once into a mesh for geometry that never moves.
+ */
+struct Batcher
+{
+	/**
+	 * The vertex format batched geometry is written in.
+	 */
+	typedef VertexFormat<Pos3f,ColourU8x4,UV2f> BatchFormat;
+
+	/**
+	 * @param maxVerticesPerFrame The most vertices that will be batched in a frame.
+	 * @param maxIndicesPerFrame The most indices that will be batched in a frame.
+	 * @param framesInFlight How many frames the GPU may be behind, see GLStreamBuffer.
+	 */
+	Batcher(int maxVerticesPerFrame = 65536,int maxIndicesPerFrame = 131072,int framesInFlight = 3);
+	~Batcher();
+
+	/**
+	 * Sets the shader, texture and blend mode for the submissions that follow.
+	 * @param texture The GL texture for unit 0, 0 for none.
+	 */
+	void SetMaterial(GLShader* shader,GLint texture = 0,BLENDMODE blend = BLENDMODE_OFF);
+
+	/**
+	 * Adds a mesh to be drawn with the current material, or with it's own materials if it has sub meshes.
+	 * The colour is multiplied with the vertex colours, as the shader's global colour would be.
+	 */
+	void Submit(Mesh* mesh,const Matrix& transform,float red = 1.0f,float green = 1.0f,float blue = 1.0f,float alpha = 1.0f);
+
+	/**
+	 * Draws everything submitted since the last Flush and clears the list.
+	 * Leaves the blend state as the last bucket set it.
+	 */
+	void Flush(const Matrix& projInvcam);
+
+	/**
+	 * Call once a frame after the last Flush, before OpenGLES_2_0::Update.
+	 */
+	void EndFrame();
+
+	/**
+	 * Merges everything submitted into one indexed mesh in BatchFormat and clears the list, for geometry that does not move.
+	 * The mesh has a sub mesh for each material, draw it with Mesh::DrawSubMeshes.
+	 * @return The new mesh, NULL if there is nothing that can be merged or there are more than 65536 vertices.
+	 */
+	Mesh* BuildStatic();
+
+	/**
+	 * @return The number of GL draw calls the last Flush made.
+	 */
+	int getDrawCalls()
+	{
+		return drawCalls;
+	}
+
+	/**
+	 * @return The number of submissions the last Flush drew.
+	 */
+	int getSubmitted()
+	{
+		return submitted;
+	}
+
+private:
+	struct Item
+	{
+		Mesh* mesh;
+		Matrix transform;
+		float colour[4];
+		int material;
+		int firstTriangle;
+		int triangleCount;
+		int firstVertex;
+		int vertexCount;
+	};
+
+	DynamicBuffer<Material,16,16> materials;
+	DynamicBuffer<Item> items;
+	DynamicBuffer<int,16,16> materialOrder;	//!<Materials in the order they are drawn, built by Flush.
+	DynamicBuffer<int,16,16> materialRank;	//!<Where each material is in materialOrder.
+	int currentMaterial;
+	GLShader* activeShader;
+
+	GLStreamBuffer vertexStream;
+	GLStreamBuffer indexStream;
+
+	int drawCalls;
+	int submitted;
+
+	int FindMaterial(const Material& material);
+	Item* AddItem(Mesh* mesh,const Matrix& transform,const float colour[4],int material);
+
+	/**
+	 * Sorts the items so each material's items are together, opaque materials first.
+	 */
+	void SortItems();
+
+	void SetState(const Material& material,const Matrix& projInvcam);
+	void DrawBatch(const Item* first,int count,int vertexCount,int indexCount);
+	void DrawUnbatched(const Item& item);
+
+	/**
+	 * Writes the transformed and coloured vertices and the indices of the item's range, indices are offset by baseVertex.
+	 */
+	static void WriteItem(const Item& item,uint8_t* vertices,uint16_t* indices,int baseVertex);
+};
+
+} /* namespace BogDog */
+#endif /* BATCHER_H_ */
@@ -0,0 +1,226 @@
+/*
+ * CommandBuffer.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "gfx/CommandBuffer.h"
+#include "gfx/Mesh.h"
+#include "gl/GLShader.h"
+#include "Profiler.h"
+
+namespace BogDog
+{
+
+CommandBuffer::CommandBuffer()
+{
+	commandCount = 0;
+	drawCount = 0;
+}
+
+CommandBuffer::~CommandBuffer()
+{
+}
+
+void CommandBuffer::Reset()
+{
+	memory.Reset();
+	commandCount = 0;
+	drawCount = 0;
+}
+
+void CommandBuffer::UseShader(GLShader* shader)
+{
+	assert( shader != NULL );
+	Add<UseShaderCommand>(CMD_USE_SHADER)->shader = shader;
+}
+
+void CommandBuffer::SetTexture(int unit,GLint texture)
+{
+	SetTextureCommand* command = Add<SetTextureCommand>(CMD_SET_TEXTURE);
+	command->unit = unit;
+	command->texture = texture;
+}
+
+void CommandBuffer::SetBlend(BLENDMODE blend)
+{
+	Add<SetBlendCommand>(CMD_SET_BLEND)->blend = blend;
+}
+
+void CommandBuffer::SetMaterial(const Material& material)
+{
+	UseShader(material.shader);
+	if( material.texture != 0 )
+	{
+		SetTexture(0,material.texture);
+	}
+	SetBlend(material.blend);
+}
+
+void CommandBuffer::BindMesh(Mesh* mesh)
+{
+	assert( mesh != NULL );
+	Add<BindMeshCommand>(CMD_BIND_MESH)->mesh = mesh;
+}
+
+void CommandBuffer::SetTransform(const Matrix& transform)
+{
+	memcpy(Add<SetTransformCommand>(CMD_SET_TRANSFORM)->m,transform.m,sizeof(float) * 16);
+}
+
+void CommandBuffer::SetColour(float red,float green,float blue,float alpha)
+{
+	SetColourCommand* command = Add<SetColourCommand>(CMD_SET_COLOUR);
+	command->colour[0] = red;
+	command->colour[1] = green;
+	command->colour[2] = blue;
+	command->colour[3] = alpha;
+}
+
+void CommandBuffer::SetUniform4fv(GLint location,const float* values,int count)
+{
+	const int bytes = (int)sizeof(float) * 4 * count;
+	SetUniformCommand* command = Add<SetUniformCommand>(CMD_SET_UNIFORM_4FV,bytes);
+	command->location = location;
+	command->count = count;
+	memcpy(command + 1,values,bytes);
+}
+
+void CommandBuffer::SetUniformMatrix(GLint location,const Matrix& matrix)
+{
+	const int bytes = (int)sizeof(float) * 16;
+	SetUniformCommand* command = Add<SetUniformCommand>(CMD_SET_UNIFORM_MATRIX,bytes);
+	command->location = location;
+	command->count = 1;
+	memcpy(command + 1,matrix.m,bytes);
+}
+
+void CommandBuffer::Draw(Mesh* mesh,int firstTriangle,int triangleCount)
+{
+	DrawCommand* command = Add<DrawCommand>(CMD_DRAW);
+	command->mesh = mesh;
+	command->firstTriangle = firstTriangle;
+	command->triangleCount = triangleCount;
+	drawCount++;
+}
+
+void CommandBuffer::DrawMesh(Mesh* mesh,const Matrix& transform,float red,float green,float blue,float alpha)
+{
+	SetTransform(transform);
+	SetColour(red,green,blue,alpha);
+	Draw(mesh,0,mesh->getTriangleCount());
+}
+
+void CommandBuffer::Execute(const Matrix& projInvcam)const
+{
+	BD_PROFILE_SCOPE("CommandBuffer::Execute");
+	const uint8_t* read = memory.Get();
+	const uint8_t* end = read + memory.GetSize();
+	GLShader* shader = NULL;
+	while( read < end )
+	{
+		const Command* header = (const Command*)read;
+		assert( header->size > 0 );
+		switch( (CommandType)header->type )
+		{
+		case CMD_USE_SHADER:
+			shader = ((const UseShaderCommand*)read)->shader;
+			shader->Enable(projInvcam);
+			break;
+
+		case CMD_SET_TEXTURE:
+			{
+				const SetTextureCommand* command = (const SetTextureCommand*)read;
+				assert( shader != NULL );
+				shader->setTexture(command->unit,command->texture);
+			}
+			break;
+
+		case CMD_SET_BLEND:
+			{
+				Material material;
+				material.Set(shader,0,((const SetBlendCommand*)read)->blend);
+				material.ApplyBlend();
+			}
+			break;
+
+		case CMD_BIND_MESH:
+			assert( shader != NULL );
+			((const BindMeshCommand*)read)->mesh->Enable(shader);
+			break;
+
+		case CMD_SET_TRANSFORM:
+			{
+				Matrix transform;
+				memcpy(transform.m,((const SetTransformCommand*)read)->m,sizeof(float) * 16);
+				assert( shader != NULL );
+				shader->setTransform(transform);
+			}
+			break;
+
+		case CMD_SET_COLOUR:
+			{
+				const float* colour = ((const SetColourCommand*)read)->colour;
+				assert( shader != NULL );
+				shader->setGlobalColour(colour[0],colour[1],colour[2],colour[3]);
+			}
+			break;
+
+		case CMD_SET_UNIFORM_4FV:
+			{
+				const SetUniformCommand* command = (const SetUniformCommand*)read;
+				assert( shader != NULL );
+				shader->setUniform4fv(command->location,(const GLfloat*)(command + 1),command->count);
+			}
+			break;
+
+		case CMD_SET_UNIFORM_MATRIX:
+			{
+				const SetUniformCommand* command = (const SetUniformCommand*)read;
+				assert( shader != NULL );
+				shader->setUniformMatrix(command->location,(const GLfloat*)(command + 1));
+			}
+			break;
+
+		case CMD_DRAW:
+			{
+				const DrawCommand* command = (const DrawCommand*)read;
+				command->mesh->Draw(command->firstTriangle,command->triangleCount);
+			}
+			break;
+
+		default:
+			printf("CommandBuffer::Execute: unknown command %d\n",header->type);
+			assert(!"Unknown command");
+			return;
+		}
+		read += header->size;
+	}
+}
+
+void CommandBuffer::Execute(const CommandBuffer* const* buffers,int count,const Matrix& projInvcam)
+{
+	for( int n = 0 ; n < count ; n++ )
+	{
+		buffers[n]->Execute(projInvcam);
+	}
+}
+
+} /* namespace BogDog */
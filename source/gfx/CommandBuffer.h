@@ -0,0 +1,231 @@
+/*
+ * CommandBuffer.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMMANDBUFFER_H_
+#define COMMANDBUFFER_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "GLHeaders.h"
+#include "DynamicBuffer.h"
+#include "maths/Matrix.h"
+#include "Material.h"
+
+namespace BogDog
+{
+
+struct GLShader;
+struct Mesh;
+
+/**
+ * A list of draw commands recorded without calling GL, to be replayed on the GL thread with Execute.
+ * Commands are small POD structs packed one after the other in a block of memory, so recording is a few stores and
+ * replaying is a walk through memory. Recording never touches GL so worker threads can each fill their own buffer
+ * in parallel, doing the culling, matrix work and uniform packing, then the GL thread executes them in the order it wants.
+ * A buffer must only be used by one thread at a time, recording and executing the same buffer at once is not allowed.
+ * Recording only stores pointers to shaders and meshes, they must still exist when the buffer is executed.
+ */
+struct CommandBuffer
+{
+	enum CommandType
+	{
+		CMD_USE_SHADER,
+		CMD_SET_TEXTURE,
+		CMD_SET_BLEND,
+		CMD_BIND_MESH,
+		CMD_SET_TRANSFORM,
+		CMD_SET_COLOUR,
+		CMD_SET_UNIFORM_4FV,
+		CMD_SET_UNIFORM_MATRIX,
+		CMD_DRAW
+	};
+
+	CommandBuffer();
+	~CommandBuffer();
+
+	/**
+	 * Empties the buffer ready to record the next frame, keeps the memory.
+	 */
+	void Reset();
+
+	/**
+	 * Enables the shader with the camera passed to Execute.
+	 */
+	void UseShader(GLShader* shader);
+
+	/**
+	 * Binds a texture for the current shader, see GLShader::setTexture.
+	 */
+	void SetTexture(int unit,GLint texture);
+
+	void SetBlend(BLENDMODE blend);
+
+	/**
+	 * Sets the shader, texture if not 0 and blend mode of a material.
+	 */
+	void SetMaterial(const Material& material);
+
+	/**
+	 * Sets the vertex streams of the mesh for the current shader, see Mesh::Enable.
+	 */
+	void BindMesh(Mesh* mesh);
+
+	void SetTransform(const Matrix& transform);
+	void SetColour(float red,float green,float blue,float alpha);
+
+	/**
+	 * Sets a vec4 uniform array of the current shader, the values are copied into the buffer. See GLShader::setUniform4fv.
+	 * @param count The number of vec4s.
+	 */
+	void SetUniform4fv(GLint location,const float* values,int count);
+	void SetUniformMatrix(GLint location,const Matrix& matrix);
+
+	/**
+	 * Draws triangles of the bound mesh.
+	 */
+	void Draw(Mesh* mesh,int firstTriangle,int triangleCount);
+
+	/**
+	 * Records the transform, colour and draw of all of a mesh. The mesh must be bound.
+	 */
+	void DrawMesh(Mesh* mesh,const Matrix& transform,float red = 1.0f,float green = 1.0f,float blue = 1.0f,float alpha = 1.0f);
+
+	/**
+	 * Runs the commands, must be called on the thread that owns the GL context.
+	 * Can be called more than once, the buffer is not changed.
+	 * @param projInvcam The camera the shaders are enabled with.
+	 */
+	void Execute(const Matrix& projInvcam)const;
+
+	/**
+	 * Executes a set of buffers one after the other, the order they are in the array.
+	 */
+	static void Execute(const CommandBuffer* const* buffers,int count,const Matrix& projInvcam);
+
+	/**
+	 * @return The number of commands recorded since the last Reset.
+	 */
+	int getCommandCount()const
+	{
+		return commandCount;
+	}
+
+	/**
+	 * @return The bytes used by the recorded commands.
+	 */
+	int getSize()const
+	{
+		return (int)memory.GetSize();
+	}
+
+	/**
+	 * @return The number of draw commands recorded since the last Reset.
+	 */
+	int getDrawCount()const
+	{
+		return drawCount;
+	}
+
+private:
+	/**
+	 * Every command starts with this. Size includes the header and is a multiple of 8 so the next command is aligned.
+	 */
+	struct Command
+	{
+		uint32_t type;
+		uint32_t size;			//!<32 bits so a large uniform array can't wrap it to 0.
+	};
+
+	struct UseShaderCommand
+	{
+		Command header;
+		GLShader* shader;
+	};
+
+	struct SetTextureCommand
+	{
+		Command header;
+		int unit;
+		GLint texture;
+	};
+
+	struct SetBlendCommand
+	{
+		Command header;
+		BLENDMODE blend;
+	};
+
+	struct BindMeshCommand
+	{
+		Command header;
+		Mesh* mesh;
+	};
+
+	struct SetTransformCommand
+	{
+		Command header;
+		float m[4][4];
+	};
+
+	struct SetColourCommand
+	{
+		Command header;
+		float colour[4];
+	};
+
+	struct SetUniformCommand
+	{
+		Command header;
+		GLint location;
+		int count;
+		// Followed by the floats.
+	};
+
+	struct DrawCommand
+	{
+		Command header;
+		Mesh* mesh;
+		int firstTriangle;
+		int triangleCount;
+	};
+
+	DynamicBuffer<uint8_t,4096,4096> memory;
+	int commandCount;
+	int drawCount;
+
+	/**
+	 * Makes room for a command and fills in it's header.
+	 * @param extra Bytes needed after the struct.
+	 */
+	template <class COMMAND> COMMAND* Add(CommandType type,int extra = 0)
+	{
+		const size_t size = (sizeof(COMMAND) + extra + 7) & ~(size_t)7;
+		const size_t offset = memory.GetSize();
+		COMMAND* command = (COMMAND*)(memory.Get(offset + size,false,true) + offset);
+		command->header.type = (uint32_t)type;
+		command->header.size = (uint32_t)size;
+		commandCount++;
+		return command;
+	}
+};
+
+} /* namespace BogDog */
+#endif /* COMMANDBUFFER_H_ */
@@ -0,0 +1,468 @@
+/*
+ * FrameCapture.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "gfx/FrameCapture.h"
+#include "gl/OpenGLES20.h"
+
+namespace BogDog
+{
+
+static const int PNG_BLOCK = 65535;		// The most a stored deflate block can hold.
+static const int Y4M_RATE = 60;			// The frame rate in the y4m header is this over the capture interval.
+
+static uint32_t crcTable[256];
+
+/**
+ * Saturated blue or red rounds up to 256 for U or V, it would wrap to 0.
+ */
+static uint8_t ClampByte(int value)
+{
+	return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static void MakeCRCTable()
+{
+	for( uint32_t n = 0 ; n < 256 ; n++ )
+	{
+		uint32_t c = n;
+		for( int k = 0 ; k < 8 ; k++ )
+		{
+			c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+		}
+		crcTable[n] = c;
+	}
+}
+
+/**
+ * Writes a PNG chunk's bytes and keeps the CRC as it goes, so the image data does not need another copy.
+ */
+struct PNGChunk
+{
+	FILE* file;
+	uint32_t crc;
+
+	PNGChunk(FILE* pFile,const char* type,uint32_t length) : file(pFile),crc(0xffffffffu)
+	{
+		WriteBigEndian(length,false);
+		Write((const uint8_t*)type,4);
+	}
+
+	void Write(const uint8_t* data,size_t length)
+	{
+		for( size_t n = 0 ; n < length ; n++ )
+		{
+			crc = crcTable[(crc ^ data[n]) & 0xff] ^ (crc >> 8);
+		}
+		fwrite(data,1,length,file);
+	}
+
+	void WriteBigEndian(uint32_t value,bool inCRC = true)
+	{
+		const uint8_t bytes[4] = {(uint8_t)(value >> 24),(uint8_t)(value >> 16),(uint8_t)(value >> 8),(uint8_t)value};
+		if( inCRC )
+			Write(bytes,4);
+		else
+			fwrite(bytes,1,4,file);
+	}
+
+	void End()
+	{
+		WriteBigEndian(crc ^ 0xffffffffu,false);
+	}
+};
+
+FrameCapture::FrameCapture(OpenGLES_2_0& pGL) :
+	gl(pGL),
+	framebuffer(0),
+	width(0),
+	height(0),
+	useGLFramebuffer(true),
+	format(CAPTURE_RAW),
+	file(NULL),
+	interval(1),
+	callCount(0),
+	bufferCount(0),
+	freeCount(0),
+	queueStart(0),
+	queueCount(0),
+	scratch(NULL),
+	running(false),
+	quit(false),
+	framesCaptured(0),
+	framesDropped(0),
+	framesWritten(0)
+{
+	path[0] = 0;
+	memset(pixels,0,sizeof(pixels));
+	pthread_mutex_init(&mutex,NULL);
+	pthread_cond_init(&changed,NULL);
+}
+
+FrameCapture::~FrameCapture()
+{
+	Stop();
+	pthread_cond_destroy(&changed);
+	pthread_mutex_destroy(&mutex);
+}
+
+void FrameCapture::SetSource(GLuint pFramebuffer,int pWidth,int pHeight)
+{
+	assert( !running );
+	framebuffer = pFramebuffer;
+	width = pWidth;
+	height = pHeight;
+	useGLFramebuffer = false;
+}
+
+bool FrameCapture::Start(const char* pPath,CaptureFormat pFormat,int pInterval,int pBufferCount)
+{
+	if( running )
+	{
+		printf("FrameCapture::Start: already capturing to %s\n",path);
+		return false;
+	}
+
+	if( useGLFramebuffer )
+	{
+		framebuffer = gl.GetFramebuffer();
+		width = gl.GetWidth();
+		height = gl.GetHeight();
+	}
+
+	format = pFormat;
+	interval = pInterval > 0 ? pInterval : 1;
+	bufferCount = pBufferCount < 1 ? 1 : (pBufferCount > MAX_BUFFERS ? MAX_BUFFERS : pBufferCount);
+	snprintf(path,sizeof(path),"%s",pPath);
+	if( format == CAPTURE_PNG && GetFormatFromName(path) == CAPTURE_PNG )
+	{// The .png goes after the frame number.
+		*strrchr(path,'.') = 0;
+	}
+	MakeCRCTable();
+
+	if( format != CAPTURE_PNG )
+	{
+		file = fopen(path,"wb");
+		if( file == NULL )
+		{
+			printf("FrameCapture::Start: could not create %s\n",path);
+			return false;
+		}
+
+		if( format == CAPTURE_Y4M )
+		{
+			fprintf(file,"YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg\n",width,height,Y4M_RATE,interval);
+		}
+		else
+		{
+			printf("FrameCapture: raw RGBA %dx%d, play with ffmpeg -f rawvideo -pix_fmt rgba -s %dx%d -i %s\n",width,height,width,height,path);
+		}
+	}
+
+	const size_t frameBytes = (size_t)width * height * 4;
+	for( int n = 0 ; n < bufferCount ; n++ )
+	{
+		pixels[n] = (uint8_t*)malloc(frameBytes);
+		freeBuffers[n] = n;
+	}
+	freeCount = bufferCount;
+	queueStart = 0;
+	queueCount = 0;
+
+	// Big enough for the filtered PNG rows or the three y4m planes.
+	scratch = (uint8_t*)malloc((size_t)height * (1 + width * 3));
+
+	callCount = 0;
+	framesCaptured = 0;
+	framesDropped = 0;
+	framesWritten = 0;
+	quit = false;
+	if( pthread_create(&thread,NULL,ThreadMain,this) != 0 )
+	{
+		printf("FrameCapture::Start: failed to create the thread\n");
+		FreeBuffers();
+		return false;
+	}
+
+	running = true;
+	return true;
+}
+
+void FrameCapture::Stop()
+{
+	if( !running )
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&mutex);
+	quit = true;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&mutex);
+	pthread_join(thread,NULL);
+	running = false;
+
+	printf("FrameCapture: %d frames written to %s, %d dropped\n",framesWritten,path,framesDropped);
+	FreeBuffers();
+}
+
+void FrameCapture::CaptureFrame()
+{
+	if( !running || (callCount++ % interval) != 0 )
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&mutex);
+	const int buffer = freeCount > 0 ? freeBuffers[--freeCount] : -1;
+	pthread_mutex_unlock(&mutex);
+	if( buffer < 0 )
+	{// The worker is behind, better to miss a frame than stall the render loop.
+		framesDropped++;
+		return;
+	}
+
+	GLint previous = 0;
+	if( framebuffer != 0 )
+	{
+		glGetIntegerv(GL_FRAMEBUFFER_BINDING,&previous);
+		glBindFramebuffer(GL_FRAMEBUFFER,framebuffer);
+	}
+
+	// RGBA rows are always 4 byte aligned, but the application's pack alignment is put back all the same.
+	GLint packAlignment = 4;
+	glGetIntegerv(GL_PACK_ALIGNMENT,&packAlignment);
+	glPixelStorei(GL_PACK_ALIGNMENT,1);
+	glReadPixels(0,0,width,height,GL_RGBA,GL_UNSIGNED_BYTE,pixels[buffer]);
+	CHECK_OGL_ERRORS();
+	glPixelStorei(GL_PACK_ALIGNMENT,packAlignment);
+
+	if( framebuffer != 0 )
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER,previous);
+	}
+
+	frameNumbers[buffer] = framesCaptured++;
+	pthread_mutex_lock(&mutex);
+	queue[(queueStart + queueCount) % MAX_BUFFERS] = buffer;
+	queueCount++;
+	pthread_cond_signal(&changed);
+	pthread_mutex_unlock(&mutex);
+}
+
+CaptureFormat FrameCapture::GetFormatFromName(const char* path)
+{
+	const char* extension = strrchr(path,'.');
+	if( extension != NULL && strcasecmp(extension,".y4m") == 0 )
+		return CAPTURE_Y4M;
+	if( extension != NULL && strcasecmp(extension,".png") == 0 )
+		return CAPTURE_PNG;
+	return CAPTURE_RAW;
+}
+
+void* FrameCapture::ThreadMain(void* frameCapture)
+{
+	((FrameCapture*)frameCapture)->WorkerLoop();
+	return NULL;
+}
+
+void FrameCapture::WorkerLoop()
+{
+	for(;;)
+	{
+		pthread_mutex_lock(&mutex);
+		while( queueCount == 0 && !quit )
+		{
+			pthread_cond_wait(&changed,&mutex);
+		}
+		if( queueCount == 0 )
+		{// Told to quit and everything captured has been written.
+			pthread_mutex_unlock(&mutex);
+			break;
+		}
+		const int buffer = queue[queueStart];
+		queueStart = (queueStart + 1) % MAX_BUFFERS;
+		queueCount--;
+		pthread_mutex_unlock(&mutex);
+
+		if( WriteFrame(pixels[buffer],frameNumbers[buffer]) )
+		{
+			framesWritten++;
+		}
+
+		pthread_mutex_lock(&mutex);
+		freeBuffers[freeCount++] = buffer;
+		pthread_mutex_unlock(&mutex);
+	}
+
+	if( file != NULL )
+	{
+		fclose(file);
+		file = NULL;
+	}
+}
+
+bool FrameCapture::WriteFrame(uint8_t* rgba,int frameNumber)
+{
+	// GL reads bottom row first, files want the top row first.
+	OpenGLES_2_0::FlipRows(rgba,width * 4,height);
+
+	switch( format )
+	{
+	case CAPTURE_RAW:
+		return fwrite(rgba,(size_t)width * height * 4,1,file) == 1;
+
+	case CAPTURE_Y4M:
+		return WriteY4M(rgba);
+
+	case CAPTURE_PNG:
+		return WritePNG(rgba,frameNumber);
+	}
+	return false;
+}
+
+bool FrameCapture::WriteY4M(const uint8_t* rgba)
+{
+	// Full range BT.601 to match C420jpeg, chroma is the average of each 2x2 block.
+	const int chromaWidth = (width + 1) / 2;
+	const int chromaHeight = (height + 1) / 2;
+	uint8_t* y = scratch;
+	uint8_t* u = y + width * height;
+	uint8_t* v = u + chromaWidth * chromaHeight;
+
+	for( int n = 0 ; n < width * height ; n++ )
+	{
+		const uint8_t* p = rgba + n * 4;
+		y[n] = (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+	}
+
+	for( int cy = 0 ; cy < chromaHeight ; cy++ )
+	{
+		for( int cx = 0 ; cx < chromaWidth ; cx++ )
+		{
+			int r = 0,g = 0,b = 0;
+			for( int n = 0 ; n < 4 ; n++ )
+			{
+				const int px = cx * 2 + (n & 1) < width ? cx * 2 + (n & 1) : width - 1;
+				const int py = cy * 2 + (n >> 1) < height ? cy * 2 + (n >> 1) : height - 1;
+				const uint8_t* p = rgba + (py * width + px) * 4;
+				r += p[0];
+				g += p[1];
+				b += p[2];
+			}
+			u[cy * chromaWidth + cx] = ClampByte(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128);
+			v[cy * chromaWidth + cx] = ClampByte(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128);
+		}
+	}
+
+	const size_t bytes = (size_t)width * height + 2 * chromaWidth * chromaHeight;
+	return fputs("FRAME\n",file) >= 0 && fwrite(scratch,bytes,1,file) == 1;
+}
+
+bool FrameCapture::WritePNG(const uint8_t* rgba,int frameNumber)
+{
+	char name[sizeof(path) + 16];
+	snprintf(name,sizeof(name),"%s%05d.png",path,frameNumber);
+	FILE* png = fopen(name,"wb");
+	if( png == NULL )
+	{
+		printf("FrameCapture: could not create %s\n",name);
+		return false;
+	}
+
+	// Each row is a filter type byte, 0 for none, then RGB. Alpha is dropped, the back buffer's is not meaningful.
+	const size_t rowBytes = 1 + (size_t)width * 3;
+	const size_t imageBytes = rowBytes * height;
+	for( int row = 0 ; row < height ; row++ )
+	{
+		uint8_t* out = scratch + row * rowBytes;
+		const uint8_t* in = rgba + (size_t)row * width * 4;
+		*out++ = 0;
+		for( int x = 0 ; x < width ; x++ , in += 4 , out += 3 )
+		{
+			out[0] = in[0];
+			out[1] = in[1];
+			out[2] = in[2];
+		}
+	}
+
+	static const uint8_t signature[8] = {0x89,'P','N','G','\r','\n',0x1a,'\n'};
+	fwrite(signature,1,8,png);
+
+	PNGChunk header(png,"IHDR",13);
+	header.WriteBigEndian(width);
+	header.WriteBigEndian(height);
+	static const uint8_t headerRest[5] = {8,2,0,0,0};	// 8 bit RGB, deflate, no interlace.
+	header.Write(headerRest,5);
+	header.End();
+
+	// Stored deflate blocks, no compression, so there is no need for zlib and it costs the worker next to nothing.
+	const size_t blocks = (imageBytes + PNG_BLOCK - 1) / PNG_BLOCK;
+	PNGChunk data(png,"IDAT",(uint32_t)(2 + blocks * 5 + imageBytes + 4));
+	static const uint8_t zlibHeader[2] = {0x78,0x01};
+	data.Write(zlibHeader,2);
+
+	uint32_t adlerA = 1,adlerB = 0;
+	for( size_t start = 0 ; start < imageBytes ; start += PNG_BLOCK )
+	{
+		const size_t length = imageBytes - start < (size_t)PNG_BLOCK ? imageBytes - start : PNG_BLOCK;
+		const uint8_t block[5] = {(uint8_t)(start + length == imageBytes ? 1 : 0),
+				(uint8_t)length,(uint8_t)(length >> 8),(uint8_t)~length,(uint8_t)(~length >> 8)};
+		data.Write(block,5);
+		data.Write(scratch + start,length);
+
+		for( size_t n = start ; n < start + length ; n++ )
+		{
+			adlerA = (adlerA + scratch[n]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+	}
+	data.WriteBigEndian((adlerB << 16) | adlerA);
+	data.End();
+
+	PNGChunk end(png,"IEND",0);
+	end.End();
+
+	const bool ok = ferror(png) == 0;
+	fclose(png);
+	return ok;
+}
+
+void FrameCapture::FreeBuffers()
+{
+	for( int n = 0 ; n < MAX_BUFFERS ; n++ )
+	{
+		free(pixels[n]);
+		pixels[n] = NULL;
+	}
+	free(scratch);
+	scratch = NULL;
+	if( file != NULL )
+	{
+		fclose(file);
+		file = NULL;
+	}
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,172 @@
+/*
+ * FrameCapture.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECAPTURE_H_
+#define FRAMECAPTURE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "GLHeaders.h"
+
+namespace BogDog
+{
+
+struct OpenGLES_2_0;
+
+typedef enum
+{
+	CAPTURE_RAW,	//!<RGBA frames, top row first, one after the other in one file.
+	CAPTURE_Y4M,	//!<YUV4MPEG2 4:2:0 in one file, plays in mpv and ffmpeg reads it.
+	CAPTURE_PNG		//!<A file per frame, RGB.
+}CaptureFormat;
+
+/**
+ * Records rendered frames to disk for soak tests and reference images.
+ * CaptureFrame reads the frame with glReadPixels into one of a pool of buffers, a worker thread flips it,
+ * converts it and writes it so the render loop only pays for the read. GLES 2.0 has no pixel buffer objects
+ * so the read itself still waits for the GPU to finish the frame, capture every few frames to keep the cost down.
+ * If the worker falls behind and no buffer is free the frame is dropped, the render loop never waits for the disk.
+ *
+ *	FrameCapture capture(gl);
+ *	capture.Start("soak.y4m",CAPTURE_Y4M,10);
+ *	while( ... )
+ *	{
+ *		...draw...
+ *		capture.CaptureFrame();
+ *		gl.Update();
+ *	}
+ *	capture.Stop();
+ *
+ * Call CaptureFrame after drawing and before OpenGLES_2_0::Update, the back buffer is undefined after the swap.
+ * With a RenderThread call it from the frame callback, it has to be on the thread that owns the context.
+ */
+struct FrameCapture
+{
+	static const int MAX_BUFFERS = 16;
+
+	FrameCapture(OpenGLES_2_0& gl);
+	~FrameCapture();
+
+	/**
+	 * Captures from a framebuffer object instead of the one OpenGLES_2_0 draws to. Set before Start.
+	 * @param framebuffer The FBO, 0 for the window's back buffer.
+	 */
+	void SetSource(GLuint framebuffer,int width,int height);
+
+	/**
+	 * Opens the file and starts the worker.
+	 * @param path For CAPTURE_RAW and CAPTURE_Y4M the file all frames go in. For CAPTURE_PNG the start of each
+	 * file's name, the frame number and .png are added, so "shots/frame" or "shots/frame.png" give shots/frame00000.png on.
+	 * @param interval Capture every interval'th call to CaptureFrame, 1 for all of them.
+	 * @param bufferCount Frames that can be waiting for the worker before frames are dropped, up to MAX_BUFFERS.
+	 */
+	bool Start(const char* path,CaptureFormat format,int interval = 1,int bufferCount = 4);
+
+	/**
+	 * Writes the frames still waiting, stops the worker and closes the file.
+	 */
+	void Stop();
+
+	/**
+	 * Reads the frame if it is one to capture, call once a frame.
+	 */
+	void CaptureFrame();
+
+	bool IsRunning()
+	{
+		return running;
+	}
+
+	/**
+	 * @return The frames read back since Start.
+	 */
+	int getFramesCaptured()
+	{
+		return framesCaptured;
+	}
+
+	/**
+	 * @return The frames that were not captured as all the buffers were waiting for the worker.
+	 */
+	int getFramesDropped()
+	{
+		return framesDropped;
+	}
+
+	/**
+	 * @return The frames the worker has written. Read it after Stop for the final count.
+	 */
+	int getFramesWritten()
+	{
+		return framesWritten;
+	}
+
+	/**
+	 * @return The format for a file name's extension, .y4m, .png, anything else is raw.
+	 */
+	static CaptureFormat GetFormatFromName(const char* path);
+
+private:
+	OpenGLES_2_0& gl;
+	GLuint framebuffer;
+	int width,height;
+	bool useGLFramebuffer;		//!<True until SetSource is called, the source is whatever OpenGLES_2_0 draws to.
+
+	CaptureFormat format;
+	char path[256];
+	FILE* file;					//!<For raw and y4m, PNG opens a file per frame.
+	int interval;
+	int callCount;
+
+	uint8_t* pixels[MAX_BUFFERS];
+	int frameNumbers[MAX_BUFFERS];
+	int bufferCount;
+	int freeBuffers[MAX_BUFFERS];
+	int freeCount;
+	int queue[MAX_BUFFERS];		//!<Buffers waiting for the worker, in the order they were read.
+	int queueStart,queueCount;
+	uint8_t* scratch;			//!<The worker's converted frame.
+
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+	bool running;
+	bool quit;
+
+	int framesCaptured;
+	int framesDropped;
+	int framesWritten;
+
+	static void* ThreadMain(void* frameCapture);
+	void WorkerLoop();
+
+	/**
+	 * Converts and writes one frame, on the worker thread.
+	 */
+	bool WriteFrame(uint8_t* rgba,int frameNumber);
+	bool WriteY4M(const uint8_t* rgba);
+	bool WritePNG(const uint8_t* rgba,int frameNumber);
+	void FreeBuffers();
+};
+
+} /* namespace BogDog */
+#endif /* FRAMECAPTURE_H_ */
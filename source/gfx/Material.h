@@ -0,0 +1,64 @@
+/*
+ * Material.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATERIAL_H_
+#define MATERIAL_H_
+
+#include "GLHeaders.h"
+#include "gl/OpenGLES20.h"
+
+namespace BogDog
+{
+
+struct GLShader;
+
+/**
+ * How a set of triangles is drawn, the shader, the texture for unit 0 and the blend mode.
+ */
+struct Material
+{
+	GLShader* shader;
+	GLint texture;		//!<0 for none.
+	BLENDMODE blend;
+
+	void Set(GLShader* pShader,GLint pTexture,BLENDMODE pBlend)
+	{
+		shader = pShader;
+		texture = pTexture;
+		blend = pBlend;
+	}
+
+	bool operator ==(const Material& other)const
+	{
+		return shader == other.shader && texture == other.texture && blend == other.blend;
+	}
+
+	/**
+	 * Sets the GL blend state for the blend mode.
+	 */
+	void ApplyBlend()const
+	{
+		OpenGLES_2_0::SetBlendMode(blend);
+	}
+};
+
+} /* namespace BogDog */
+#endif /* MATERIAL_H_ */
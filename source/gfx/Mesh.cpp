@@ -19,6 +19,8 @@
  * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <assert.h>
+#include <stdio.h>
 #include "gfx/Mesh.h"
 #include "gl/GLShader.h"
 
@@ -27,27 +29,200 @@ namespace BogDog
 
 Mesh::Mesh(float* xyz,float* uv0,int* colours,int vertexCount)
 {
-	mXYZ = new GLBufferXYZ(xyz,vertexCount*3,true);
-	mColours = colours == NULL?NULL:new GLBufferColour(colours,vertexCount,true);
-	mUV0 = uv0 == NULL?NULL:new GLBufferXY(uv0,vertexCount*2,true);
+	if( colours != NULL && uv0 != NULL )
+	{
+		BuildFromStreams< VertexFormat<Pos3f,ColourU8x4,UV2f> >(xyz,uv0,colours,vertexCount);
+	}
+	else if( colours != NULL )
+	{
+		BuildFromStreams< VertexFormat<Pos3f,ColourU8x4> >(xyz,uv0,colours,vertexCount);
+	}
+	else if( uv0 != NULL )
+	{
+		BuildFromStreams< VertexFormat<Pos3f,UV2f> >(xyz,uv0,colours,vertexCount);
+	}
+	else
+	{
+		BuildFromStreams< VertexFormat<Pos3f> >(xyz,uv0,colours,vertexCount);
+	}
+}
+
+Mesh::Mesh(const void* vertices,int vertexCount,int stride,void (*enableFormat)(int),void (*readFormat)(const uint8_t*,VertexSource&),uint32_t attribMask)
+{
+	Setup(vertices,vertexCount,stride,enableFormat,readFormat,attribMask);
+}
+
+Mesh::Mesh(const void* vertices,int vertexCount,int stride,void (*enableFormat)(int),void (*readFormat)(const uint8_t*,VertexSource&),uint32_t attribMask,const uint16_t* indices,int indexCount)
+{
+	Setup(vertices,vertexCount,stride,enableFormat,readFormat,attribMask);
+	mIndices = new GLBufferIndex(indices,indexCount,true);
+	if( !hasCPUCopy() )
+	{
+		mIndices->ReleaseShadowCopy();
+	}
+}
+
+Mesh* Mesh::CreateInstanced(Mesh* source,int copies)
+{
+	if( !source->hasCPUCopy() )
+	{
+		printf("Mesh::CreateInstanced: the source mesh has no CPU copy, it has more than %d vertices\n",CPU_COPY_MAX_VERTICES);
+		return NULL;
+	}
+
+	const int vertexCount = source->getVertexCount();
+	const int cornerCount = source->getCornerCount();
+
+	//The copy index is a byte and the indices are 16 bit.
+	if( copies > 256 )
+	{
+		copies = 256;
+	}
+	if( copies * vertexCount > 0x10000 )
+	{
+		copies = 0x10000 / vertexCount;
+	}
+
+	uint8_t* vertices = new uint8_t[copies * vertexCount * InstancedFormat::STRIDE];
+	uint16_t* indices = new uint16_t[copies * cornerCount];
+
+	VertexSource vertex;
+	uint8_t* dest = vertices;
+	for( int copy = 0 ; copy < copies ; copy++ )
+	{
+		for( int n = 0 ; n < vertexCount ; n++ , dest += InstancedFormat::STRIDE )
+		{
+			source->ReadVertex(n,vertex);
+			vertex.instance = copy;
+			InstancedFormat::Write(dest,vertex);
+		}
+
+		for( int n = 0 ; n < cornerCount ; n++ )
+		{
+			indices[(copy * cornerCount) + n] = (uint16_t)((copy * vertexCount) + source->getCornerVertex(n));
+		}
+	}
+
+	Mesh* newMesh = Create<InstancedFormat>(vertices,copies * vertexCount,indices,copies * cornerCount);
+	newMesh->mInstanceCopies = copies;
+	delete []vertices;
+	delete []indices;
+	return newMesh;
+}
+
+void Mesh::Enable(GLShader* shader)
+{
+	mVertices->Bind();
+	mEnableFormat(0);
+	if( mIndices != NULL )
+	{
+		mIndices->Bind();
+	}
+	shader->setPositionDequantise(mQuantised ? &mDequantise : NULL);
 }
 
-void Mesh::Enable()
+void Mesh::ReadVertex(int index,VertexSource& vertex)
 {
-	mXYZ->Enable(ATTRIB_POS,false, 0);
-	if( mColours != NULL )
+	assert( hasCPUCopy() );
+	mReadFormat((const uint8_t*)mVertices->getShadowCopy() + (index * mVertices->getElementSize()),vertex);
+	if( mQuantised )
 	{
-		mColours->Enable(ATTRIB_COLOUR,true, 0);
+		vertex.xyz.MatrixMul(&mDequantise);
 	}
-	if( mUV0 != NULL )
+}
+
+void Mesh::setSubMeshes(const SubMesh* subMeshes,int count)
+{
+	delete []mSubMeshes;
+	mSubMeshes = NULL;
+	mSubMeshCount = 0;
+
+	if( subMeshes != NULL && count > 0 )
+	{
+		mSubMeshes = new SubMesh[count];
+		mSubMeshCount = count;
+		for( int n = 0 ; n < count ; n++ )
+		{
+			mSubMeshes[n] = subMeshes[n];
+		}
+	}
+}
+
+void Mesh::DrawSubMeshes(const Matrix& projInvcam,const Matrix& transform)
+{
+	Matrix trans = transform;
+	GLShader* active = NULL;
+	for( int n = 0 ; n < mSubMeshCount ; n++ )
 	{
-		mUV0->Enable(ATTRIB_UV0,true, 0);
+		const SubMesh& subMesh = mSubMeshes[n];
+		assert( subMesh.material.shader != NULL );
+		if( subMesh.material.shader != active )
+		{
+			active = subMesh.material.shader;
+			active->Enable(projInvcam);
+			Enable(active);
+			active->setTransform(trans);
+			active->setGlobalColour(1.0f,1.0f,1.0f,1.0f);
+		}
+
+		if( subMesh.material.texture != 0 )
+		{
+			active->setTexture(0,subMesh.material.texture);
+		}
+		subMesh.material.ApplyBlend();
+
+		Draw(subMesh.firstTriangle,subMesh.triangleCount);
 	}
 }
 
 Mesh::~Mesh()
 {
+	delete mVertices;
+	delete mIndices;
+	delete []mSubMeshes;
+}
 
+template <class FORMAT> void Mesh::BuildFromStreams(float* xyz,float* uv0,int* colours,int vertexCount)
+{
+	uint8_t* vertices = new uint8_t[vertexCount * FORMAT::STRIDE];
+	VertexSource source;
+	source.colour = -1;
+	source.uv0.Set(0,0);
+	for( int n = 0 ; n < vertexCount ; n++ )
+	{
+		source.xyz.Set(xyz[(n*3) + 0],xyz[(n*3) + 1],xyz[(n*3) + 2]);
+		if( colours != NULL )
+		{
+			source.colour = colours[n];
+		}
+		if( uv0 != NULL )
+		{
+			source.uv0.Set(uv0[(n*2) + 0],uv0[(n*2) + 1]);
+		}
+		FORMAT::Write(vertices + (n * FORMAT::STRIDE),source);
+	}
+
+	Setup(vertices,vertexCount,FORMAT::STRIDE,FORMAT::Enable,FORMAT::Read,FORMAT::ATTRIB_MASK);
+	delete []vertices;
+}
+
+void Mesh::Setup(const void* vertices,int vertexCount,int stride,void (*enableFormat)(int),void (*readFormat)(const uint8_t*,VertexSource&),uint32_t attribMask)
+{
+	mVertices = new GLBufferInterleaved(vertices,vertexCount,stride,true);
+	mIndices = NULL;
+	mQuantised = false;
+	mInstanceCopies = 1;
+	mSubMeshes = NULL;
+	mSubMeshCount = 0;
+	mEnableFormat = enableFormat;
+	mReadFormat = readFormat;
+	mAttribMask = attribMask;
+
+	//Data is now on the GPU. Only small meshes are read back, by Batcher, so the rest don't need the CPU copy.
+	if( vertexCount > CPU_COPY_MAX_VERTICES )
+	{
+		mVertices->ReleaseShadowCopy();
+	}
 }
 
 } /* namespace BogDog */
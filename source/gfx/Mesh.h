@@ -22,39 +22,209 @@
 #ifndef MESH_H_
 #define MESH_H_
 
+#include <assert.h>
 #include "GLHeaders.h"
 #include "gl/GLBuffer.h"
+#include "gl/VertexFormat.h"
+#include "maths/Matrix.h"
+#include "Material.h"
 
 namespace BogDog
 {
 
+struct GLShader;
+
 struct Mesh
 {
+	/**
+	 * A range of triangles drawn with their own material, so one vertex buffer can hold a model with many materials.
+	 */
+	struct SubMesh
+	{
+		int firstTriangle;
+		int triangleCount;
+		int firstVertex;	//!<The lowest vertex the triangles use.
+		int vertexCount;	//!<Vertices from firstVertex to the highest one the triangles use.
+		Material material;
+	};
+
+	/**
+	 * Meshes with this many vertices or less keep a copy of their data on the CPU so Batcher can merge them.
+	 */
+	static const int CPU_COPY_MAX_VERTICES = 256;
 
+	/**
+	 * The vertex format of meshes made by CreateInstanced.
+	 */
+	typedef VertexFormat<Pos3f,ColourU8x4,UV2f,InstanceIndex> InstancedFormat;
+
+	/**
+	 * Creates the mesh from separate streams, they are interleaved into one vertex buffer.
+	 * uv0 and colours can be NULL.
+	 */
 	Mesh(float* xyz,float* uv0,int* colours,int vertexCount);
+
+	/**
+	 * Creates the mesh from vertices that are already interleaved.
+	 * Use the Create template so the stride and stream setup come from the vertex format.
+	 * @param vertices The vertex data, vertexCount * stride bytes.
+	 * @param vertexCount Number of vertices.
+	 * @param stride Size of one vertex in bytes.
+	 * @param enableFormat The function that sets the vertex streams, normally VertexFormat::Enable.
+	 * @param readFormat The function that reads a vertex back, normally VertexFormat::Read.
+	 * @param attribMask Bit mask of the attribute locations in the vertex.
+	 */
+	Mesh(const void* vertices,int vertexCount,int stride,void (*enableFormat)(int),void (*readFormat)(const uint8_t*,VertexSource&),uint32_t attribMask);
+
+	/**
+	 * Creates an indexed mesh from vertices that are already interleaved.
+	 * @param indices Three indices per triangle.
+	 * @param indexCount The number of indices.
+	 */
+	Mesh(const void* vertices,int vertexCount,int stride,void (*enableFormat)(int),void (*readFormat)(const uint8_t*,VertexSource&),uint32_t attribMask,const uint16_t* indices,int indexCount);
+
 	~Mesh();
 
+	/**
+	 * Creates a mesh for vertices written in the vertex format FORMAT.
+	 */
+	template <class FORMAT> static Mesh* Create(const void* vertices,int vertexCount)
+	{
+		return new Mesh(vertices,vertexCount,FORMAT::STRIDE,FORMAT::Enable,FORMAT::Read,FORMAT::ATTRIB_MASK);
+	}
+
+	/**
+	 * Creates an indexed mesh for vertices written in the vertex format FORMAT.
+	 */
+	template <class FORMAT> static Mesh* Create(const void* vertices,int vertexCount,const uint16_t* indices,int indexCount)
+	{
+		return new Mesh(vertices,vertexCount,FORMAT::STRIDE,FORMAT::Enable,FORMAT::Read,FORMAT::ATTRIB_MASK,indices,indexCount);
+	}
+
+	/**
+	 * Creates a mesh that is copies of source one after the other, each vertex has the index of the copy it is in.
+	 * Used with GLShader::DrawInstanced to draw many copies with one draw call.
+	 * @param source The mesh to copy, must have a CPU copy, see CPU_COPY_MAX_VERTICES.
+	 * @param copies How many copies, fewer are made if they would need more than 65536 vertices or 256 copies.
+	 * @return The new mesh, NULL if source has no CPU copy.
+	 */
+	static Mesh* CreateInstanced(Mesh* source,int copies);
+
 	bool hasColours()
 	{
-		return mColours != NULL;
+		return (mAttribMask & (1u<<ATTRIB_COLOUR)) != 0;
 	}
 
 	bool hasUV0()
 	{
-		return mUV0 != NULL;
+		return (mAttribMask & (1u<<ATTRIB_UV0)) != 0;
+	}
+
+	bool isIndexed()
+	{
+		return mIndices != NULL;
+	}
+
+	int getVertexCount()
+	{
+		return mVertices->getCount();
+	}
+
+	int getTriangleCount()
+	{
+		return (mIndices != NULL ? mIndices->getCount() : mVertices->getCount()) / 3;
+	}
+
+	/**
+	 * The number of copies of the geometry in the mesh, 1 unless made by CreateInstanced.
+	 */
+	int getInstanceCopies()
+	{
+		return mInstanceCopies;
 	}
 
 	/**
-	 * Enables the vertex buffers and sets the streams.
+	 * True if the positions are quantised, see setPositionDequantise.
 	 */
-	void Enable();
+	bool isQuantised()
+	{
+		return mQuantised;
+	}
+
+	/**
+	 * For meshes with quantised positions, sets the matrix that scales and offsets them back to model space.
+	 */
+	void setPositionDequantise(const Matrix& dequantise)
+	{
+		mDequantise = dequantise;
+		mQuantised = true;
+	}
+
+	const Matrix& getPositionDequantise()
+	{
+		return mDequantise;
+	}
+
+	/**
+	 * True if the mesh is small enough to have kept a CPU copy of it's vertices and indices, see CPU_COPY_MAX_VERTICES.
+	 */
+	bool hasCPUCopy()
+	{
+		return mVertices->getShadowCopy() != NULL && (mIndices == NULL || mIndices->getShadowCopy() != NULL);
+	}
+
+	/**
+	 * Reads a vertex from the CPU copy. The position is in model space, quantised positions are scaled back.
+	 */
+	void ReadVertex(int index,VertexSource& vertex);
+
+	/**
+	 * The number of triangle corners, three per triangle.
+	 */
+	int getCornerCount()
+	{
+		return getTriangleCount() * 3;
+	}
+
+	/**
+	 * Returns the vertex used by triangle corner n from the CPU copy, for meshes without indices this is n.
+	 */
+	int getCornerVertex(int n)
+	{
+		return mIndices != NULL ? ((const uint16_t*)mIndices->getShadowCopy())[n] : n;
+	}
+
+	/**
+	 * Sets the table of sub meshes, the ranges are copied. Pass NULL and 0 to remove it.
+	 */
+	void setSubMeshes(const SubMesh* subMeshes,int count);
+
+	/**
+	 * The number of sub meshes, 0 if the mesh does not have a material table.
+	 */
+	int getSubMeshCount()
+	{
+		return mSubMeshCount;
+	}
+
+	const SubMesh& getSubMesh(int index)
+	{
+		assert( index >= 0 && index < mSubMeshCount );
+		return mSubMeshes[index];
+	}
+
+	/**
+	 * Enables the vertex buffers and sets the streams, also tells the shader if the positions need scaling back.
+	 * Call before setting the transform on the shader. The shader keeps the setting, so always bind meshes with this.
+	 */
+	void Enable(GLShader* shader);
 
 	/**
 	 * Draws all the triangles.
 	 */
 	void Draw()
 	{
-		Draw(0,mXYZ->getCount());
+		Draw(0,getTriangleCount());
 	}
 
 	/**
@@ -64,13 +234,51 @@ struct Mesh
 	 */
 	void Draw(int first,int count)
 	{
-		glDrawArrays(GL_TRIANGLES, first * 3,count);
+		if( mVertices->isEmpty() || (mIndices != NULL && mIndices->isEmpty()) )
+		{// The GPU memory budget refused a buffer, there is nothing to draw from.
+			return;
+		}
+		OpenGLES_2_0::CountDraw(count * 3);
+		if( mIndices != NULL )
+		{
+			glDrawElements(GL_TRIANGLES,count * 3,GL_UNSIGNED_SHORT,(const GLvoid*)(size_t)(first * 3 * sizeof(uint16_t)));
+		}
+		else
+		{
+			glDrawArrays(GL_TRIANGLES,first * 3,count * 3);
+		}
+	}
+
+	/**
+	 * Draws the triangles of one sub mesh, the material is not set.
+	 */
+	void DrawSubMesh(int index)
+	{
+		const SubMesh& subMesh = getSubMesh(index);
+		Draw(subMesh.firstTriangle,subMesh.triangleCount);
 	}
 
+	/**
+	 * Draws every sub mesh with it's material. The shaders are enabled as needed, the global colour is set to white.
+	 * @param projInvcam The projection and camera matrix for the shaders.
+	 * @param transform The transform for the mesh.
+	 */
+	void DrawSubMeshes(const Matrix& projInvcam,const Matrix& transform);
+
 private:
-	GLBufferXYZ* mXYZ;
-	GLBufferColour* mColours;
-	GLBufferXY* mUV0;
+	GLBufferInterleaved* mVertices;
+	GLBufferIndex* mIndices;
+	void (*mEnableFormat)(int);
+	void (*mReadFormat)(const uint8_t*,VertexSource&);
+	uint32_t mAttribMask;
+	Matrix mDequantise;
+	bool mQuantised;
+	int mInstanceCopies;
+	SubMesh* mSubMeshes;
+	int mSubMeshCount;
+
+	template <class FORMAT> void BuildFromStreams(float* xyz,float* uv0,int* colours,int vertexCount);
+	void Setup(const void* vertices,int vertexCount,int stride,void (*enableFormat)(int),void (*readFormat)(const uint8_t*,VertexSource&),uint32_t attribMask);
 };
 
 } /* namespace BogDog */
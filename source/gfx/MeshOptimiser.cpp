@@ -0,0 +1,546 @@
+/*
+ * MeshOptimiser.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <algorithm>
+#include "gfx/MeshOptimiser.h"
+
+namespace BogDog
+{
+
+/**
+ * A FIFO post transform cache, used to work out the cache stats and where the overdraw clusters can split.
+ */
+struct FIFOCacheSim
+{
+	FIFOCacheSim(int pVertexCount,int pCacheSize)
+	{
+		cacheSize = pCacheSize;
+		timestamps = new int[pVertexCount];
+		vertexCount = pVertexCount;
+		Reset();
+	}
+
+	~FIFOCacheSim()
+	{
+		delete []timestamps;
+	}
+
+	/**
+	 * Empties the cache.
+	 */
+	void Reset()
+	{
+		//A vertex is in the cache if it went in less than cacheSize misses ago.
+		time = cacheSize + 1;
+		memset(timestamps,0,sizeof(int) * vertexCount);
+	}
+
+	/**
+	 * @return The number of vertices of the triangle that missed the cache, 0 to 3.
+	 */
+	int Triangle(const uint16_t* tri)
+	{
+		int misses = 0;
+		for( int i = 0 ; i < 3 ; i++ )
+		{
+			const int v = tri[i];
+			if( time - timestamps[v] > cacheSize )
+			{
+				timestamps[v] = time++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+private:
+	int* timestamps;
+	int vertexCount;
+	int cacheSize;
+	int time;
+};
+
+MeshOptimiser::CacheStats MeshOptimiser::AnalyseVertexCache(const uint16_t* indices,int indexCount,int vertexCount,int cacheSize)
+{
+	CacheStats stats;
+	stats.transformed = 0;
+	stats.acmr = 0;
+	stats.atvr = 0;
+
+	if( indexCount < 3 || vertexCount < 1 )
+	{
+		return stats;
+	}
+
+	FIFOCacheSim cache(vertexCount,cacheSize);
+	bool* used = new bool[vertexCount];
+	memset(used,0,sizeof(bool) * vertexCount);
+	int uniqueCount = 0;
+
+	for( int n = 0 ; n < indexCount ; n += 3 )
+	{
+		stats.transformed += cache.Triangle(indices + n);
+		for( int i = 0 ; i < 3 ; i++ )
+		{
+			if( !used[indices[n+i]] )
+			{
+				used[indices[n+i]] = true;
+				uniqueCount++;
+			}
+		}
+	}
+	delete []used;
+
+	stats.acmr = (float)stats.transformed / (float)(indexCount / 3);
+	stats.atvr = (float)stats.transformed / (float)uniqueCount;
+	return stats;
+}
+
+/*
+ * Forsyth's scoring, see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+ * The LRU cache here is only used to pick the order, it does not have to match the hardware exactly.
+ */
+static const int MAX_SCORE_CACHE_SIZE = 32;
+static const float CACHE_DECAY_POWER = 1.5f;
+static const float LAST_TRI_SCORE = 0.75f;
+static const float VALENCE_BOOST_SCALE = 2.0f;
+static const float VALENCE_BOOST_POWER = 0.5f;
+
+static float VertexScore(int cachePosition,int remainingTriangles,int cacheSize)
+{
+	if( remainingTriangles == 0 )
+	{
+		//No triangles need this vertex.
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if( cachePosition >= 0 )
+	{
+		if( cachePosition < 3 )
+		{
+			//This vertex was used in the last triangle, so it has a fixed score whichever of the three it's in.
+			//Otherwise you can get very different answers depending on whether you add the triangle 1,2,3 or 3,1,2
+			score = LAST_TRI_SCORE;
+		}
+		else
+		{
+			//Points for being high in the cache.
+			const float scaler = 1.0f / (cacheSize - 3);
+			score = 1.0f - (cachePosition - 3) * scaler;
+			score = powf(score,CACHE_DECAY_POWER);
+		}
+	}
+
+	//Bonus points for having a low number of tris still to use the vert, so we get rid of lone verts quickly.
+	score += VALENCE_BOOST_SCALE * powf((float)remainingTriangles,-VALENCE_BOOST_POWER);
+	return score;
+}
+
+void MeshOptimiser::OptimiseVertexCache(uint16_t* indices,int indexCount,int vertexCount,int cacheSize)
+{
+	const int triangleCount = indexCount / 3;
+	if( triangleCount < 2 || vertexCount < 1 )
+	{
+		return;
+	}
+
+	if( cacheSize > MAX_SCORE_CACHE_SIZE )
+	{
+		cacheSize = MAX_SCORE_CACHE_SIZE;
+	}
+	if( cacheSize < 4 )
+	{
+		cacheSize = 4;
+	}
+
+	//Build the vertex to triangle adjacency.
+	int* remaining = new int[vertexCount];
+	int* adjacencyStart = new int[vertexCount + 1];
+	int* adjacency = new int[indexCount];
+	memset(remaining,0,sizeof(int) * vertexCount);
+	for( int n = 0 ; n < indexCount ; n++ )
+	{
+		remaining[indices[n]]++;
+	}
+
+	adjacencyStart[0] = 0;
+	for( int v = 0 ; v < vertexCount ; v++ )
+	{
+		adjacencyStart[v+1] = adjacencyStart[v] + remaining[v];
+	}
+
+	int* fill = new int[vertexCount];
+	memcpy(fill,adjacencyStart,sizeof(int) * vertexCount);
+	for( int t = 0 ; t < triangleCount ; t++ )
+	{
+		for( int i = 0 ; i < 3 ; i++ )
+		{
+			adjacency[fill[indices[(t*3)+i]]++] = t;
+		}
+	}
+	delete []fill;
+
+	//Initial scores.
+	int* cachePosition = new int[vertexCount];
+	float* vertexScore = new float[vertexCount];
+	for( int v = 0 ; v < vertexCount ; v++ )
+	{
+		cachePosition[v] = -1;
+		vertexScore[v] = VertexScore(-1,remaining[v],cacheSize);
+	}
+
+	float* triangleScore = new float[triangleCount];
+	bool* emitted = new bool[triangleCount];
+	for( int t = 0 ; t < triangleCount ; t++ )
+	{
+		triangleScore[t] = vertexScore[indices[(t*3)+0]] + vertexScore[indices[(t*3)+1]] + vertexScore[indices[(t*3)+2]];
+		emitted[t] = false;
+	}
+
+	uint16_t* output = new uint16_t[indexCount];
+	int cache[MAX_SCORE_CACHE_SIZE + 3];
+	int cacheUsed = 0;
+	int scanCursor = 0;
+
+	for( int outTriangle = 0 ; outTriangle < triangleCount ; outTriangle++ )
+	{
+		//Find the best triangle, only triangles using vertices in the cache will have changed score.
+		int best = -1;
+		float bestScore = -1.0f;
+		for( int c = 0 ; c < cacheUsed ; c++ )
+		{
+			const int v = cache[c];
+			for( int a = adjacencyStart[v] ; a < adjacencyStart[v] + remaining[v] ; a++ )
+			{
+				const int t = adjacency[a];
+				if( triangleScore[t] > bestScore )
+				{
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+
+		//Nothing connected to the cache, so start a new island from the next triangle not done.
+		//Not searching for the best one keeps this linear, it makes very little difference to the result.
+		if( best < 0 )
+		{
+			while( emitted[scanCursor] )
+			{
+				scanCursor++;
+			}
+			best = scanCursor;
+		}
+
+		assert( !emitted[best] );
+		emitted[best] = true;
+		const uint16_t* tri = indices + (best * 3);
+		memcpy(output + (outTriangle * 3),tri,sizeof(uint16_t) * 3);
+
+		//Remove the triangle from each of its vertices' active lists, they are kept packed at the front.
+		for( int i = 0 ; i < 3 ; i++ )
+		{
+			const int v = tri[i];
+			int* list = adjacency + adjacencyStart[v];
+			for( int a = 0 ; a < remaining[v] ; a++ )
+			{
+				if( list[a] == best )
+				{
+					list[a] = list[remaining[v] - 1];
+					remaining[v]--;
+					break;
+				}
+			}
+		}
+
+		//Move the triangle's vertices to the front of the LRU cache.
+		int newCache[MAX_SCORE_CACHE_SIZE + 3];
+		int newUsed = 0;
+		for( int i = 0 ; i < 3 ; i++ )
+		{
+			newCache[newUsed++] = tri[i];
+		}
+		for( int c = 0 ; c < cacheUsed ; c++ )
+		{
+			const int v = cache[c];
+			if( v != tri[0] && v != tri[1] && v != tri[2] )
+			{
+				newCache[newUsed++] = v;
+			}
+		}
+
+		//Anything pushed off the end is out of the cache.
+		for( int c = cacheSize ; c < newUsed ; c++ )
+		{
+			cachePosition[newCache[c]] = -1;
+			vertexScore[newCache[c]] = VertexScore(-1,remaining[newCache[c]],cacheSize);
+		}
+		cacheUsed = std::min(newUsed,cacheSize);
+		memcpy(cache,newCache,sizeof(int) * cacheUsed);
+
+		for( int c = 0 ; c < cacheUsed ; c++ )
+		{
+			cachePosition[cache[c]] = c;
+			vertexScore[cache[c]] = VertexScore(c,remaining[cache[c]],cacheSize);
+		}
+
+		//Rescore the triangles that use the vertices that moved. Evicted vertices' triangles get picked up next time they are scanned.
+		for( int c = 0 ; c < newUsed ; c++ )
+		{
+			const int v = newCache[c];
+			for( int a = adjacencyStart[v] ; a < adjacencyStart[v] + remaining[v] ; a++ )
+			{
+				const int t = adjacency[a];
+				triangleScore[t] = vertexScore[indices[(t*3)+0]] + vertexScore[indices[(t*3)+1]] + vertexScore[indices[(t*3)+2]];
+			}
+		}
+	}
+
+	memcpy(indices,output,sizeof(uint16_t) * indexCount);
+
+	delete []output;
+	delete []emitted;
+	delete []triangleScore;
+	delete []vertexScore;
+	delete []cachePosition;
+	delete []adjacency;
+	delete []adjacencyStart;
+	delete []remaining;
+}
+
+/**
+ * A run of triangles that can be moved as one without hurting the vertex cache much.
+ */
+struct OverdrawCluster
+{
+	int start;		//!<First triangle.
+	int count;		//!<Number of triangles.
+	float sortKey;	//!<How much the cluster faces out from the middle of the mesh, bigger is drawn first.
+};
+
+void MeshOptimiser::OptimiseOverdraw(uint16_t* indices,int indexCount,const Vector3* positions,int vertexCount,float threshold,int cacheSize)
+{
+	const int triangleCount = indexCount / 3;
+	if( triangleCount < 2 || vertexCount < 1 )
+	{
+		return;
+	}
+
+	//Hard boundaries are where the cache simulation has to start again, every vertex of the triangle missed.
+	FIFOCacheSim cache(vertexCount,cacheSize);
+	int* hardStarts = new int[triangleCount + 1];
+	int hardCount = 0;
+	for( int t = 0 ; t < triangleCount ; t++ )
+	{
+		if( cache.Triangle(indices + (t*3)) == 3 )
+		{
+			hardStarts[hardCount++] = t;
+		}
+	}
+	hardStarts[hardCount] = triangleCount;
+
+	//Soft boundaries split a hard cluster where starting with a cold cache is no more than threshold worse than the cluster's ACMR.
+	OverdrawCluster* clusters = new OverdrawCluster[triangleCount];
+	int clusterCount = 0;
+	for( int h = 0 ; h < hardCount ; h++ )
+	{
+		const int start = hardStarts[h];
+		const int end = hardStarts[h+1];
+
+		cache.Reset();
+		int misses = 0;
+		for( int t = start ; t < end ; t++ )
+		{
+			misses += cache.Triangle(indices + (t*3));
+		}
+		const float limit = threshold * (float)misses / (float)(end - start);
+
+		cache.Reset();
+		int clusterStart = start;
+		misses = 0;
+		for( int t = start ; t < end ; t++ )
+		{
+			misses += cache.Triangle(indices + (t*3));
+			const bool last = (t + 1) == end;
+			if( last || (float)misses / (float)(t + 1 - clusterStart) <= limit )
+			{
+				clusters[clusterCount].start = clusterStart;
+				clusters[clusterCount].count = t + 1 - clusterStart;
+				clusterCount++;
+				clusterStart = t + 1;
+				misses = 0;
+				cache.Reset();
+			}
+		}
+	}
+	delete []hardStarts;
+
+	//Work out the middle of the mesh, area weighted.
+	Vector3 meshCentre(0,0,0);
+	float meshArea = 0;
+	for( int t = 0 ; t < triangleCount ; t++ )
+	{
+		const Vector3& a = positions[indices[(t*3)+0]];
+		const Vector3& b = positions[indices[(t*3)+1]];
+		const Vector3& c = positions[indices[(t*3)+2]];
+		Vector3 normal;
+		normal.Cross(b - a,c - a);
+		const float area = normal.Length();
+		meshCentre += (a + b + c) * (area / 3.0f);
+		meshArea += area;
+	}
+	if( meshArea > 0 )
+	{
+		meshCentre *= 1.0f / meshArea;
+	}
+
+	//Clusters that face away from the middle are on the outside and should be drawn first.
+	for( int n = 0 ; n < clusterCount ; n++ )
+	{
+		OverdrawCluster& cluster = clusters[n];
+		Vector3 centre(0,0,0);
+		Vector3 normal(0,0,0);
+		float area = 0;
+		for( int t = cluster.start ; t < cluster.start + cluster.count ; t++ )
+		{
+			const Vector3& a = positions[indices[(t*3)+0]];
+			const Vector3& b = positions[indices[(t*3)+1]];
+			const Vector3& c = positions[indices[(t*3)+2]];
+			Vector3 triNormal;
+			triNormal.Cross(b - a,c - a);
+			const float triArea = triNormal.Length();
+			centre += (a + b + c) * (triArea / 3.0f);
+			normal += triNormal;
+			area += triArea;
+		}
+
+		if( area > 0 )
+		{
+			centre *= 1.0f / area;
+		}
+		normal.Norm();
+		//With our clockwise winding the cross product points out of the front of the face.
+		cluster.sortKey = (centre - meshCentre).Dot(normal);
+	}
+
+	std::stable_sort(clusters,clusters + clusterCount,[](const OverdrawCluster& a,const OverdrawCluster& b)
+	{
+		return a.sortKey > b.sortKey;
+	});
+
+	uint16_t* output = new uint16_t[indexCount];
+	uint16_t* dest = output;
+	for( int n = 0 ; n < clusterCount ; n++ )
+	{
+		const int count = clusters[n].count * 3;
+		memcpy(dest,indices + (clusters[n].start * 3),sizeof(uint16_t) * count);
+		dest += count;
+	}
+	assert( dest == output + (triangleCount * 3) );
+	memcpy(indices,output,sizeof(uint16_t) * triangleCount * 3);
+
+	delete []output;
+	delete []clusters;
+}
+
+int MeshOptimiser::OptimiseVertexFetch(uint8_t* vertices,int stride,Vector3* positions,uint16_t* indices,int indexCount,int vertexCount)
+{
+	int* remap = new int[vertexCount];
+	memset(remap,0xff,sizeof(int) * vertexCount);
+
+	int newCount = 0;
+	for( int n = 0 ; n < indexCount ; n++ )
+	{
+		const int v = indices[n];
+		if( remap[v] < 0 )
+		{
+			remap[v] = newCount++;
+		}
+		indices[n] = (uint16_t)remap[v];
+	}
+
+	uint8_t* newVertices = new uint8_t[newCount * stride];
+	Vector3* newPositions = positions != NULL ? new Vector3[newCount] : NULL;
+	for( int v = 0 ; v < vertexCount ; v++ )
+	{
+		if( remap[v] >= 0 )
+		{
+			memcpy(newVertices + (remap[v] * stride),vertices + (v * stride),stride);
+			if( newPositions != NULL )
+			{
+				newPositions[remap[v]] = positions[v];
+			}
+		}
+	}
+
+	memcpy(vertices,newVertices,newCount * stride);
+	if( newPositions != NULL )
+	{
+		for( int v = 0 ; v < newCount ; v++ )
+		{
+			positions[v] = newPositions[v];
+		}
+	}
+
+	delete []newPositions;
+	delete []newVertices;
+	delete []remap;
+
+	return newCount;
+}
+
+int MeshOptimiser::Optimise(uint8_t* vertices,int stride,Vector3* positions,uint16_t* indices,int indexCount,int vertexCount,const int* rangeIndexCounts,int rangeCount,CacheStats* before,CacheStats* after)
+{
+	if( before != NULL )
+	{
+		*before = AnalyseVertexCache(indices,indexCount,vertexCount);
+	}
+
+	if( rangeIndexCounts != NULL && rangeCount > 0 )
+	{
+		uint16_t* range = indices;
+		for( int n = 0 ; n < rangeCount ; n++ )
+		{
+			OptimiseVertexCache(range,rangeIndexCounts[n],vertexCount);
+			OptimiseOverdraw(range,rangeIndexCounts[n],positions,vertexCount);
+			range += rangeIndexCounts[n];
+		}
+	}
+	else
+	{
+		OptimiseVertexCache(indices,indexCount,vertexCount);
+		OptimiseOverdraw(indices,indexCount,positions,vertexCount);
+	}
+	const int newCount = OptimiseVertexFetch(vertices,stride,positions,indices,indexCount,vertexCount);
+
+	if( after != NULL )
+	{
+		*after = AnalyseVertexCache(indices,indexCount,newCount);
+	}
+
+	return newCount;
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,96 @@
+/*
+ * MeshOptimiser.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MESHOPTIMISER_H_
+#define MESHOPTIMISER_H_
+
+#include <stdint.h>
+#include "maths/Vector3.h"
+
+namespace BogDog
+{
+
+/**
+ * Reorders indexed triangle lists so they draw faster.
+ * There are three passes, run them in this order as each one relies on the last.
+ *   1. OptimiseVertexCache, reorders triangles so vertices are reused while they are still in the post transform cache. (Forsyth)
+ *   2. OptimiseOverdraw, splits the triangles into clusters and draws the clusters that face out first so more pixels get rejected by the z test. (Sander, Nehab & Barczak, Tipsify)
+ *   3. OptimiseVertexFetch, reorders the vertices into the order they are first used so the fetches walk through memory.
+ * GPUs like the VideoCore have a very small vertex cache and are fill rate bound, so both show up in the frame time.
+ */
+struct MeshOptimiser
+{
+	/**
+	 * Results of simulating a FIFO post transform cache over an index list.
+	 */
+	struct CacheStats
+	{
+		int transformed;	//!<Number of vertices that missed the cache and had to be run through the vertex shader.
+		float acmr;			//!<Average cache miss ratio, transformed vertices per triangle. 0.5 is the best you can get, 3 is the worst.
+		float atvr;			//!<Average transformed vertex ratio, transformed vertices per unique vertex. 1 is perfect.
+	};
+
+	/**
+	 * The cache size we assume, the small GPUs we run on have a tiny cache.
+	 */
+	static const int DEFAULT_CACHE_SIZE = 16;
+
+	/**
+	 * Simulates a FIFO cache of cacheSize entries running over the indices.
+	 */
+	static CacheStats AnalyseVertexCache(const uint16_t* indices,int indexCount,int vertexCount,int cacheSize = DEFAULT_CACHE_SIZE);
+
+	/**
+	 * Reorders the triangles for the post transform vertex cache. Uses Tom Forsyth's linear speed algorithm.
+	 */
+	static void OptimiseVertexCache(uint16_t* indices,int indexCount,int vertexCount,int cacheSize = DEFAULT_CACHE_SIZE);
+
+	/**
+	 * Reorders clusters of triangles so that ones facing out from the mesh are drawn first, this reduces overdraw.
+	 * Call after OptimiseVertexCache, the clusters are only split where that does not make the cache hit rate worse than threshold times the original.
+	 * @param positions The position of each vertex.
+	 * @param threshold How much worse the ACMR is allowed to get, 1.05 means 5% worse.
+	 */
+	static void OptimiseOverdraw(uint16_t* indices,int indexCount,const Vector3* positions,int vertexCount,float threshold = 1.05f,int cacheSize = DEFAULT_CACHE_SIZE);
+
+	/**
+	 * Reorders the vertices into the order they are first used by the indices and rewrites the indices to match.
+	 * Vertices that are not used are removed.
+	 * @param vertices The vertex data, vertexCount * stride bytes, reordered in place.
+	 * @param positions Optional, reordered with the vertices.
+	 * @return The new vertex count.
+	 */
+	static int OptimiseVertexFetch(uint8_t* vertices,int stride,Vector3* positions,uint16_t* indices,int indexCount,int vertexCount);
+
+	/**
+	 * Runs all three passes.
+	 * @param rangeIndexCounts Optional, the index count of each range of triangles that must stay where it is, for example
+	 * one range per material. The triangles are only reordered within their range.
+	 * @param rangeCount The number of ranges.
+	 * @param before Optional, set to the cache stats of the indices passed in.
+	 * @param after Optional, set to the cache stats of the optimised indices.
+	 * @return The new vertex count.
+	 */
+	static int Optimise(uint8_t* vertices,int stride,Vector3* positions,uint16_t* indices,int indexCount,int vertexCount,const int* rangeIndexCounts = NULL,int rangeCount = 0,CacheStats* before = NULL,CacheStats* after = NULL);
+};
+
+} /* namespace BogDog */
+#endif /* MESHOPTIMISER_H_ */
@@ -0,0 +1,313 @@
+/*
+ * RenderQueue.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include "gfx/RenderQueue.h"
+#include "gl/GLShader.h"
+#include "Profiler.h"
+
+namespace BogDog
+{
+
+static const int DEPTH_SHIFT_OPAQUE = 6;
+static const int DEPTH_SHIFT_BLENDED = 30;
+static const int BLEND_SHIFT = 54;
+static const int LAYER_SHIFT = 56;
+static const uint64_t DEPTH_MASK = (1ull << RenderQueue::DEPTH_BITS) - 1;
+
+/**
+ * Quantises a distance so the order of the results is the order of the distances.
+ * The bits of a positive float sort the same as the float, so this is the top bits of it below the sign.
+ */
+static uint32_t QuantiseDepth(float depth)
+{
+	if( !(depth > 0.0f) )
+	{
+		return 0;
+	}
+
+	uint32_t bits;
+	memcpy(&bits,&depth,sizeof(bits));
+	return (bits >> (31 - RenderQueue::DEPTH_BITS)) & (uint32_t)DEPTH_MASK;
+}
+
+RenderQueue::RenderQueue()
+{
+	currentMaterial.Set(NULL,0,BLENDMODE_OFF);
+	currentShaderId = 0;
+	currentTextureId = 0;
+	currentLayer = 0;
+	drawCalls = 0;
+	stateChanges = 0;
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::SetMaterial(GLShader* shader,GLint texture,BLENDMODE blend)
+{
+	currentMaterial.Set(shader,texture,blend);
+	if( shader != NULL )
+	{
+		currentShaderId = FindShader(shader);
+		currentTextureId = FindTexture(texture);
+	}
+}
+
+void RenderQueue::SetLayer(int layer)
+{
+	assert( layer >= 0 && layer < (1 << LAYER_BITS) );
+	currentLayer = layer;
+}
+
+void RenderQueue::Submit(Mesh* mesh,const Matrix& transform,float red,float green,float blue,float alpha)
+{
+	const float colour[4] = {red,green,blue,alpha};
+	if( mesh->getSubMeshCount() > 0 )
+	{
+		for( int n = 0 ; n < mesh->getSubMeshCount() ; n++ )
+		{
+			const Mesh::SubMesh& subMesh = mesh->getSubMesh(n);
+			Packet* packet = AddPacket(mesh,transform,colour,subMesh.material,FindShader(subMesh.material.shader),FindTexture(subMesh.material.texture));
+			packet->firstTriangle = subMesh.firstTriangle;
+			packet->triangleCount = subMesh.triangleCount;
+		}
+		return;
+	}
+
+	if( currentMaterial.shader == NULL )
+	{
+		printf("RenderQueue::Submit: call SetMaterial first\n");
+		return;
+	}
+
+	Packet* packet = AddPacket(mesh,transform,colour,currentMaterial,currentShaderId,currentTextureId);
+	packet->firstTriangle = 0;
+	packet->triangleCount = mesh->getTriangleCount();
+}
+
+void RenderQueue::Flush(const Matrix& projInvcam)
+{
+	BD_PROFILE_SCOPE("RenderQueue::Flush");
+	drawCalls = 0;
+	stateChanges = 0;
+	const int count = (int)packets.GetSize();
+	if( count == 0 )
+	{
+		return;
+	}
+
+	SortEntry* list = entries.Get(count);
+	for( int n = 0 ; n < count ; n++ )
+	{
+		const Packet& packet = packets[n];
+
+		// The w the camera gives the object's origin, the distance along the view direction.
+		const float depth =
+				packet.transform.m[3][0] * projInvcam.m[0][3] +
+				packet.transform.m[3][1] * projInvcam.m[1][3] +
+				packet.transform.m[3][2] * projInvcam.m[2][3] +
+				projInvcam.m[3][3];
+
+		list[n].key = MakeKey(packet.layer,packet.material.blend,packet.shaderId,packet.textureId,depth);
+		list[n].index = n;
+	}
+
+	{
+		BD_PROFILE_SCOPE("RenderQueue::Sort");
+		RadixSort(list,scratch.Get(count),count);
+	}
+
+	GLShader* activeShader = NULL;
+	Mesh* activeMesh = NULL;
+	uint64_t activeState = ~0ull;
+	for( int n = 0 ; n < count ; n++ )
+	{
+		const Packet& packet = packets[list[n].index];
+		const uint64_t state = StateBits(list[n].key);
+		if( state != activeState )
+		{
+			const Material& material = packet.material;
+			if( material.shader != activeShader )
+			{
+				material.shader->Enable(projInvcam);
+				activeShader = material.shader;
+				activeMesh = NULL;
+			}
+
+			if( material.texture != 0 )
+			{
+				activeShader->setTexture(0,material.texture);
+			}
+
+			material.ApplyBlend();
+			activeState = state;
+			stateChanges++;
+		}
+
+		if( packet.mesh != activeMesh )
+		{
+			packet.mesh->Enable(activeShader);
+			activeMesh = packet.mesh;
+		}
+
+		Matrix transform = packet.transform;
+		activeShader->setTransform(transform);
+		activeShader->setGlobalColour(packet.colour[0],packet.colour[1],packet.colour[2],packet.colour[3]);
+		packet.mesh->Draw(packet.firstTriangle,packet.triangleCount);
+		drawCalls++;
+	}
+
+	packets.Reset();
+
+	// Ids only have so many bits, start the tables again if this frame filled them. The current material keeps an id.
+	if( shaders.GetSize() >= (1u << SHADER_BITS) || textures.GetSize() >= (1u << TEXTURE_BITS) )
+	{
+		shaders.Reset();
+		textures.Reset();
+		if( currentMaterial.shader != NULL )
+		{
+			currentShaderId = FindShader(currentMaterial.shader);
+			currentTextureId = FindTexture(currentMaterial.texture);
+		}
+	}
+}
+
+uint64_t RenderQueue::MakeKey(int layer,BLENDMODE blend,int shaderId,int textureId,float depth)
+{
+	assert( layer >= 0 && layer < (1 << LAYER_BITS) );
+	assert( shaderId >= 0 && shaderId < (1 << SHADER_BITS) );
+	assert( textureId >= 0 && textureId < (1 << TEXTURE_BITS) );
+
+	const uint64_t quantised = QuantiseDepth(depth);
+	uint64_t key = ((uint64_t)layer << LAYER_SHIFT) | ((uint64_t)blend << BLEND_SHIFT);
+	if( blend == BLENDMODE_OFF )
+	{// State first so there are fewer changes, then front to back.
+		key |= (uint64_t)shaderId << (DEPTH_SHIFT_OPAQUE + DEPTH_BITS + TEXTURE_BITS);
+		key |= (uint64_t)textureId << (DEPTH_SHIFT_OPAQUE + DEPTH_BITS);
+		key |= quantised << DEPTH_SHIFT_OPAQUE;
+	}
+	else
+	{// Back to front has to come first for the blending to be right.
+		key |= (DEPTH_MASK - quantised) << DEPTH_SHIFT_BLENDED;
+		key |= (uint64_t)shaderId << (DEPTH_SHIFT_OPAQUE + TEXTURE_BITS);
+		key |= (uint64_t)textureId << DEPTH_SHIFT_OPAQUE;
+	}
+	return key;
+}
+
+void RenderQueue::RadixSort(SortEntry* list,SortEntry* temp,int count)
+{
+	// All the histograms in one read of the keys.
+	int histograms[8][256];
+	memset(histograms,0,sizeof(histograms));
+	for( int n = 0 ; n < count ; n++ )
+	{
+		const uint64_t key = list[n].key;
+		for( int pass = 0 ; pass < 8 ; pass++ )
+		{
+			histograms[pass][(key >> (pass * 8)) & 0xff]++;
+		}
+	}
+
+	SortEntry* from = list;
+	SortEntry* to = temp;
+	for( int pass = 0 ; pass < 8 ; pass++ )
+	{
+		int* histogram = histograms[pass];
+		const int shift = pass * 8;
+		if( histogram[(from[0].key >> shift) & 0xff] == count )
+		{// Every key has the same byte here, nothing would move.
+			continue;
+		}
+
+		int offset = 0;
+		for( int n = 0 ; n < 256 ; n++ )
+		{
+			const int bucketSize = histogram[n];
+			histogram[n] = offset;
+			offset += bucketSize;
+		}
+
+		for( int n = 0 ; n < count ; n++ )
+		{
+			to[histogram[(from[n].key >> shift) & 0xff]++] = from[n];
+		}
+
+		SortEntry* swap = from;
+		from = to;
+		to = swap;
+	}
+
+	if( from != list )
+	{
+		memcpy(list,from,sizeof(SortEntry) * count);
+	}
+}
+
+RenderQueue::Packet* RenderQueue::AddPacket(Mesh* mesh,const Matrix& transform,const float colour[4],const Material& material,int shaderId,int textureId)
+{
+	Packet* packet = packets.PushBack();
+	packet->mesh = mesh;
+	packet->transform = transform;
+	memcpy(packet->colour,colour,sizeof(packet->colour));
+	packet->material = material;
+	packet->shaderId = shaderId;
+	packet->textureId = textureId;
+	packet->layer = currentLayer;
+	return packet;
+}
+
+int RenderQueue::FindShader(GLShader* shader)
+{
+	for( int n = 0 ; n < (int)shaders.GetSize() ; n++ )
+	{
+		if( shaders[n] == shader )
+		{
+			return n;
+		}
+	}
+	assert( shaders.GetSize() < (1u << SHADER_BITS) );
+	return (int)shaders.PushBack(shader);
+}
+
+int RenderQueue::FindTexture(GLint texture)
+{
+	for( int n = 0 ; n < (int)textures.GetSize() ; n++ )
+	{
+		if( textures[n] == texture )
+		{
+			return n;
+		}
+	}
+	assert( textures.GetSize() < (1u << TEXTURE_BITS) );
+	return (int)textures.PushBack(texture);
+}
+
+uint64_t RenderQueue::StateBits(uint64_t key)
+{
+	const BLENDMODE blend = (BLENDMODE)((key >> BLEND_SHIFT) & 3);
+	return key & ~(DEPTH_MASK << (blend == BLENDMODE_OFF ? DEPTH_SHIFT_OPAQUE : DEPTH_SHIFT_BLENDED));
+}
+
+} /* namespace BogDog */
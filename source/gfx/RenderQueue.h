@@ -0,0 +1,157 @@
+/*
+ * RenderQueue.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "GLHeaders.h"
+#include "DynamicBuffer.h"
+#include "maths/Matrix.h"
+#include "Mesh.h"
+#include "Material.h"
+
+namespace BogDog
+{
+
+struct GLShader;
+
+/**
+ * Collects draws for a frame, sorts them by a 64 bit key and draws them in that order.
+ * The key is made from the layer, blend mode, shader, texture and the quantised distance from the camera.
+ * Opaque draws are sorted by state then front to back so early Z rejects more, blended ones are sorted back to front
+ * after the opaque ones so they blend correctly. The draw loop only changes GL state when the state part of the key changes.
+ * Unlike the Batcher nothing is merged, each submission is a draw call, so it works for meshes of any size.
+ *
+ * Key bits, high to low.
+ * Opaque:  layer 8, blend 2, shader 10, texture 14, depth 24, spare 6.
+ * Blended: layer 8, blend 2, inverted depth 24, shader 10, texture 14, spare 6.
+ */
+struct RenderQueue
+{
+	static const int LAYER_BITS = 8;
+	static const int SHADER_BITS = 10;
+	static const int TEXTURE_BITS = 14;
+	static const int DEPTH_BITS = 24;
+
+	RenderQueue();
+	~RenderQueue();
+
+	/**
+	 * Sets the shader, texture and blend mode for the submissions that follow.
+	 * @param texture The GL texture for unit 0, 0 for none.
+	 */
+	void SetMaterial(GLShader* shader,GLint texture = 0,BLENDMODE blend = BLENDMODE_OFF);
+
+	/**
+	 * Sets the layer for the submissions that follow. Lower layers are all drawn before higher ones, for example world then HUD.
+	 * @param layer 0 to 255.
+	 */
+	void SetLayer(int layer);
+
+	/**
+	 * Adds a mesh to be drawn with the current material, or with it's own materials if it has sub meshes.
+	 * The colour is set as the shader's global colour.
+	 */
+	void Submit(Mesh* mesh,const Matrix& transform,float red = 1.0f,float green = 1.0f,float blue = 1.0f,float alpha = 1.0f);
+
+	/**
+	 * Builds the keys using the camera, sorts and draws everything submitted since the last Flush then clears the list.
+	 * Leaves the blend state as the last draw set it.
+	 */
+	void Flush(const Matrix& projInvcam);
+
+	/**
+	 * @return The number of GL draw calls the last Flush made.
+	 */
+	int getDrawCalls()
+	{
+		return drawCalls;
+	}
+
+	/**
+	 * @return The number of times the last Flush changed material, shader, texture or blend mode.
+	 */
+	int getStateChanges()
+	{
+		return stateChanges;
+	}
+
+	/**
+	 * Makes a sort key, exposed so it can be checked or used by code that sorts it's own draws.
+	 * @param depth The distance in front of the camera, negative is treated as 0.
+	 */
+	static uint64_t MakeKey(int layer,BLENDMODE blend,int shaderId,int textureId,float depth);
+
+	struct SortEntry
+	{
+		uint64_t key;
+		int index;
+	};
+
+	/**
+	 * Sorts the entries by key, lowest first, with a least significant byte first radix sort.
+	 * Equal keys keep their order. Passes where every key has the same byte are skipped.
+	 * @param temp Must have room for count entries.
+	 */
+	static void RadixSort(SortEntry* list,SortEntry* temp,int count);
+
+private:
+	struct Packet
+	{
+		Mesh* mesh;
+		Matrix transform;
+		float colour[4];
+		Material material;
+		int shaderId,textureId;	//!<Looked up when submitted so Flush does not search the tables for every packet.
+		int layer;
+		int firstTriangle;
+		int triangleCount;
+	};
+
+	DynamicBuffer<Packet> packets;
+	DynamicBuffer<SortEntry> entries;
+	DynamicBuffer<SortEntry> scratch;
+
+	// Shaders and textures seen so far, their index is their id in the key. Kept between frames so the ids don't change.
+	DynamicBuffer<GLShader*,16,16> shaders;
+	DynamicBuffer<GLint,64,64> textures;
+
+	Material currentMaterial;
+	int currentShaderId,currentTextureId;
+	int currentLayer;
+
+	int drawCalls;
+	int stateChanges;
+
+	Packet* AddPacket(Mesh* mesh,const Matrix& transform,const float colour[4],const Material& material,int shaderId,int textureId);
+	int FindShader(GLShader* shader);
+	int FindTexture(GLint texture);
+
+	/**
+	 * @return The key with the depth bits cleared so draws with the same state have the same value.
+	 */
+	static uint64_t StateBits(uint64_t key);
+};
+
+} /* namespace BogDog */
+#endif /* RENDERQUEUE_H_ */
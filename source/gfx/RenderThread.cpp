@@ -0,0 +1,241 @@
+/*
+ * RenderThread.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include "gfx/RenderThread.h"
+#include "gl/OpenGLES20.h"
+#include "Profiler.h"
+
+namespace BogDog
+{
+
+RenderThread::RenderThread(OpenGLES_2_0& pGL,int framesInFlight) :
+	gl(pGL),
+	frameCount(framesInFlight < 2 ? 2 : (framesInFlight > MAX_FRAMES_IN_FLIGHT ? MAX_FRAMES_IN_FLIGHT : framesInFlight))
+{
+	for( int n = 0 ; n < MAX_FRAMES_IN_FLIGHT ; n++ )
+	{
+		states[n] = FRAME_FREE;
+		frames[n].clearColour = 0;
+		frames[n].frameNumber = 0;
+	}
+	writeIndex = 0;
+	readIndex = 0;
+	nextFrameNumber = 0;
+	callback = NULL;
+	callbackUser = NULL;
+	running = false;
+	quit = false;
+	startResult = 0;
+	framesRendered = 0;
+	simulationWaitMicroseconds = 0;
+	renderWaitMicroseconds = 0;
+
+	pthread_mutex_init(&mutex,NULL);
+	pthread_cond_init(&changed,NULL);
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+	pthread_cond_destroy(&changed);
+	pthread_mutex_destroy(&mutex);
+}
+
+void RenderThread::SetFrameCallback(FrameCallback pCallback,void* user)
+{
+	assert( !running );
+	callback = pCallback;
+	callbackUser = user;
+}
+
+bool RenderThread::Start()
+{
+	if( running )
+	{
+		return true;
+	}
+
+	for( int n = 0 ; n < frameCount ; n++ )
+	{
+		states[n] = FRAME_FREE;
+	}
+	writeIndex = 0;
+	readIndex = 0;
+	quit = false;
+	startResult = 0;
+	framesRendered = 0;
+	simulationWaitMicroseconds = 0;
+	renderWaitMicroseconds = 0;
+
+	gl.ReleaseCurrent();
+	if( pthread_create(&thread,NULL,ThreadMain,this) != 0 )
+	{
+		printf("RenderThread::Start: failed to create the thread\n");
+		gl.MakeCurrent();
+		return false;
+	}
+
+	pthread_mutex_lock(&mutex);
+	while( startResult == 0 )
+	{
+		pthread_cond_wait(&changed,&mutex);
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if( startResult < 0 )
+	{
+		pthread_join(thread,NULL);
+		gl.MakeCurrent();
+		return false;
+	}
+
+	running = true;
+	return true;
+}
+
+void RenderThread::Stop()
+{
+	if( !running )
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&mutex);
+	quit = true;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&mutex);
+
+	pthread_join(thread,NULL);
+	running = false;
+	gl.MakeCurrent();
+}
+
+RenderFrame* RenderThread::BeginFrame()
+{
+	assert( running );
+	pthread_mutex_lock(&mutex);
+	assert( states[writeIndex] != FRAME_RECORDING );
+	if( states[writeIndex] != FRAME_FREE )
+	{
+		const uint64_t start = GetMicroseconds();
+		while( states[writeIndex] != FRAME_FREE )
+		{
+			pthread_cond_wait(&changed,&mutex);
+		}
+		simulationWaitMicroseconds += GetMicroseconds() - start;
+	}
+	states[writeIndex] = FRAME_RECORDING;
+	RenderFrame* frame = &frames[writeIndex];
+	pthread_mutex_unlock(&mutex);
+
+	frame->commands.Reset();
+	frame->frameNumber = nextFrameNumber++;
+	return frame;
+}
+
+void RenderThread::SubmitFrame(RenderFrame* frame)
+{
+	assert( frame == &frames[writeIndex] );
+	pthread_mutex_lock(&mutex);
+	states[writeIndex] = FRAME_READY;
+	writeIndex = (writeIndex + 1) % frameCount;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&mutex);
+}
+
+void* RenderThread::ThreadMain(void* renderThread)
+{
+	((RenderThread*)renderThread)->RenderLoop();
+	return NULL;
+}
+
+void RenderThread::RenderLoop()
+{
+	const bool current = gl.MakeCurrent();
+
+	pthread_mutex_lock(&mutex);
+	startResult = current ? 1 : -1;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&mutex);
+	if( !current )
+	{
+		return;
+	}
+
+	// Made current on a new thread, we can not be sure what the GL state is.
+	OpenGLES_2_0::GetStateCache().Invalidate();
+	BD_PROFILE_THREAD_NAME("Render");
+
+	for(;;)
+	{
+		pthread_mutex_lock(&mutex);
+		if( states[readIndex] != FRAME_READY && !quit )
+		{
+			const uint64_t start = GetMicroseconds();
+			while( states[readIndex] != FRAME_READY && !quit )
+			{
+				pthread_cond_wait(&changed,&mutex);
+			}
+			renderWaitMicroseconds += GetMicroseconds() - start;
+		}
+
+		if( states[readIndex] != FRAME_READY )
+		{// Told to quit and everything submitted has been drawn.
+			pthread_mutex_unlock(&mutex);
+			break;
+		}
+		states[readIndex] = FRAME_RENDERING;
+		RenderFrame& frame = frames[readIndex];
+		pthread_mutex_unlock(&mutex);
+
+		{
+			BD_PROFILE_SCOPE("RenderThread::Frame");
+			gl.Clear(frame.clearColour);
+			frame.commands.Execute(frame.projInvcam);
+			if( callback != NULL )
+			{
+				callback(frame,callbackUser);
+			}
+			gl.Update();
+		}
+
+		pthread_mutex_lock(&mutex);
+		states[readIndex] = FRAME_FREE;
+		readIndex = (readIndex + 1) % frameCount;
+		framesRendered++;
+		pthread_cond_broadcast(&changed);
+		pthread_mutex_unlock(&mutex);
+	}
+
+	gl.ReleaseCurrent();
+}
+
+uint64_t RenderThread::GetMicroseconds()
+{
+	struct timeval now;
+	gettimeofday(&now,NULL);
+	return (now.tv_sec * (uint64_t)1000000) + now.tv_usec;
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,170 @@
+/*
+ * RenderThread.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDERTHREAD_H_
+#define RENDERTHREAD_H_
+
+#include <stdint.h>
+#include <pthread.h>
+#include "maths/Matrix.h"
+#include "CommandBuffer.h"
+
+namespace BogDog
+{
+
+struct OpenGLES_2_0;
+
+/**
+ * Everything the render thread needs to draw a frame, filled in by the simulation thread.
+ */
+struct RenderFrame
+{
+	CommandBuffer commands;
+	Matrix projInvcam;
+	uint32_t clearColour;
+	int frameNumber;		//!<Set by BeginFrame, counts up from 0.
+};
+
+/**
+ * Runs the GL work on it's own thread so the simulation of the next frame overlaps the submission and swap of this one.
+ * After Start the render thread owns the context made by OpenGLES_2_0::Create, the simulation thread must not call GL.
+ * The simulation thread gets a frame with BeginFrame, records it's draws into the frame's CommandBuffer and hands it
+ * over with SubmitFrame. The render thread clears, executes the commands and calls OpenGLES_2_0::Update for each frame in turn.
+ * With two frames in flight the simulation is at most one frame ahead, three lets it run two ahead to smooth out spikes.
+ * Create GL resources before Start or after Stop, they need the context.
+ *
+ * A typical loop.
+ *	renderThread.Start();
+ *	while( OpenGLES_2_0::ApplicationRunning() )
+ *	{
+ *		Simulate();
+ *		RenderFrame* frame = renderThread.BeginFrame();
+ *		frame->projInvcam = view.GetProjectionCameraMatrix();
+ *		RecordDraws(frame->commands);
+ *		renderThread.SubmitFrame(frame);
+ *	}
+ *	renderThread.Stop();
+ */
+struct RenderThread
+{
+	/**
+	 * Called on the render thread after the frame's commands, before the swap. For work that needs GL, for example Batcher::EndFrame.
+	 */
+	typedef void (*FrameCallback)(RenderFrame& frame,void* user);
+
+	static const int MAX_FRAMES_IN_FLIGHT = 3;
+
+	/**
+	 * @param framesInFlight 2 for double buffered frames or 3 for triple.
+	 */
+	RenderThread(OpenGLES_2_0& gl,int framesInFlight = 2);
+	~RenderThread();
+
+	void SetFrameCallback(FrameCallback callback,void* user);
+
+	/**
+	 * Moves the GL context to a new render thread. Call from the thread that called OpenGLES_2_0::Create.
+	 * @return false if the thread could not be started or take the context, the context stays with the calling thread.
+	 */
+	bool Start();
+
+	/**
+	 * Draws the frames already submitted, stops the thread and gives the context back to the calling thread.
+	 */
+	void Stop();
+
+	/**
+	 * @return A frame to fill in with it's command buffer empty, waits until the render thread has finished with one.
+	 */
+	RenderFrame* BeginFrame();
+
+	/**
+	 * Hands the frame from BeginFrame to the render thread.
+	 */
+	void SubmitFrame(RenderFrame* frame);
+
+	bool IsRunning()
+	{
+		return running;
+	}
+
+	/**
+	 * @return The number of frames the render thread has drawn since Start.
+	 */
+	int getFramesRendered()
+	{
+		return framesRendered;
+	}
+
+	/**
+	 * @return The time BeginFrame has spent waiting for the render thread since Start, high means the render thread is the bottleneck.
+	 */
+	float getSimulationWaitSeconds()
+	{
+		return simulationWaitMicroseconds / 1000000.0f;
+	}
+
+	/**
+	 * @return The time the render thread has spent waiting for frames since Start, high means the simulation is the bottleneck.
+	 */
+	float getRenderWaitSeconds()
+	{
+		return renderWaitMicroseconds / 1000000.0f;
+	}
+
+private:
+	enum FrameState
+	{
+		FRAME_FREE,
+		FRAME_RECORDING,
+		FRAME_READY,
+		FRAME_RENDERING
+	};
+
+	OpenGLES_2_0& gl;
+	RenderFrame frames[MAX_FRAMES_IN_FLIGHT];
+	FrameState states[MAX_FRAMES_IN_FLIGHT];
+	const int frameCount;
+	int writeIndex;			//!<Next frame BeginFrame gives out.
+	int readIndex;			//!<Next frame the render thread draws.
+	int nextFrameNumber;
+
+	FrameCallback callback;
+	void* callbackUser;
+
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;		//!<Signalled when any frame changes state or the thread starts or is told to stop.
+	bool running;
+	bool quit;
+	int startResult;			//!<0 while starting, 1 if the thread took the context, -1 if it failed.
+
+	volatile int framesRendered;
+	volatile uint64_t simulationWaitMicroseconds;
+	volatile uint64_t renderWaitMicroseconds;
+
+	static void* ThreadMain(void* renderThread);
+	void RenderLoop();
+	static uint64_t GetMicroseconds();
+};
+
+} /* namespace BogDog */
+#endif /* RENDERTHREAD_H_ */
@@ -20,14 +20,18 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "gfx/ShapeBuilder.h"
 #include "gfx/Mesh.h"
+#include "gl/OpenGLES20.h"
+#include "maths/Box.h"
 
 namespace BogDog
 {
 
 ShapeBuilder::ShapeBuilder()
 {
+	currentMaterial = 0;
 }
 
 ShapeBuilder::~ShapeBuilder()
@@ -44,70 +48,222 @@ ShapeBuilder::~ShapeBuilder()
  */
 int ShapeBuilder::addFace(int v0,int v1,int v2,int colour)
 {
-	faces.PushBack()->Set(v0,v1,v2,colour,-1,-1,-1);
+	Face* f = faces.PushBack();
+	f->Set(v0,v1,v2,colour,-1,-1,-1);
+	f->material = currentMaterial;
 	return faces.GetSize()-1;
 }
 
 void ShapeBuilder::addQuad(int v0,int v1,int v2,int v3,int colour)
 {
-	faces.PushBack()->Set(v0,v1,v3,colour,-1,-1,-1);
-	faces.PushBack()->Set(v1,v2,v3,colour,-1,-1,-1);
+	addFace(v0,v1,v3,colour);
+	addFace(v1,v2,v3,colour);
 }
 
 void ShapeBuilder::addQuad(int p0,int p1,int p2,int p3,int colour,int uv0,int uv1,int uv2,int uv3)
 {
-	faces.PushBack()->Set(p0,p1,p3,colour,uv0,uv1,uv3);
-	faces.PushBack()->Set(p1,p2,p3,colour,uv1,uv2,uv3);
+	Face* f = faces.PushBack();
+	f->Set(p0,p1,p3,colour,uv0,uv1,uv3);
+	f->material = currentMaterial;
+
+	f = faces.PushBack();
+	f->Set(p1,p2,p3,colour,uv1,uv2,uv3);
+	f->material = currentMaterial;
 }
 
-Mesh* ShapeBuilder::BuildMesh(bool wantColour,bool wantTex0)
+Mesh* ShapeBuilder::BuildMesh(bool wantColour,bool wantTex0,bool optimise,bool quantise)
 {
-	float* xyz = new float[faces.GetSize() * 3 * 3];
-	int* colours = wantColour?new int[faces.GetSize() * 3]:NULL;
-	float* uv0 = wantTex0?new float[faces.GetSize() * 3 * 2]:NULL;
-
-	//Build vertex data.
-	int n = 0;
-	for(size_t fn = 0 ; fn < faces.GetSize() ; fn++ )
+	if( quantise )
 	{
-		const Face& f = faces[fn];
-		for( int i = 0 ; i < 3 ; i++ , n++ )
+		if( wantTex0 )
 		{
-			const Vector3& v = vertices[f.v[i]];
-			xyz[(n*3) + 0] = v.x;
-			xyz[(n*3) + 1] = v.y;
-			xyz[(n*3) + 2] = v.z;
-
-			if( colours != NULL )
+			if( UV0InUnitRange() )
 			{
-				colours[n] = f.colour;
+				return BuildQuantisedMesh<UV2u16>(wantColour,optimise);
 			}
 
-			if( uv0 != NULL )
+			if( OpenGLES_2_0::HasExtension("GL_OES_vertex_half_float") )
 			{
-				if (f.uv0[i] > -1 )
-				{
-					int index = f.uv0[i];
-					const Vector2& uv = this->uv0[index];
-					index = (n*2);
-					uv0[index + 0] = uv.x;
-					uv0[index + 1] = uv.y;
-				}
-				else
-				{
-					uv0[(n*2) + 0] = v.x;
-					uv0[(n*2) + 1] = v.y;
-				}
+				return BuildQuantisedMesh<UV2h>(wantColour,optimise);
 			}
+
+			return BuildQuantisedMesh<UV2f>(wantColour,optimise);
+		}
+
+		if( wantColour )
+		{
+			return BuildMesh< VertexFormat<Pos3s16,ColourU8x4> >(optimise);
+		}
+
+		return BuildMesh< VertexFormat<Pos3s16> >(optimise);
+	}
+
+	if( wantColour && wantTex0 )
+	{
+		return BuildMesh< VertexFormat<Pos3f,ColourU8x4,UV2f> >(optimise);
+	}
+
+	if( wantColour )
+	{
+		return BuildMesh< VertexFormat<Pos3f,ColourU8x4> >(optimise);
+	}
+
+	if( wantTex0 )
+	{
+		return BuildMesh< VertexFormat<Pos3f,UV2f> >(optimise);
+	}
+
+	return BuildMesh< VertexFormat<Pos3f> >(optimise);
+}
+
+int ShapeBuilder::SortFacesByMaterial(int* faceOrder,int* rangeIndexCounts)
+{
+	const int faceCount = (int)faces.GetSize();
+	const int materialCount = (int)materials.GetSize();
+	if( materialCount == 0 )
+	{
+		for( int n = 0 ; n < faceCount ; n++ )
+		{
+			faceOrder[n] = n;
 		}
+		return 0;
 	}
 
-	Mesh* newMesh = new Mesh(xyz,uv0,colours,(int)faces.GetSize()*3);
-	delete xyz;
-	delete uv0;
-	delete colours;
+	//A counting sort, materials are in the order they were added. Bad ids go in the last range.
+	int* counts = new int[materialCount + 1];
+	memset(counts,0,sizeof(int) * (materialCount + 1));
+	for( int n = 0 ; n < faceCount ; n++ )
+	{
+		const int material = faces[n].material;
+		if( material < 0 || material >= materialCount )
+		{
+			printf("ShapeBuilder::BuildMesh: face %d has material %d, there are only %d\n",n,material,materialCount);
+			counts[materialCount]++;
+		}
+		else
+		{
+			counts[material]++;
+		}
+	}
+
+	int rangeCount = 0;
+	int start = 0;
+	for( int m = 0 ; m <= materialCount ; m++ )
+	{
+		const int count = counts[m];
+		counts[m] = start;
+		start += count;
+		if( count > 0 )
+		{
+			rangeIndexCounts[rangeCount++] = count * 3;
+		}
+	}
+
+	for( int n = 0 ; n < faceCount ; n++ )
+	{
+		const int material = faces[n].material;
+		const int bucket = (material < 0 || material >= materialCount) ? materialCount : material;
+		faceOrder[counts[bucket]++] = n;
+	}
+
+	delete []counts;
+	return rangeCount;
+}
 
-	return newMesh;
+void ShapeBuilder::SetSubMeshes(Mesh* mesh,const int* faceOrder,const uint16_t* indices,const int* rangeIndexCounts,int rangeCount)
+{
+	if( rangeCount == 0 )
+	{
+		return;
+	}
+
+	Mesh::SubMesh* subMeshes = new Mesh::SubMesh[rangeCount];
+	int firstIndex = 0;
+	for( int n = 0 ; n < rangeCount ; n++ )
+	{
+		Mesh::SubMesh& subMesh = subMeshes[n];
+		subMesh.firstTriangle = firstIndex / 3;
+		subMesh.triangleCount = rangeIndexCounts[n] / 3;
+
+		int lowest = 0xffff,highest = 0;
+		for( int i = firstIndex ; i < firstIndex + rangeIndexCounts[n] ; i++ )
+		{
+			lowest = indices[i] < lowest ? indices[i] : lowest;
+			highest = indices[i] > highest ? indices[i] : highest;
+		}
+		subMesh.firstVertex = lowest;
+		subMesh.vertexCount = highest - lowest + 1;
+
+		//The optimiser keeps triangles in their range so the first face of the range is still the right material.
+		const int material = faces[faceOrder[firstIndex / 3]].material;
+		if( material >= 0 && material < (int)materials.GetSize() )
+		{
+			subMesh.material = materials[material];
+		}
+		else
+		{
+			subMesh.material = materials[0];
+		}
+
+		firstIndex += rangeIndexCounts[n];
+	}
+
+	mesh->setSubMeshes(subMeshes,rangeCount);
+	delete []subMeshes;
+}
+
+void ShapeBuilder::GetFaceVertex(const Face& f,int i,VertexSource& source)
+{
+	const Vector3& v = vertices[f.v[i]];
+	source.xyz = v;
+	source.colour = f.colour;
+
+	if (f.uv0[i] > -1 )
+	{
+		source.uv0 = uv0[f.uv0[i]];
+	}
+	else
+	{
+		source.uv0.Set(v.x,v.y);
+	}
+}
+
+void ShapeBuilder::GetQuantisation(Matrix& dequantise,Vector3& centre,Vector3& scale)
+{
+	Bounds bounds;
+	bounds.Make(vertices.Get(),(int)vertices.GetSize());
+
+	Vector3 halfSize;
+	bounds.GetCenter(&centre);
+	bounds.GetSize(&halfSize);
+	halfSize *= 0.5f;
+
+	//A flat shape has no size on one axis, stop that being a divide by zero.
+	if( halfSize.x <= 0.0f ) halfSize.x = 1.0f;
+	if( halfSize.y <= 0.0f ) halfSize.y = 1.0f;
+	if( halfSize.z <= 0.0f ) halfSize.z = 1.0f;
+
+	scale.Set(1.0f / halfSize.x,1.0f / halfSize.y,1.0f / halfSize.z);
+
+	dequantise.SetScale(halfSize.x,halfSize.y,halfSize.z);
+	dequantise.SetAxis(Matrix::AXIS_TRANS,centre);
+}
+
+bool ShapeBuilder::UV0InUnitRange()
+{
+	VertexSource source;
+	for(size_t fn = 0 ; fn < faces.GetSize() ; fn++ )
+	{
+		for( int i = 0 ; i < 3 ; i++ )
+		{
+			GetFaceVertex(faces[fn],i,source);
+			if( source.uv0.x < 0.0f || source.uv0.x > 1.0f || source.uv0.y < 0.0f || source.uv0.y > 1.0f )
+			{
+				return false;
+			}
+		}
+	}
+	return true;
 }
 
 ShapeBuilder* ShapeBuilder::MakeBox(float x,float y,float z)
@@ -23,9 +23,15 @@
 #define SHAPEBUILDER_H_
 
 #include <vector>
+#include <stdio.h>
 #include "maths/Vector2.h"
 #include "maths/Vector3.h"
+#include "maths/Matrix.h"
 #include "Mesh.h"
+#include "Material.h"
+#include "gl/VertexFormat.h"
+#include "VertexWelder.h"
+#include "MeshOptimiser.h"
 #include "DynamicBuffer.h"
 
 namespace BogDog
@@ -38,6 +44,7 @@ struct ShapeBuilder
 		int v[3];
 		int colour;//As per GLES ABGR
 		int uv0[3];
+		int material;//Index into materials.
 
 		void Set(int v0,int v1,int v2,int pColour,int uv00,int uv01,int uv02)
 		{
@@ -54,10 +61,30 @@ struct ShapeBuilder
 	DynamicBuffer<Face> faces;
 	DynamicBuffer<Vector3> vertices;
 	DynamicBuffer<Vector2> uv0;
+	DynamicBuffer<Material,16,16> materials;
 
 	ShapeBuilder();
 	virtual ~ShapeBuilder();
 
+	/**
+	 * Adds a material, the mesh gets a sub mesh for each material that faces use, see Mesh::DrawSubMeshes.
+	 * If no materials are added the mesh has no sub meshes.
+	 * @return The material id to pass to setMaterial.
+	 */
+	int addMaterial(GLShader* shader,GLint texture = 0,BLENDMODE blend = BLENDMODE_OFF)
+	{
+		materials.PushBack()->Set(shader,texture,blend);
+		return materials.GetSize()-1;
+	}
+
+	/**
+	 * Sets the material for the faces added after this call, they start with material 0.
+	 */
+	void setMaterial(int material)
+	{
+		currentMaterial = material;
+	}
+
 	int addVertex(float x,float y,float z)
 	{
 		vertices.PushBack()->Set(x,y,z);
@@ -84,10 +111,135 @@ struct ShapeBuilder
 
 	void addQuad(int p0,int p1,int p2,int p3,int colour,int uv0,int uv1,int uv2,int uv3);
 
-	Mesh* BuildMesh(bool wantColour,bool wantTex0);
+	/**
+	 * Builds a mesh with the standard vertex formats.
+	 * @param wantColour If true the face colours are put into the vertices.
+	 * @param wantTex0 If true the uv's are put into the vertices, faces without uv's use the x and y of the position.
+	 * @param optimise If true the triangles and vertices are reordered by MeshOptimiser.
+	 * @param quantise If true positions are stored as 16 bit normalised shorts scaled to the bounds of the shape.
+	 * uv's are stored as 16 bit normalised when they are all in the range 0 to 1, else as half floats if the driver has
+	 * GL_OES_vertex_half_float, else as floats. Use Mesh::Enable(shader) to draw a quantised mesh.
+	 */
+	Mesh* BuildMesh(bool wantColour,bool wantTex0,bool optimise = true,bool quantise = false);
+
+	/**
+	 * Builds an indexed mesh with the vertices in any vertex format, for example BuildMesh< VertexFormat<Pos3f,ColourU8x4,UV2f> >().
+	 * Face corners that come out as the same vertex are welded into one, so a box is 24 vertices and not 36.
+	 * @param optimise If true the triangles and vertices are reordered for the vertex cache, overdraw and vertex fetch.
+	 * @return The new mesh, NULL if there are too many vertices for 16 bit indices.
+	 */
+	template <class FORMAT> Mesh* BuildMesh(bool optimise = true)
+	{
+		const int cornerCount = (int)faces.GetSize() * 3;
+		VertexWelder welder(FORMAT::STRIDE,cornerCount);
+		uint16_t* indices = new uint16_t[cornerCount];
+		Vector3* positions = new Vector3[cornerCount];
+
+		//Faces are grouped by material so each material is one range of triangles.
+		int* faceOrder = new int[faces.GetSize()];
+		int* rangeIndexCounts = new int[materials.GetSize() + 1];
+		const int rangeCount = SortFacesByMaterial(faceOrder,rangeIndexCounts);
+
+		//Quantised positions are scaled so the bounds of the shape fill the -1 to 1 range.
+		Matrix dequantise;
+		Vector3 quantiseCentre,quantiseScale;
+		if( FORMAT::QUANTISED_POSITION )
+		{
+			GetQuantisation(dequantise,quantiseCentre,quantiseScale);
+		}
+
+		uint8_t vertex[FORMAT::STRIDE];
+		VertexSource source;
+		int n = 0;
+		for(size_t fn = 0 ; fn < faces.GetSize() ; fn++ )
+		{
+			for( int i = 0 ; i < 3 ; i++ , n++ )
+			{
+				GetFaceVertex(faces[faceOrder[fn]],i,source);
+				const Vector3 position = source.xyz;
+				if( FORMAT::QUANTISED_POSITION )
+				{
+					source.xyz = (position - quantiseCentre) * quantiseScale;
+				}
+				FORMAT::Write(vertex,source);
+				const int index = welder.Add(vertex);
+				if( index > 0xffff )
+				{
+					printf("ShapeBuilder::BuildMesh: more than 65536 vertices, can't index with 16 bits\n");
+					delete []positions;
+					delete []indices;
+					delete []faceOrder;
+					delete []rangeIndexCounts;
+					return NULL;
+				}
+				indices[n] = (uint16_t)index;
+				positions[index] = position;
+			}
+		}
+
+		int vertexCount = welder.getCount();
+		if( optimise )
+		{
+			vertexCount = MeshOptimiser::Optimise(welder.getVertices(),FORMAT::STRIDE,positions,indices,cornerCount,vertexCount,rangeIndexCounts,rangeCount);
+		}
+
+		Mesh* newMesh = Mesh::Create<FORMAT>(welder.getVertices(),vertexCount,indices,cornerCount);
+		if( FORMAT::QUANTISED_POSITION )
+		{
+			newMesh->setPositionDequantise(dequantise);
+		}
+		SetSubMeshes(newMesh,faceOrder,indices,rangeIndexCounts,rangeCount);
+
+		delete []positions;
+		delete []indices;
+		delete []faceOrder;
+		delete []rangeIndexCounts;
+		return newMesh;
+	}
 
 	static ShapeBuilder* MakeBox(float x,float y,float z);
 
+private:
+	int currentMaterial;
+
+	/**
+	 * Fills out faceOrder with the face indices sorted by material, faces keep their order within a material.
+	 * @param rangeIndexCounts Set to the index count of each material that is used, in the sorted order.
+	 * @return The number of ranges, 0 if there are no materials.
+	 */
+	int SortFacesByMaterial(int* faceOrder,int* rangeIndexCounts);
+
+	/**
+	 * Gives the mesh a sub mesh for each range of triangles.
+	 */
+	void SetSubMeshes(Mesh* mesh,const int* faceOrder,const uint16_t* indices,const int* rangeIndexCounts,int rangeCount);
+
+	/**
+	 * Fills out source with the data for corner i of the face.
+	 */
+	void GetFaceVertex(const Face& f,int i,VertexSource& source);
+
+	/**
+	 * Works out the scale and offset that fit the bounds of the vertices into -1 to 1, and the matrix that undoes it.
+	 */
+	void GetQuantisation(Matrix& dequantise,Vector3& centre,Vector3& scale);
+
+	/**
+	 * @return true if all the uv's the faces use are in the range 0 to 1.
+	 */
+	bool UV0InUnitRange();
+
+	/**
+	 * Builds a mesh with quantised positions and uv's stored as UV.
+	 */
+	template <class UV> Mesh* BuildQuantisedMesh(bool wantColour,bool optimise)
+	{
+		if( wantColour )
+		{
+			return BuildMesh< VertexFormat<Pos3s16,ColourU8x4,UV> >(optimise);
+		}
+		return BuildMesh< VertexFormat<Pos3s16,UV> >(optimise);
+	}
 };
 
 } /* namespace BogDog */
@@ -0,0 +1,82 @@
+/*
+ * VertexWelder.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "gfx/VertexWelder.h"
+
+namespace BogDog
+{
+
+VertexWelder::VertexWelder(int pStride,int pMaxVertices)
+{
+	stride = pStride;
+	count = 0;
+	vertices = new uint8_t[pStride * pMaxVertices];
+
+	//Keep the table no more than half full so the probes stay short.
+	uint32_t tableSize = 16;
+	while( tableSize < (uint32_t)pMaxVertices * 2 )
+	{
+		tableSize <<= 1;
+	}
+	tableMask = tableSize - 1;
+	table = new int[tableSize];
+	memset(table,0xff,sizeof(int) * tableSize);
+}
+
+VertexWelder::~VertexWelder()
+{
+	delete []vertices;
+	delete []table;
+}
+
+int VertexWelder::Add(const uint8_t* vertex)
+{
+	uint32_t slot = Hash(vertex,stride) & tableMask;
+	while( table[slot] != -1 )
+	{
+		const int index = table[slot];
+		if( memcmp(vertices + (index * stride),vertex,stride) == 0 )
+		{
+			return index;
+		}
+		slot = (slot + 1) & tableMask;
+	}
+
+	const int index = count++;
+	memcpy(vertices + (index * stride),vertex,stride);
+	table[slot] = index;
+	return index;
+}
+
+uint32_t VertexWelder::Hash(const uint8_t* data,int size)
+{
+	//FNV-1a, quick and good enough for this.
+	uint32_t hash = 2166136261u;
+	for( int n = 0 ; n < size ; n++ )
+	{
+		hash ^= data[n];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+} /* namespace BogDog */
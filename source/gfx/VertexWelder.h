@@ -0,0 +1,86 @@
+/*
+ * VertexWelder.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VERTEXWELDER_H_
+#define VERTEXWELDER_H_
+
+#include <stdint.h>
+
+namespace BogDog
+{
+
+/**
+ * Merges identical vertices so a mesh can be drawn with indices.
+ * Vertices are compared as raw bytes after they have been written in their vertex format,
+ * so two corners are only welded if every attribute is the same. A hash table keeps it linear time.
+ */
+struct VertexWelder
+{
+	/**
+	 * @param stride The size of one vertex in bytes.
+	 * @param maxVertices The most vertices that will be added, the number of face corners.
+	 */
+	VertexWelder(int stride,int maxVertices);
+	~VertexWelder();
+
+	/**
+	 * Adds a vertex, if an identical one has already been added its index is returned instead.
+	 * @param vertex stride bytes of vertex data.
+	 * @return The index of the vertex.
+	 */
+	int Add(const uint8_t* vertex);
+
+	/**
+	 * @return The number of unique vertices.
+	 */
+	int getCount()const
+	{
+		return count;
+	}
+
+	/**
+	 * @return The unique vertices, getCount() * stride bytes.
+	 */
+	const uint8_t* getVertices()const
+	{
+		return vertices;
+	}
+
+	/**
+	 * Non const version, for when the vertices are going to be reordered in place.
+	 */
+	uint8_t* getVertices()
+	{
+		return vertices;
+	}
+
+private:
+	int stride;
+	int count;
+	uint8_t* vertices;
+	int* table;			//!<Open addressed hash table of vertex indices, -1 is an empty slot.
+	uint32_t tableMask;
+
+	static uint32_t Hash(const uint8_t* data,int size);
+};
+
+} /* namespace BogDog */
+#endif /* VERTEXWELDER_H_ */
@@ -0,0 +1,130 @@
+/*
+ * FrameStats.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include "FrameStats.h"
+
+namespace BogDog
+{
+
+void FrameStats::Reset()
+{
+	memset(this,0,sizeof(FrameStats));
+}
+
+void FrameStats::Print(const char* title)const
+{
+	printf("%s: draws %u tris %u verts %u programs %u textures %u uniforms %u buffer KB %.1f texture KB %.1f swap %.2fms\n",
+			title,drawCalls,triangles,vertices,programSwitches,textureBinds,uniformUploads,bufferBytes / 1024.0f,textureBytes / 1024.0f,swapMilliseconds);
+}
+
+FrameStatsHistory::FrameStatsHistory()
+{
+	Reset();
+}
+
+void FrameStatsHistory::Reset()
+{
+	count = 0;
+	next = 0;
+}
+
+void FrameStatsHistory::Add(const FrameStats& frame)
+{
+	frames[next] = frame;
+	next = (next + 1) % HISTORY;
+	if( count < HISTORY )
+		count++;
+}
+
+FrameStats FrameStatsHistory::GetAverage()const
+{
+	FrameStats average;
+	average.Reset();
+	if( count == 0 )
+		return average;
+
+	uint64_t totals[8] = {0,0,0,0,0,0,0,0};
+	double swap = 0.0;
+	for( int n = 0 ; n < count ; n++ )
+	{
+		const FrameStats& f = frames[n];
+		totals[0] += f.drawCalls;
+		totals[1] += f.triangles;
+		totals[2] += f.vertices;
+		totals[3] += f.programSwitches;
+		totals[4] += f.textureBinds;
+		totals[5] += f.uniformUploads;
+		totals[6] += f.bufferBytes;
+		totals[7] += f.textureBytes;
+		swap += f.swapMilliseconds;
+	}
+
+	const uint64_t half = count / 2;
+	average.drawCalls = (uint32_t)((totals[0] + half) / count);
+	average.triangles = (uint32_t)((totals[1] + half) / count);
+	average.vertices = (uint32_t)((totals[2] + half) / count);
+	average.programSwitches = (uint32_t)((totals[3] + half) / count);
+	average.textureBinds = (uint32_t)((totals[4] + half) / count);
+	average.uniformUploads = (uint32_t)((totals[5] + half) / count);
+	average.bufferBytes = (uint32_t)((totals[6] + half) / count);
+	average.textureBytes = (uint32_t)((totals[7] + half) / count);
+	average.swapMilliseconds = (float)(swap / count);
+	return average;
+}
+
+/**
+ * The value at a percentile of one counter over the frames.
+ */
+template <class TYPE> static TYPE Percentile(const FrameStats* frames,int count,TYPE FrameStats::*counter,float percent)
+{
+	TYPE values[FrameStatsHistory::HISTORY];
+	for( int n = 0 ; n < count ; n++ )
+		values[n] = frames[n].*counter;
+
+	int index = (int)((percent / 100.0f) * (count - 1) + 0.5f);
+	index = std::max(0,std::min(count - 1,index));
+	std::nth_element(values,values + index,values + count);
+	return values[index];
+}
+
+FrameStats FrameStatsHistory::GetPercentile(float percent)const
+{
+	FrameStats result;
+	result.Reset();
+	if( count == 0 )
+		return result;
+
+	result.drawCalls = Percentile(frames,count,&FrameStats::drawCalls,percent);
+	result.triangles = Percentile(frames,count,&FrameStats::triangles,percent);
+	result.vertices = Percentile(frames,count,&FrameStats::vertices,percent);
+	result.programSwitches = Percentile(frames,count,&FrameStats::programSwitches,percent);
+	result.textureBinds = Percentile(frames,count,&FrameStats::textureBinds,percent);
+	result.uniformUploads = Percentile(frames,count,&FrameStats::uniformUploads,percent);
+	result.bufferBytes = Percentile(frames,count,&FrameStats::bufferBytes,percent);
+	result.textureBytes = Percentile(frames,count,&FrameStats::textureBytes,percent);
+	result.swapMilliseconds = Percentile(frames,count,&FrameStats::swapMilliseconds,percent);
+	return result;
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,93 @@
+/*
+ * FrameStats.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+
+#include <stdint.h>
+
+namespace BogDog
+{
+
+/**
+ * What one frame asked of GL, OpenGLES_2_0 collects these and finishes a frame's set in Update.
+ * Use them to set budgets for content and to spot when new assets cost more than they should.
+ */
+struct FrameStats
+{
+	uint32_t drawCalls;
+	uint32_t triangles;
+	uint32_t vertices;			//!<Vertices drawn, for indexed draws the indices.
+	uint32_t programSwitches;
+	uint32_t textureBinds;
+	uint32_t uniformUploads;
+	uint32_t bufferBytes;		//!<Uploaded to vertex and index buffers.
+	uint32_t textureBytes;		//!<Uploaded to textures.
+	float swapMilliseconds;		//!<CPU time in eglSwapBuffers, or the flush when headless.
+
+	void Reset();
+
+	/**
+	 * Prints the counters on one line after a title.
+	 */
+	void Print(const char* title)const;
+};
+
+/**
+ * The stats of the last HISTORY frames, for rolling averages and percentiles.
+ */
+struct FrameStatsHistory
+{
+	static const int HISTORY = 120;
+
+	FrameStatsHistory();
+
+	void Add(const FrameStats& frame);
+
+	/**
+	 * @return The number of frames held, up to HISTORY.
+	 */
+	int GetCount()const
+	{
+		return count;
+	}
+
+	/**
+	 * @return Each counter averaged over the frames held, rounded.
+	 */
+	FrameStats GetAverage()const;
+
+	/**
+	 * @param percent 0 to 100, 95 gives the value 95% of the frames are at or under.
+	 * @return Each counter's percentile on its own, so the result is not one real frame.
+	 */
+	FrameStats GetPercentile(float percent)const;
+
+	void Reset();
+
+private:
+	FrameStats frames[HISTORY];
+	int count;
+	int next;
+};
+
+} /* namespace BogDog */
+#endif /* FRAMESTATS_H_ */
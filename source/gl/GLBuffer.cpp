@@ -19,12 +19,15 @@
  * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdio.h>
+#include <string.h>
 #include "./gl/GLBuffer.h"
+#include "./gl/GLResources.h"
 #include "./gl/OpenGLES20.h"
 namespace BogDog
 {
 
-GLBuffer::GLBuffer(int pCount,int pElementCount,int pDataType,int pTarget,int pUsage)
+GLBuffer::GLBuffer(int pCount,int pElementCount,int pDataType,int pTarget,int pUsage,const void* data)
 {
 	count = pCount;
 	dataType = pDataType;
@@ -34,18 +37,38 @@ GLBuffer::GLBuffer(int pCount,int pElementCount,int pDataType,int pTarget,int pU
 	elementSize = OpenGLES_2_0::GetGLTypeSize(pDataType) * pElementCount;
 	memSize = pCount * elementSize;
 
-//	glGenBuffers(1,&buffer);
+	glGenBuffers(1,&buffer);
+	CHECK_OGL_ERRORS();
 
-	//Get the buffer to allocate it's data.
-/*	glBindBuffer(target,buffer);
-	glBufferData(target, memSize, NULL, usage);*/
+	shadowCopy = NULL;
+	if( !GLResources::Add(GetResourceCategory(),buffer,memSize,usage) )
+	{//Over budget, leave it empty. setData does nothing and Mesh::Draw skips meshes with empty buffers.
+		printf("GLBuffer: not allocating %d bytes\n",memSize);
+		count = 0;
+		memSize = 0;
+		return;
+	}
 
-	bufferEmulation = malloc(memSize);
+	//Allocate the storage and fill it in one go, a later setData would make the driver allocate it again.
+	Bind();
+	glBufferData(target, memSize, data, usage);
+	CHECK_OGL_ERRORS();
+
+	shadowCopy = malloc(memSize);
+	if( data != NULL )
+	{
+		memcpy(shadowCopy,data,memSize);
+		OpenGLES_2_0::CountBufferUpload(memSize);
+	}
 }
 
 GLBuffer::~GLBuffer()
 {
-
+	GLResources::Remove(GetResourceCategory(),buffer);
+	OpenGLES_2_0::GetStateCache().DeleteBuffer(buffer);
+	glDeleteBuffers(1,&buffer);
+	CHECK_OGL_ERRORS();
+	free(shadowCopy);
 }
 
 } /* namespace BogDog */
@@ -23,8 +23,10 @@
 #define GLBUFFER_H_
 
 #include <memory.h>
+#include <stdlib.h>
 #include "GLHeaders.h"
 #include "OpenGLES20.h"
+#include "GLResources.h"
 #include "Common.h"
 #include "./maths/Vector3.h"
 
@@ -36,16 +38,32 @@ struct GLBuffer
 	/**
 	 * Creates a buffer.
 	 * I have created some extensions to this class for common used combinations such as x,y,z, colours, UV and indices.
+	 * The buffer is a real GL buffer object, the data lives on the GPU side so the driver does not have to copy it every draw.
+	 * A CPU shadow copy is also kept so that the data can be read back or partly updated, call ReleaseShadowCopy once the
+	 * buffer is filled and you will never need to read it again to save the memory.
 	 * @param count The number of 'vertices' or element sets in the buffer. For example number of xyz sets.
 	 * @param elementCount The number of elements, for example for xyz it will be 3.
 	 * @param dataType The GL data type, for example GL_FLOAT.
 	 * @param target The target, GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
-	 * @param usage
+	 * @param usage The GL usage hint, GL_STATIC_DRAW, GL_DYNAMIC_DRAW or GL_STREAM_DRAW.
+	 * @param data The data to fill the whole buffer with, NULL to leave it undefined until setData is called.
 	 */
-	GLBuffer(int count,int elementCount,int dataType,int target,int usage);
+	GLBuffer(int count,int elementCount,int dataType,int target,int usage,const void* data = NULL);
 
 	~GLBuffer();
 
+	// Owns the GL buffer and the shadow copy, a copy would delete them twice.
+	GLBuffer(const GLBuffer&) = delete;
+	GLBuffer& operator=(const GLBuffer&) = delete;
+
+	/**
+	 * @return true if the buffer has no storage, it was empty or the GPU memory budget refused it.
+	 */
+	bool isEmpty()
+	{
+		return memSize == 0;
+	}
+
 	/**
 	 * @return The number of element groups, think of it as vertex count where one vertex could be three floats for XYZ.
 	 */
@@ -54,17 +72,58 @@ struct GLBuffer
 		return count;
 	}
 
+	/**
+	 * @return The size of the buffer in bytes.
+	 */
+	int getMemSize()
+	{
+		return memSize;
+	}
+
+	/**
+	 * @return The size of one 'vertex' in bytes.
+	 */
+	int getElementSize()
+	{
+		return elementSize;
+	}
+
+	/**
+	 * @return The GL buffer object name.
+	 */
+	GLuint getBuffer()
+	{
+		return buffer;
+	}
+
+	/**
+	 * @return The CPU side copy of the data, NULL if it has been released.
+	 */
+	const void* getShadowCopy()const
+	{
+		return shadowCopy;
+	}
+
 	/**
 	 * Expects that the data object passed will fill all of the object.
+	 * As we are replacing the whole buffer we use glBufferData so the driver can orphan the old storage
+	 * and not wait for draws that are still using it.
 	 * @param data
 	 */
-	void setData(void* data)
+	void setData(const void* data)
 	{
-/*		glBindBuffer(target,buffer);
-        CHECK_OGL_ERRORS();
+		if( memSize == 0 )
+		{// Refused by the GPU memory budget.
+			return;
+		}
+		Bind();
 		glBufferData(target, memSize, data, usage);
-        CHECK_OGL_ERRORS();*/
-		memcpy(bufferEmulation,data,memSize);
+		CHECK_OGL_ERRORS();
+		OpenGLES_2_0::CountBufferUpload(memSize);
+		if( shadowCopy != NULL )
+		{
+			memcpy(shadowCopy,data,memSize);
+		}
 	}
 
 	/**
@@ -74,29 +133,55 @@ struct GLBuffer
 	 * @param index
 	 * @param data
 	 */
-	void setData(int index,void* data)
+	void setData(int index,const void* data)
 	{
-/*		glBindBuffer(target,buffer);
-        CHECK_OGL_ERRORS();
+		if( memSize == 0 )
+		{// Refused by the GPU memory budget.
+			return;
+		}
+		Bind();
 		glBufferSubData(target, index * elementSize,elementSize, data);
-        CHECK_OGL_ERRORS();*/
-		memcpy(((uint8_t*)bufferEmulation) + index * elementSize,data,elementSize);
+		CHECK_OGL_ERRORS();
+		OpenGLES_2_0::CountBufferUpload(elementSize);
+		if( shadowCopy != NULL )
+		{
+			memcpy(((uint8_t*)shadowCopy) + index * elementSize,data,elementSize);
+		}
+	}
+
+	/**
+	 * Frees the CPU side copy of the data. After this the only copy is the one GL has.
+	 * Worth doing for static buffers once they have been filled.
+	 */
+	void ReleaseShadowCopy()
+	{
+		free(shadowCopy);
+		shadowCopy = NULL;
+	}
+
+	/**
+	 * Binds the buffer to it's target.
+	 */
+	void Bind()
+	{
+		OpenGLES_2_0::GetStateCache().BindBuffer(target,buffer);
+		CHECK_OGL_ERRORS();
 	}
 
 	/**
 	 * Enables the buffer for use by the vertex shader.
 	 * Should only be used with array buffers.
 	 * @param streamIndex
-	 * @param offset
+	 * @param normalised
+	 * @param offset Byte offset into the buffer of the first element.
 	 */
 	void Enable(int streamIndex,bool normalised,int offset)
 	{
-//		glBindBuffer(GL_ARRAY_BUFFER,buffer);
- //       CHECK_OGL_ERRORS();
-		glVertexAttribPointer(streamIndex,elementCount,dataType,normalised,0, bufferEmulation);
-        CHECK_OGL_ERRORS();
-		glEnableVertexAttribArray(streamIndex);
-        CHECK_OGL_ERRORS();
+		Bind();
+		glVertexAttribPointer(streamIndex,elementCount,dataType,normalised,0,(const GLvoid*)(size_t)offset);
+		CHECK_OGL_ERRORS();
+		OpenGLES_2_0::GetStateCache().EnableVertexAttribArray(streamIndex);
+		CHECK_OGL_ERRORS();
 	}
 
 	/**
@@ -111,7 +196,12 @@ struct GLBuffer
 	}*/
 
 private:
-//	GLuint buffer;
+	ResourceCategory GetResourceCategory()const
+	{
+		return target == GL_ELEMENT_ARRAY_BUFFER ? RESOURCE_INDEX_BUFFER : RESOURCE_VERTEX_BUFFER;
+	}
+
+	GLuint buffer;
 	int count;
 	int elementCount;
 	int dataType;
@@ -119,7 +209,7 @@ private:
 	int usage;
 	int elementSize;
 	int memSize;
-	GLvoid *bufferEmulation;
+	void* shadowCopy;
 };
 
 
@@ -142,9 +232,8 @@ struct GLBufferXYZ : GLBuffer
 	 * @param count Vertex count.
 	 * @param staticDraw Set to true if the buffer is not going to be changed once filled with data. Improves performance.
 	 */
-	GLBufferXYZ(float* data,int length,bool staticDraw) : GLBuffer(length/3,3,GL_FLOAT,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW)
+	GLBufferXYZ(float* data,int length,bool staticDraw) : GLBuffer(length/3,3,GL_FLOAT,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW,data)
 	{
-		setData(data);
 	}
 
 	/**
@@ -185,9 +274,8 @@ struct GLBufferXY : GLBuffer
 	 * @param count Vertex count.
 	 * @param staticDraw Set to true if the buffer is not going to be changed once filled with data. Improves performance.
 	 */
-	GLBufferXY(float* data,int length,bool staticDraw) : GLBuffer(length/2,2,GL_FLOAT,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW)
+	GLBufferXY(float* data,int length,bool staticDraw) : GLBuffer(length/2,2,GL_FLOAT,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW,data)
 	{
-		setData(data);
 	}
 
 	/**
@@ -219,9 +307,8 @@ struct GLBufferColour : GLBuffer
 	 * @param count Vertex count.
 	 * @param staticDraw Set to true if the buffer is not going to be changed once filled with data. Improves performance.
 	 */
-	GLBufferColour(int* data,int length,bool staticDraw):GLBuffer(length,4,GL_UNSIGNED_BYTE,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW)
+	GLBufferColour(int* data,int length,bool staticDraw):GLBuffer(length,4,GL_UNSIGNED_BYTE,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW,data)
 	{
-		setData(data);
 	}
 
 	/**
@@ -234,27 +321,61 @@ struct GLBufferColour : GLBuffer
 };
 
 /**
- * Buffer object for indices.
+ * Buffer object for interleaved vertices, see VertexFormat.
+ * Each element is one whole vertex of stride bytes.
  * @author richard
  *
  */
-struct GLBufferIndex : GLBuffer
+struct GLBufferInterleaved : GLBuffer
 {
 	/**
 	 * @param count Vertex count.
+	 * @param stride The size of one vertex in bytes.
 	 * @param staticDraw Set to true if the buffer is not going to be changed once filled with data. Improves performance.
 	 */
-	GLBufferIndex(int count,bool staticDraw) : GLBuffer(count,1,GL_UNSIGNED_SHORT,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW)
+	GLBufferInterleaved(int count,int stride,bool staticDraw) : GLBuffer(count,stride,GL_UNSIGNED_BYTE,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW)
 	{
 	}
 
 	/**
+	 * @param data The interleaved vertices, count * stride bytes.
 	 * @param count Vertex count.
+	 * @param stride The size of one vertex in bytes.
+	 * @param staticDraw Set to true if the buffer is not going to be changed once filled with data. Improves performance.
+	 */
+	GLBufferInterleaved(const void* data,int count,int stride,bool staticDraw) : GLBuffer(count,stride,GL_UNSIGNED_BYTE,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW,data)
+	{
+	}
+
+	/**
+	 * Each attribute has it's own type, size and offset in the vertex, set them up with VertexFormat::Enable.
+	 * GLBuffer's would describe the whole vertex as one attribute of stride unsigned bytes.
+	 */
+	void Enable(int streamIndex,bool normalised,int offset) = delete;
+};
+
+/**
+ * Buffer object for indices.
+ * @author richard
+ *
+ */
+struct GLBufferIndex : GLBuffer
+{
+	/**
+	 * @param count Index count.
+	 * @param staticDraw Set to true if the buffer is not going to be changed once filled with data. Improves performance.
+	 */
+	GLBufferIndex(int count,bool staticDraw) : GLBuffer(count,1,GL_UNSIGNED_SHORT,GL_ELEMENT_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW)
+	{
+	}
+
+	/**
+	 * @param data The indices.
+	 * @param length Index count.
 	 * @param staticDraw Set to true if the buffer is not going to be changed once filled with data. Improves performance.
 	 */
-	GLBufferIndex(short* data,int length,bool staticDraw):GLBuffer(length,1,GL_UNSIGNED_SHORT,GL_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW)
+	GLBufferIndex(const uint16_t* data,int length,bool staticDraw):GLBuffer(length,1,GL_UNSIGNED_SHORT,GL_ELEMENT_ARRAY_BUFFER,staticDraw?GL_STATIC_DRAW:GL_DYNAMIC_DRAW,data)
 	{
-		setData(data);
 	}
 };
 
@@ -0,0 +1,255 @@
+/*
+ * GLResources.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gl/GLResources.h"
+#include "DynamicBuffer.h"
+
+namespace BogDog
+{
+
+struct ResourceRecord
+{
+	ResourceCategory category;
+	GLuint name;
+	size_t bytes;
+	int usage;
+	const char* owner;
+};
+
+static DynamicBuffer<ResourceRecord,256,256> records;
+static size_t totals[RESOURCE_CATEGORY_COUNT] = {0};
+static size_t highWater[RESOURCE_CATEGORY_COUNT] = {0};
+static size_t total = 0;
+static size_t totalHighWater = 0;
+static size_t budget = 0;
+static bool abortOnExceed = false;
+
+const char* GLResources::currentOwner = "Unknown";
+
+static const char* UsageName(ResourceCategory category,int usage)
+{
+	if( category == RESOURCE_TEXTURE )
+	{
+		return usage > 1 ? "mipmapped" : "";
+	}
+
+	switch( usage )
+	{
+	case GL_STATIC_DRAW:
+		return "static";
+
+	case GL_DYNAMIC_DRAW:
+		return "dynamic";
+
+	case GL_STREAM_DRAW:
+		return "stream";
+	}
+	return "";
+}
+
+bool GLResources::Add(ResourceCategory category,GLuint name,size_t bytes,int usage)
+{
+	assert( category < RESOURCE_CATEGORY_COUNT );
+	if( budget > 0 && total + bytes > budget )
+	{
+		printf("GLResources: BUDGET EXCEEDED, %s of %zu bytes for '%s' would make %zu bytes, the budget is %zu\n",
+				GetCategoryName(category),bytes,currentOwner,total + bytes,budget);
+		if( abortOnExceed )
+		{
+			abort();
+		}
+		return false;
+	}
+
+	ResourceRecord* record = records.PushBack();
+	record->category = category;
+	record->name = name;
+	record->bytes = bytes;
+	record->usage = usage;
+	record->owner = currentOwner;
+
+	totals[category] += bytes;
+	total += bytes;
+	if( totals[category] > highWater[category] )
+	{
+		highWater[category] = totals[category];
+	}
+	if( total > totalHighWater )
+	{
+		totalHighWater = total;
+	}
+	return true;
+}
+
+void GLResources::Remove(ResourceCategory category,GLuint name)
+{
+	for( size_t n = 0 ; n < records.GetSize() ; n++ )
+	{
+		if( records[n].category == category && records[n].name == name )
+		{
+			totals[category] -= records[n].bytes;
+			total -= records[n].bytes;
+
+			//Order does not matter so move the last one into the gap.
+			records[n] = records.GetLast();
+			records.PopBack();
+			return;
+		}
+	}
+}
+
+size_t GLResources::GetTotal(ResourceCategory category)
+{
+	return totals[category];
+}
+
+size_t GLResources::GetTotal()
+{
+	return total;
+}
+
+size_t GLResources::GetHighWater(ResourceCategory category)
+{
+	return highWater[category];
+}
+
+size_t GLResources::GetHighWater()
+{
+	return totalHighWater;
+}
+
+int GLResources::GetCount(ResourceCategory category)
+{
+	int count = 0;
+	for( size_t n = 0 ; n < records.GetSize() ; n++ )
+	{
+		if( records[n].category == category )
+		{
+			count++;
+		}
+	}
+	return count;
+}
+
+void GLResources::SetBudget(size_t bytes,bool abortWhenExceeded)
+{
+	budget = bytes;
+	abortOnExceed = abortWhenExceeded;
+}
+
+size_t GLResources::GetBudget()
+{
+	return budget;
+}
+
+void GLResources::PrintReport()
+{
+	printf("GLResources: %d KB allocated, high water %d KB",(int)(total / 1024),(int)(totalHighWater / 1024));
+	if( budget > 0 )
+	{
+		printf(", budget %d KB",(int)(budget / 1024));
+	}
+	printf("\n");
+
+	for( int c = 0 ; c < RESOURCE_CATEGORY_COUNT ; c++ )
+	{
+		const ResourceCategory category = (ResourceCategory)c;
+		printf("  %-14s %5d of them %8d KB, high water %8d KB\n",GetCategoryName(category),GetCount(category),(int)(totals[c] / 1024),(int)(highWater[c] / 1024));
+	}
+
+	//Totals per owner, owners are string literals so compare the text in case the same tag is in two places.
+	DynamicBuffer<const char*,16,16> owners;
+	for( size_t n = 0 ; n < records.GetSize() ; n++ )
+	{
+		bool found = false;
+		for( size_t o = 0 ; o < owners.GetSize() && !found ; o++ )
+		{
+			found = strcmp(owners[o],records[n].owner) == 0;
+		}
+		if( !found )
+		{
+			owners.PushBack(records[n].owner);
+		}
+	}
+
+	for( size_t o = 0 ; o < owners.GetSize() ; o++ )
+	{
+		size_t bytes = 0;
+		int count = 0;
+		for( size_t n = 0 ; n < records.GetSize() ; n++ )
+		{
+			if( strcmp(owners[o],records[n].owner) == 0 )
+			{
+				bytes += records[n].bytes;
+				count++;
+			}
+		}
+		printf("  owner %-20s %5d of them %8d KB\n",owners[o],count,(int)(bytes / 1024));
+	}
+}
+
+int GLResources::ReportLeaks()
+{
+	const int count = (int)records.GetSize();
+	if( count > 0 )
+	{
+		printf("GLResources: %d resources, %zu bytes, were not freed\n",count,total);
+		for( int n = 0 ; n < count ; n++ )
+		{
+			const ResourceRecord& r = records[n];
+			printf("  %s %d, %zu bytes %s, owner %s\n",GetCategoryName(r.category),r.name,r.bytes,UsageName(r.category,r.usage),r.owner);
+		}
+	}
+	return count;
+}
+
+const char* GLResources::GetCategoryName(ResourceCategory category)
+{
+	switch( category )
+	{
+	case RESOURCE_VERTEX_BUFFER:
+		return "VertexBuffer";
+
+	case RESOURCE_INDEX_BUFFER:
+		return "IndexBuffer";
+
+	case RESOURCE_STREAM_BUFFER:
+		return "StreamBuffer";
+
+	case RESOURCE_TEXTURE:
+		return "Texture";
+
+	case RESOURCE_CATEGORY_COUNT:
+		break;
+	}
+	return "Unknown";
+}
+
+const char* GLResources::GetOwner()
+{
+	return currentOwner;
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,145 @@
+/*
+ * GLResources.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GLRESOURCES_H_
+#define GLRESOURCES_H_
+
+#include <stddef.h>
+#include "GLHeaders.h"
+
+namespace BogDog
+{
+
+enum ResourceCategory
+{
+	RESOURCE_VERTEX_BUFFER,
+	RESOURCE_INDEX_BUFFER,
+	RESOURCE_STREAM_BUFFER,
+	RESOURCE_TEXTURE,
+	RESOURCE_CATEGORY_COUNT
+};
+
+/**
+ * Keeps a record of every GL buffer and texture, how big it is, how it is used and who made it.
+ * GLBuffer, GLStreamBuffer and OpenGLES_2_0::CreateTexture add themselves so you can see how much GPU memory the
+ * content needs, the high water marks and anything not freed at shutdown.
+ * A budget can be set so allocations that would go over it fail, loudly, instead of the GPU running out later.
+ * Only use from the thread that owns the GL context.
+ */
+struct GLResources
+{
+	/**
+	 * Records a new resource.
+	 * @param usage For buffers the GL usage hint, for textures the number of mip levels.
+	 * @return false if it would go over the budget, the resource is not recorded and the caller must not allocate it.
+	 */
+	static bool Add(ResourceCategory category,GLuint name,size_t bytes,int usage);
+
+	/**
+	 * Removes the record of a resource that has been deleted.
+	 */
+	static void Remove(ResourceCategory category,GLuint name);
+
+	/**
+	 * @return The bytes allocated in a category now.
+	 */
+	static size_t GetTotal(ResourceCategory category);
+
+	/**
+	 * @return The bytes allocated in all categories now.
+	 */
+	static size_t GetTotal();
+
+	/**
+	 * @return The most bytes that have been allocated in a category at one time.
+	 */
+	static size_t GetHighWater(ResourceCategory category);
+
+	/**
+	 * @return The most bytes that have been allocated in all categories at one time.
+	 */
+	static size_t GetHighWater();
+
+	/**
+	 * @return The number of resources in a category.
+	 */
+	static int GetCount(ResourceCategory category);
+
+	/**
+	 * Sets the most bytes that can be allocated in total, 0 for no limit which is the default.
+	 * @param abortWhenExceeded If true going over the budget aborts, for test runs that must never exceed it.
+	 * Otherwise the allocation is refused and the caller carries on without it.
+	 */
+	static void SetBudget(size_t bytes,bool abortWhenExceeded = false);
+
+	static size_t GetBudget();
+
+	/**
+	 * Prints the totals and high water marks for each category and owner.
+	 */
+	static void PrintReport();
+
+	/**
+	 * Prints every resource that is still allocated, call at shutdown after everything should have been freed.
+	 * OpenGLES_2_0's destructor does this for you.
+	 * @return The number of resources still allocated.
+	 */
+	static int ReportLeaks();
+
+	static const char* GetCategoryName(ResourceCategory category);
+
+	/**
+	 * The owner tag new resources get, see GLResourceOwner.
+	 */
+	static const char* GetOwner();
+
+private:
+	friend struct GLResourceOwner;
+	static const char* currentOwner;
+};
+
+/**
+ * Sets the owner tag for resources made while it is in scope, for example
+ *   {
+ *     GLResourceOwner owner("Fonts");
+ *     ...load the fonts...
+ *   }
+ * The tag is not copied, use a string literal.
+ */
+struct GLResourceOwner
+{
+	GLResourceOwner(const char* owner)
+	{
+		previous = GLResources::currentOwner;
+		GLResources::currentOwner = owner;
+	}
+
+	~GLResourceOwner()
+	{
+		GLResources::currentOwner = previous;
+	}
+
+private:
+	const char* previous;
+};
+
+} /* namespace BogDog */
+#endif /* GLRESOURCES_H_ */
@@ -21,6 +21,7 @@
 
 #include "gl/OpenGLES20.h"
 #include "gl/GLShader.h"
+#include "gfx/Mesh.h"
 #include "maths/Matrix.h"
 
 namespace BogDog
@@ -30,23 +31,37 @@ namespace BogDog
  * Used for when we want to set the transform to an identity matrix.
  */
 float GLShader::identity[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
-float GLShader::transOnly[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
 
 GLShader::~GLShader()
 {
+	delete []instanceData;
+	delete []uniforms;
 }
 
 int GLShader::getUniformLocation(const char* name)
 {
-	int location = glGetUniformLocation(shader,name);
-	CHECK_OGL_ERRORS();
+	Uniform* uniform = FindUniform(name);
+	return uniform != NULL ? uniform->location : -1;
+}
 
-	if( location < 0 )
+void GLShader::setUniform4fv(GLint location,const GLfloat* values,int count)
+{
+	Uniform* uniform = FindUniform(location);
+	if( uniform == NULL || UniformChanged(uniform,values,count * 4) )
 	{
-		printf("Failed to find UniformLocation %s\n",name);
+		glUniform4fv(location,count,values);
+		CHECK_OGL_ERRORS();
 	}
+}
 
-	return location;
+void GLShader::setUniformMatrix(GLint location,const GLfloat* matrix)
+{
+	Uniform* uniform = FindUniform(location);
+	if( uniform == NULL || UniformChanged(uniform,matrix,16) )
+	{
+		glUniformMatrix4fv(location,1,false,matrix);
+		CHECK_OGL_ERRORS();
+	}
 }
 
 void GLShader::BindAttribLocation(int location,const char* name)
@@ -58,17 +73,74 @@ void GLShader::BindAttribLocation(int location,const char* name)
 
 void GLShader::Enable(const Matrix& projInvcam)
 {
-    glUseProgram(shader);
+    OpenGLES_2_0::GetStateCache().UseProgram(shader);
     CHECK_OGL_ERRORS();
 
-    glUniformMatrix4fv(u_proj_cam, 1, false,(const float*)projInvcam.m);
-    CHECK_OGL_ERRORS();
+    SetMatrix(u_proj_cam,(const GLfloat*)projInvcam.m);
+}
+
+void GLShader::DrawInstanced(Mesh* mesh,const Matrix* transforms,const uint32_t* colours,int count)
+{
+	if( maxInstances == 0 )
+	{
+		printf("GLShader::DrawInstanced: the shader was not made for instancing\n");
+		return;
+	}
+
+	const int copies = mesh->getInstanceCopies();
+	const int chunkSize = copies < maxInstances ? copies : maxInstances;
+	const int trianglesPerCopy = mesh->getTriangleCount() / copies;
+
+	mesh->Enable(this);
+	for( int first = 0 ; first < count ; first += chunkSize )
+	{
+		const int chunk = count - first < chunkSize ? count - first : chunkSize;
+
+		float* data = instanceData;
+		for( int n = 0 ; n < chunk ; n++ )
+		{
+			//Columns so the shader can do a dot product per axis, the bottom row is always 0,0,0,1 so is not sent.
+			const Matrix& transform = transforms[first + n];
+			for( int column = 0 ; column < 3 ; column++ )
+			{
+				*data++ = transform.m[0][column];
+				*data++ = transform.m[1][column];
+				*data++ = transform.m[2][column];
+				*data++ = transform.m[3][column];
+			}
+
+			const uint32_t colour = colours != NULL ? colours[first + n] : 0xffffffff;
+			*data++ = ((colour >> 0) & 0xff) / 255.0f;
+			*data++ = ((colour >> 8) & 0xff) / 255.0f;
+			*data++ = ((colour >> 16) & 0xff) / 255.0f;
+			*data++ = ((colour >> 24) & 0xff) / 255.0f;
+		}
 
-    if( u_tex0 > 0 )
-    {
-    	glActiveTexture(GL_TEXTURE0);
-    	glUniform1i(u_tex0,0);
-    }
+		glUniform4fv(u_instances,chunk * 4,instanceData);
+		CHECK_OGL_ERRORS();
+		mesh->Draw(0,trianglesPerCopy * chunk);
+	}
+}
+
+int GLShader::SetupInstancing(int requested,int reservedVectors)
+{
+	GLint maxVectors = 0;
+	glGetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS,&maxVectors);
+	CHECK_OGL_ERRORS();
+
+	maxInstances = (maxVectors - reservedVectors) / 4;
+	if( maxInstances > requested )
+	{
+		maxInstances = requested;
+	}
+	if( maxInstances < 1 )
+	{
+		maxInstances = 1;
+	}
+
+	delete []instanceData;
+	instanceData = new float[maxInstances * 16];
+	return maxInstances;
 }
 
 void GLShader::Create(const char* vertex, const char* fragment)
@@ -119,15 +191,124 @@ void GLShader::Create(const char* vertex, const char* fragment)
 	}
 
 	//Get the bits for the variables in the shader.
+	FindUniforms();
+	u_proj_cam = FindUniform("u_proj_cam");
+	u_trans = FindUniform("u_trans");
+	u_global_colour = FindUniform("u_global_colour");
+	u_tex0 = FindUniform("u_tex0");
+	if( maxInstances > 0 )
+	{
+		u_instances = getUniformLocation("u_instances");
+	}
 	onGetUniformLocation();
+
+	//The sampler always reads unit 0 and uniforms stay with the program, so it only needs setting once.
+	if( u_tex0 != NULL )
+	{
+		OpenGLES_2_0::GetStateCache().UseProgram(shader);
+		glUniform1i(u_tex0->location,0);
+		CHECK_OGL_ERRORS();
+	}
 }
 
 void GLShader::onGetUniformLocation()
 {
-	u_proj_cam = getUniformLocation("u_proj_cam");
-	u_trans = getUniformLocation("u_trans");
-	u_global_colour = getUniformLocation("u_global_colour");
-	u_tex0 = getUniformLocation("u_tex0");
+}
+
+void GLShader::FindUniforms()
+{
+	delete []uniforms;
+	uniforms = NULL;
+	uniformCount = 0;
+	if( shader == 0 )
+	{
+		return;
+	}
+
+	GLint count = 0;
+	glGetProgramiv(shader,GL_ACTIVE_UNIFORMS,&count);
+	CHECK_OGL_ERRORS();
+	if( count <= 0 )
+	{
+		return;
+	}
+
+	uniforms = new Uniform[count];
+	for( int n = 0 ; n < count ; n++ )
+	{
+		Uniform& uniform = uniforms[uniformCount];
+		GLsizei length = 0;
+		glGetActiveUniform(shader,n,MAX_UNIFORM_NAME,&length,&uniform.size,&uniform.type,uniform.name);
+		CHECK_OGL_ERRORS();
+
+		// Arrays are reported as name[0], we look them up by the name.
+		char* bracket = strchr(uniform.name,'[');
+		if( bracket != NULL )
+		{
+			*bracket = 0;
+		}
+
+		uniform.location = glGetUniformLocation(shader,uniform.name);
+		CHECK_OGL_ERRORS();
+		if( uniform.location < 0 )
+		{// Built in ones, gl_DepthRange for example, have no location.
+			continue;
+		}
+
+		uniform.floats = 0;
+		if( uniform.size == 1 )
+		{
+			switch( uniform.type )
+			{
+			case GL_FLOAT:
+				uniform.floats = 1;
+				break;
+
+			case GL_FLOAT_VEC2:
+				uniform.floats = 2;
+				break;
+
+			case GL_FLOAT_VEC3:
+				uniform.floats = 3;
+				break;
+
+			case GL_FLOAT_VEC4:
+				uniform.floats = 4;
+				break;
+
+			case GL_FLOAT_MAT4:
+				uniform.floats = 16;
+				break;
+			}
+		}
+		uniform.known = false;
+		uniformCount++;
+	}
+}
+
+GLShader::Uniform* GLShader::FindUniform(const char* name)
+{
+	for( int n = 0 ; n < uniformCount ; n++ )
+	{
+		if( strcmp(uniforms[n].name,name) == 0 )
+		{
+			return &uniforms[n];
+		}
+	}
+	printf("Failed to find UniformLocation %s\n",name);
+	return NULL;
+}
+
+GLShader::Uniform* GLShader::FindUniform(GLint location)
+{
+	for( int n = 0 ; n < uniformCount ; n++ )
+	{
+		if( uniforms[n].location == location )
+		{
+			return &uniforms[n];
+		}
+	}
+	return NULL;
 }
 
 void GLShader::onBindAttribs()
@@ -136,6 +317,10 @@ void GLShader::onBindAttribs()
 	BindAttribLocation(ATTRIB_POS, "a_xyz");
 	BindAttribLocation(ATTRIB_COLOUR, "a_col");
 	BindAttribLocation(ATTRIB_UV0, "a_uv0");
+	if( maxInstances > 0 )
+	{
+		BindAttribLocation(ATTRIB_INSTANCE, "a_instance");
+	}
 }
 
 int GLShader::LoadShader(int type, const char* shaderCode)
@@ -145,7 +330,14 @@ int GLShader::LoadShader(int type, const char* shaderCode)
 	int shaderFrag = glCreateShader(type);
 
 	// add the source code to the shader and compile it
-	glShaderSource(shaderFrag,1,&shaderCode,NULL);
+	// GLES fragment shaders have no default float precision, the RPi driver lets it go but Mesa does not.
+	// Desktop GL does not define GL_ES so it does not see the precision statement.
+	const char* sources[2] = {"",shaderCode};
+	if( type == GL_FRAGMENT_SHADER && strstr(shaderCode,"precision") == NULL )
+	{
+		sources[0] = "#ifdef GL_ES\nprecision mediump float;\n#endif\n";
+	}
+	glShaderSource(shaderFrag,2,sources,NULL);
 	glCompileShader(shaderFrag);
 	CHECK_OGL_ERRORS();
 	// Check the compile status
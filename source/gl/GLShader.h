@@ -23,20 +23,28 @@
 #define GLSHADER_H_
 
 #include <stdio.h>
+#include <string.h>
 #include "OpenGLES20.h"
 #include "maths/Matrix.h"
 
 namespace BogDog
 {
 
+struct Mesh;
+
 #define ATTRIB_POS 0
 #define ATTRIB_COLOUR 1
 #define ATTRIB_UV0 2
+#define ATTRIB_INSTANCE 3
 
 struct GLShader
 {
 	~GLShader();
 
+	/**
+	 * Looks the name up in the uniforms found when the shader was linked, does not call GL.
+	 * @return The location or -1 if the shader does not have it.
+	 */
 	int getUniformLocation(const char* name);
 
 	void BindAttribLocation(int location,const char* name);
@@ -45,44 +53,124 @@ struct GLShader
 
 	void setTransform(Matrix& transform)
 	{
-        glUniformMatrix4fv(u_trans, 1, false,(const GLfloat*)transform.m);
-        CHECK_OGL_ERRORS();
+		if( hasDequantise )
+		{
+			Matrix final;
+			final.Mul(positionDequantise,transform);
+			SetMatrix(u_trans,(const GLfloat*)final.m);
+		}
+		else
+		{
+			SetMatrix(u_trans,(const GLfloat*)transform.m);
+		}
 	}
 
 	void setTransform(float x,float y,float z)
 	{
-		transOnly[12] = x;
-		transOnly[13] = y;
-		transOnly[14] = z;
-        glUniformMatrix4fv(u_trans, 1, false, transOnly);
-        CHECK_OGL_ERRORS();
+		if( hasDequantise )
+		{
+			Matrix trans;
+			trans.Set(x,y,z);
+			setTransform(trans);
+			return;
+		}
+		const GLfloat transOnly[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, x,y,z,1};
+		SetMatrix(u_trans,transOnly);
 	}
 
 	void setTransformIdentity()
 	{
-		glUniformMatrix4fv(u_trans, 1, false, identity);
-		CHECK_OGL_ERRORS();
+		SetMatrix(u_trans,hasDequantise ? (const GLfloat*)positionDequantise.m : identity);
+	}
+
+	/**
+	 * Meshes with quantised positions store them in the range -1 to 1, this is the matrix that scales them back.
+	 * It is folded into the transform by the setTransform functions so it costs nothing in the vertex shader.
+	 * Mesh::Enable(shader) sets this for you, so call that before setting the transform.
+	 * @param dequantise The matrix or NULL for meshes with float positions.
+	 */
+	void setPositionDequantise(const Matrix* dequantise)
+	{
+		hasDequantise = dequantise != NULL;
+		if( hasDequantise )
+		{
+			positionDequantise = *dequantise;
+		}
 	}
 
 	void setGlobalColour(float red,float green,float blue,float alpha)
 	{
-		glUniform4f(u_global_colour,red,green,blue,alpha);
+		const GLfloat colour[4] = {red,green,blue,alpha};
+		if( UniformChanged(u_global_colour,colour,4) )
+		{
+			glUniform4fv(u_global_colour->location,1,colour);
+			CHECK_OGL_ERRORS();
+		}
 	}
 
+	/**
+	 * Sets a uniform by location, skipped if it already has the value. Arrays are not cached and always sent.
+	 * The shader must be enabled.
+	 * @param count The number of vec4s.
+	 */
+	void setUniform4fv(GLint location,const GLfloat* values,int count);
+
+	/**
+	 * Sets a mat4 uniform by location, skipped if it already has the value. The shader must be enabled.
+	 */
+	void setUniformMatrix(GLint location,const GLfloat* matrix);
+
 	void setTexture(int index,GLint texture)
 	{
-		glActiveTexture(GL_TEXTURE0 + index);
-		glBindTexture(GL_TEXTURE_2D,texture);
-		glUniform1i(u_tex0,0);
+		OpenGLES_2_0::GetStateCache().BindTexture(index,texture);
 	}
 
+	/**
+	 * @return The most instances one draw can do, 0 if this is not an instancing shader.
+	 */
+	int getMaxInstances()
+	{
+		return maxInstances;
+	}
+
+	/**
+	 * Draws count copies of a mesh made by Mesh::CreateInstanced, each with it's own transform and colour.
+	 * The transforms and colours are put into the uniform array u_instances, four vec4's per instance. Three for the
+	 * columns of the transform and one for the colour. Each draw does as many as the shader and the mesh have room for.
+	 * Only for shaders made for instancing, see GLShaderColourInstanced. Call after Enable.
+	 * @param colours ABGR colours as per GLES, NULL for white.
+	 */
+	void DrawInstanced(Mesh* mesh,const Matrix* transforms,const uint32_t* colours,int count);
+
 protected:
 	GLShader()
 	{
+		hasDequantise = false;
+		maxInstances = 0;
+		instanceData = NULL;
+		u_instances = -1;
+		uniforms = NULL;
+		uniformCount = 0;
+		u_trans = NULL;
+		u_proj_cam = NULL;
+		u_global_colour = NULL;
+		u_tex0 = NULL;
+		shader = 0;
 	}
 
+	/**
+	 * For shaders that do instancing, call before Create. Sets up space for the per instance uniforms.
+	 * @param requested The most instances wanted in one draw, limited by GL_MAX_VERTEX_UNIFORM_VECTORS.
+	 * @param reservedVectors The number of vertex uniform vectors the shader uses for other things.
+	 * @return The number of instances the shader should be built for.
+	 */
+	int SetupInstancing(int requested,int reservedVectors);
+
 	void Create(const char* vertex, const char* fragment);
 
+	/**
+	 * Called after linking, shaders with their own uniforms override this to look them up with getUniformLocation.
+	 */
 	virtual void onGetUniformLocation();
 
 	virtual void onBindAttribs();
@@ -93,18 +181,92 @@ protected:
 
 private:
 
+	static const int MAX_UNIFORM_NAME = 32;
+
+	/**
+	 * An active uniform of the program and the last value we gave it, so sets with the same value can be skipped.
+	 * Values are kept for float, vec and mat4 uniforms that are not arrays, the rest are always sent.
+	 */
+	struct Uniform
+	{
+		char name[MAX_UNIFORM_NAME];
+		GLint location;
+		GLenum type;
+		GLint size;			//!<Number of elements, more than 1 for arrays.
+		int floats;			//!<The number of floats in the value, 0 if it is not cached.
+		bool known;			//!<true once value holds what GL has.
+		GLfloat value[16];
+	};
+
 	/**
 	 * Used for when we want to set the transform to an identity matrix.
 	 */
 	static float identity[16];
-	static float transOnly[16];
 
-	GLint u_trans;
-	GLint u_proj_cam;
-	GLint u_global_colour;
-	GLint u_tex0;
+	Uniform* uniforms;		//!<Found with glGetActiveUniform after linking.
+	int uniformCount;
+
+	Uniform* u_trans;		//!<NULL when the shader does not have it.
+	Uniform* u_proj_cam;
+	Uniform* u_global_colour;
+	Uniform* u_tex0;
 	GLint shader;
 
+	Matrix positionDequantise;
+	bool hasDequantise;
+
+	GLint u_instances;
+	int maxInstances;
+	float* instanceData;	//!<Four vec4's per instance, filled by DrawInstanced.
+
+	/**
+	 * Reads the program's active uniforms into uniforms.
+	 */
+	void FindUniforms();
+
+	/**
+	 * @return The uniform or NULL, printing that it was not found.
+	 */
+	Uniform* FindUniform(const char* name);
+	Uniform* FindUniform(GLint location);
+
+	/**
+	 * Compares the value with the last one set and remembers it.
+	 * @return true if it needs sending to GL, false if GL already has it or the shader does not have the uniform.
+	 */
+	static bool UniformChanged(Uniform* uniform,const GLfloat* value,int floats)
+	{
+		if( uniform == NULL )
+		{
+			return false;
+		}
+
+		if( uniform->floats != floats )
+		{// Not cached, always send.
+			OpenGLES_2_0::GetStateCache().CountUniform(true);
+			return true;
+		}
+
+		if( uniform->known && memcmp(uniform->value,value,sizeof(GLfloat) * floats) == 0 )
+		{
+			OpenGLES_2_0::GetStateCache().CountUniform(false);
+			return false;
+		}
+
+		memcpy(uniform->value,value,sizeof(GLfloat) * floats);
+		uniform->known = true;
+		OpenGLES_2_0::GetStateCache().CountUniform(true);
+		return true;
+	}
+
+	void SetMatrix(Uniform* uniform,const GLfloat* matrix)
+	{
+		if( UniformChanged(uniform,matrix,16) )
+		{
+			glUniformMatrix4fv(uniform->location,1,false,matrix);
+			CHECK_OGL_ERRORS();
+		}
+	}
 
 };
 
@@ -0,0 +1,76 @@
+/*
+ * GLShaderColourInstanced.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "gl/GLShaderColourInstanced.h"
+
+namespace BogDog
+{
+/*
+ * MAX_INSTANCES is defined in front of this when the shader is made.
+ * u_instances has four vec4's per instance, the three columns of the transform then the colour.
+ */
+static const char* vertexShader = ""	\
+"uniform mat4 u_proj_cam;\n"	\
+"uniform vec4 u_instances[MAX_INSTANCES * 4];\n" \
+"attribute vec4 a_xyz;\n"	\
+"attribute vec4 a_col;\n"	\
+"attribute float a_instance;\n"	\
+"varying vec4 v_col;\n"	\
+"void main(void)\n"	\
+"{\n"	\
+"	int i = int(a_instance) * 4;\n"	\
+"	vec4 xyz = vec4(a_xyz.xyz,1.0);\n"	\
+"	vec4 world = vec4(dot(xyz,u_instances[i]),dot(xyz,u_instances[i+1]),dot(xyz,u_instances[i+2]),1.0);\n"	\
+"	v_col = u_instances[i+3] * a_col;\n"	\
+"	gl_Position = u_proj_cam * world;\n"	\
+"}\n";
+
+static const char *pixelShader = ""	\
+"varying vec4 v_col;\n"	\
+"void main(void)\n"	\
+"{\n"	\
+"	gl_FragColor = v_col;\n"	\
+"}\n";
+
+GLShaderColourInstanced* GLShaderColourInstanced::Allocate(int maxInstances)
+{
+	return new GLShaderColourInstanced(maxInstances);
+}
+
+
+GLShaderColourInstanced::GLShaderColourInstanced(int maxInstances)
+{
+	//u_proj_cam takes four vectors, leave a few spare as some drivers use them for their own constants.
+	const int instances = SetupInstancing(maxInstances,8);
+
+	char* source = new char[strlen(vertexShader) + 64];
+	sprintf(source,"#define MAX_INSTANCES %d\n%s",instances,vertexShader);
+	Create(source,pixelShader);
+	delete []source;
+}
+
+GLShaderColourInstanced::~GLShaderColourInstanced()
+{
+}
+
+} /* namespace BogDog */
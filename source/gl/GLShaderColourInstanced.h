@@ -0,0 +1,50 @@
+/*
+ * GLShaderColourInstanced.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GLSHADERCOLOURINSTANCED_H__
+#define __GLSHADERCOLOURINSTANCED_H__
+
+#include "GLShader.h"
+
+namespace BogDog
+{
+
+/*!
+ * The colour shader for drawing many copies of a mesh in one draw, see GLShader::DrawInstanced and Mesh::CreateInstanced.
+ */
+struct GLShaderColourInstanced : GLShader
+{
+	/*!
+	 * @param maxInstances The most instances wanted per draw, less if the driver does not have the uniform space.
+	 */
+	static GLShaderColourInstanced* Allocate(int maxInstances = 64);
+	virtual ~GLShaderColourInstanced();
+
+private:
+	/*!
+	 * Done to force the use of the new else you'll get shaders being made before GL is started.
+	 */
+	GLShaderColourInstanced(int maxInstances);
+
+};
+
+} /* namespace BogDog */
+#endif /* __GLSHADERCOLOURINSTANCED_H__ */
@@ -0,0 +1,143 @@
+/*
+ * GLStateCache.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "gl/GLStateCache.h"
+
+namespace BogDog
+{
+
+GLStateCache::GLStateCache()
+{
+	Invalidate();
+	ResetCounters();
+}
+
+void GLStateCache::Invalidate()
+{
+	currentProgram = 0;
+	programKnown = false;
+
+	activeUnit = -1;
+	for( int n = 0 ; n < MAX_TEXTURE_UNITS ; n++ )
+	{
+		textures[n] = 0;
+		textureKnown[n] = false;
+	}
+
+	for( int n = 0 ; n < 2 ; n++ )
+	{
+		buffers[n] = 0;
+		bufferKnown[n] = false;
+	}
+
+	enabledAttribs = 0;
+	knownAttribs = 0;
+
+	blendEnabled = -1;
+	blendSrc = blendDest = 0;
+	blendFuncKnown = false;
+	blendEquation = 0;
+
+	depthTest = -1;
+	depthWrite = -1;
+	depthFunc = 0;
+
+	cullEnabled = -1;
+	cullFace = 0;
+	cullFrontFace = 0;
+}
+
+int GLStateCache::getTotalIssued()
+{
+	int total = 0;
+	for( int n = 0 ; n < STATE_TYPE_COUNT ; n++ )
+	{
+		total += issued[n];
+	}
+	return total;
+}
+
+int GLStateCache::getTotalElided()
+{
+	int total = 0;
+	for( int n = 0 ; n < STATE_TYPE_COUNT ; n++ )
+	{
+		total += elided[n];
+	}
+	return total;
+}
+
+void GLStateCache::ResetCounters()
+{
+	memset(issued,0,sizeof(issued));
+	memset(elided,0,sizeof(elided));
+}
+
+void GLStateCache::PrintCounters()
+{
+	printf("GL state changes:\n");
+	for( int n = 0 ; n < STATE_TYPE_COUNT ; n++ )
+	{
+		printf("  %-16s issued %8d elided %8d\n",GetStateTypeName((StateType)n),issued[n],elided[n]);
+	}
+	printf("  %-16s issued %8d elided %8d\n","Total",getTotalIssued(),getTotalElided());
+}
+
+const char* GLStateCache::GetStateTypeName(StateType type)
+{
+	switch( type )
+	{
+	case STATE_PROGRAM:
+		return "Program";
+
+	case STATE_ACTIVE_TEXTURE:
+		return "Active texture";
+
+	case STATE_TEXTURE:
+		return "Texture";
+
+	case STATE_BUFFER:
+		return "Buffer";
+
+	case STATE_ATTRIB_ARRAY:
+		return "Attrib array";
+
+	case STATE_BLEND:
+		return "Blend";
+
+	case STATE_DEPTH:
+		return "Depth";
+
+	case STATE_CULL:
+		return "Cull";
+
+	case STATE_UNIFORM:
+		return "Uniform";
+
+	case STATE_TYPE_COUNT:
+		break;
+	}
+	return "Unknown";
+}
+
+} /* namespace BogDog */
@@ -0,0 +1,420 @@
+/*
+ * GLStateCache.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GLSTATECACHE_H_
+#define GLSTATECACHE_H_
+
+#include <stdint.h>
+#include "GLHeaders.h"
+
+namespace BogDog
+{
+
+/**
+ * Keeps a copy of the GL state the engine changes so calls that would set it to what it already is are skipped.
+ * GL calls are not cheap on the ARM CPUs we run on, the driver does a lot of work for each one even when nothing changes.
+ * Owned by OpenGLES_2_0, get it with OpenGLES_2_0::GetStateCache(). If you call GL yourself for any of this state
+ * call Invalidate after so the cache does not skip a call it should not.
+ */
+struct GLStateCache
+{
+	enum StateType
+	{
+		STATE_PROGRAM,
+		STATE_ACTIVE_TEXTURE,
+		STATE_TEXTURE,
+		STATE_BUFFER,
+		STATE_ATTRIB_ARRAY,
+		STATE_BLEND,
+		STATE_DEPTH,
+		STATE_CULL,
+		STATE_UNIFORM,
+		STATE_TYPE_COUNT
+	};
+
+	/**
+	 * Number of texture units and vertex attribute locations that are cached, any above this go straight to GL.
+	 */
+	static const int MAX_TEXTURE_UNITS = 8;
+	static const int MAX_ATTRIBS = 16;
+
+	GLStateCache();
+
+	/**
+	 * Forgets all the state, the next call for each one goes to GL.
+	 */
+	void Invalidate();
+
+	void UseProgram(GLuint program)
+	{
+		if( programKnown && program == currentProgram )
+		{
+			elided[STATE_PROGRAM]++;
+			return;
+		}
+		glUseProgram(program);
+		currentProgram = program;
+		programKnown = true;
+		issued[STATE_PROGRAM]++;
+	}
+
+	/**
+	 * @param unit The unit number, 0 for GL_TEXTURE0.
+	 */
+	void ActiveTexture(int unit)
+	{
+		if( activeUnit == unit )
+		{
+			elided[STATE_ACTIVE_TEXTURE]++;
+			return;
+		}
+		glActiveTexture(GL_TEXTURE0 + unit);
+		activeUnit = unit;
+		issued[STATE_ACTIVE_TEXTURE]++;
+	}
+
+	/**
+	 * Binds a 2D texture to a texture unit.
+	 */
+	void BindTexture(int unit,GLuint texture)
+	{
+		if( unit >= MAX_TEXTURE_UNITS )
+		{
+			ActiveTexture(unit);
+			glBindTexture(GL_TEXTURE_2D,texture);
+			issued[STATE_TEXTURE]++;
+			return;
+		}
+
+		if( textureKnown[unit] && textures[unit] == texture )
+		{
+			elided[STATE_TEXTURE]++;
+			return;
+		}
+		ActiveTexture(unit);
+		glBindTexture(GL_TEXTURE_2D,texture);
+		textures[unit] = texture;
+		textureKnown[unit] = true;
+		issued[STATE_TEXTURE]++;
+	}
+
+	/**
+	 * @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+	 */
+	void BindBuffer(GLenum target,GLuint buffer)
+	{
+		const int slot = target == GL_ELEMENT_ARRAY_BUFFER ? 1 : 0;
+		if( bufferKnown[slot] && buffers[slot] == buffer )
+		{
+			elided[STATE_BUFFER]++;
+			return;
+		}
+		glBindBuffer(target,buffer);
+		buffers[slot] = buffer;
+		bufferKnown[slot] = true;
+		issued[STATE_BUFFER]++;
+	}
+
+	/**
+	 * Call before deleting a buffer, GL unbinds it so the cache has to forget it.
+	 */
+	void DeleteBuffer(GLuint buffer)
+	{
+		for( int n = 0 ; n < 2 ; n++ )
+		{
+			if( buffers[n] == buffer )
+			{
+				bufferKnown[n] = false;
+			}
+		}
+	}
+
+	/**
+	 * Call before deleting a texture, GL unbinds it so the cache has to forget it.
+	 */
+	void DeleteTexture(GLuint texture)
+	{
+		for( int n = 0 ; n < MAX_TEXTURE_UNITS ; n++ )
+		{
+			if( textures[n] == texture )
+			{
+				textureKnown[n] = false;
+			}
+		}
+	}
+
+	void EnableVertexAttribArray(int location)
+	{
+		SetVertexAttribArray(location,true);
+	}
+
+	void DisableVertexAttribArray(int location)
+	{
+		SetVertexAttribArray(location,false);
+	}
+
+	/**
+	 * Enables the attribute arrays in mask and disables the rest, bit n is location n.
+	 */
+	void SetAttribMask(uint32_t mask)
+	{
+		uint32_t changed = (mask ^ enabledAttribs) | ~knownAttribs;
+		changed &= (1u << MAX_ATTRIBS) - 1;
+
+		elided[STATE_ATTRIB_ARRAY] += PopCount(mask & ~changed);
+		for( int location = 0 ; changed != 0 ; location++ , changed >>= 1 )
+		{
+			if( changed & 1 )
+			{
+				if( mask & (1u << location) )
+					glEnableVertexAttribArray(location);
+				else
+					glDisableVertexAttribArray(location);
+				issued[STATE_ATTRIB_ARRAY]++;
+			}
+		}
+		enabledAttribs = mask;
+		knownAttribs = (1u << MAX_ATTRIBS) - 1;
+	}
+
+	/**
+	 * Sets blending. When disabled the function and equation are left as they are.
+	 */
+	void SetBlend(bool enable,GLenum srcFactor = GL_SRC_ALPHA,GLenum destFactor = GL_ONE_MINUS_SRC_ALPHA,GLenum equation = GL_FUNC_ADD)
+	{
+		SetCapability(GL_BLEND,enable,blendEnabled,STATE_BLEND);
+		if( !enable )
+		{
+			return;
+		}
+
+		if( blendFuncKnown && blendSrc == srcFactor && blendDest == destFactor )
+		{
+			elided[STATE_BLEND]++;
+		}
+		else
+		{
+			glBlendFunc(srcFactor,destFactor);
+			blendSrc = srcFactor;
+			blendDest = destFactor;
+			blendFuncKnown = true;
+			issued[STATE_BLEND]++;
+		}
+
+		if( blendEquation == equation )
+		{
+			elided[STATE_BLEND]++;
+		}
+		else
+		{
+			glBlendEquation(equation);
+			blendEquation = equation;
+			issued[STATE_BLEND]++;
+		}
+	}
+
+	void SetDepthTest(bool enable)
+	{
+		SetCapability(GL_DEPTH_TEST,enable,depthTest,STATE_DEPTH);
+	}
+
+	void SetDepthWrite(bool enable)
+	{
+		const int value = enable ? 1 : 0;
+		if( depthWrite == value )
+		{
+			elided[STATE_DEPTH]++;
+			return;
+		}
+		glDepthMask(enable);
+		depthWrite = value;
+		issued[STATE_DEPTH]++;
+	}
+
+	void SetDepthFunc(GLenum func)
+	{
+		if( depthFunc == func )
+		{
+			elided[STATE_DEPTH]++;
+			return;
+		}
+		glDepthFunc(func);
+		depthFunc = func;
+		issued[STATE_DEPTH]++;
+	}
+
+	/**
+	 * @param enable If true faces are culled.
+	 * @param face GL_BACK, GL_FRONT or GL_FRONT_AND_BACK.
+	 * @param frontFace GL_CW or GL_CCW, the winding of front faces.
+	 */
+	void SetCull(bool enable,GLenum face = GL_BACK,GLenum frontFace = GL_CW)
+	{
+		SetCapability(GL_CULL_FACE,enable,cullEnabled,STATE_CULL);
+		if( !enable )
+		{
+			return;
+		}
+
+		if( cullFace == face )
+		{
+			elided[STATE_CULL]++;
+		}
+		else
+		{
+			glCullFace(face);
+			cullFace = face;
+			issued[STATE_CULL]++;
+		}
+
+		if( cullFrontFace == frontFace )
+		{
+			elided[STATE_CULL]++;
+		}
+		else
+		{
+			glFrontFace(frontFace);
+			cullFrontFace = frontFace;
+			issued[STATE_CULL]++;
+		}
+	}
+
+	/**
+	 * Uniforms belong to the program so GLShader caches them, it reports here so all the counts are in one place.
+	 * @param uploaded true if the value went to GL, false if it was skipped.
+	 */
+	void CountUniform(bool uploaded)
+	{
+		if( uploaded )
+			issued[STATE_UNIFORM]++;
+		else
+			elided[STATE_UNIFORM]++;
+	}
+
+	/**
+	 * @return The number of calls that went to GL for a type of state since the counters were reset.
+	 */
+	int getIssued(StateType type)
+	{
+		return issued[type];
+	}
+
+	/**
+	 * @return The number of calls that were skipped as the state was already set.
+	 */
+	int getElided(StateType type)
+	{
+		return elided[type];
+	}
+
+	int getTotalIssued();
+	int getTotalElided();
+
+	void ResetCounters();
+
+	/**
+	 * Prints the issued and elided counts for each type of state.
+	 */
+	void PrintCounters();
+
+	static const char* GetStateTypeName(StateType type);
+
+private:
+	GLuint currentProgram;
+	bool programKnown;
+
+	int activeUnit;				//!<-1 when not known.
+	GLuint textures[MAX_TEXTURE_UNITS];
+	bool textureKnown[MAX_TEXTURE_UNITS];
+
+	GLuint buffers[2];			//!<Array then element array.
+	bool bufferKnown[2];
+
+	uint32_t enabledAttribs;
+	uint32_t knownAttribs;		//!<Bit set for each location we know the state of.
+
+	int blendEnabled;			//!<-1 when not known, else 0 or 1. As for the other capabilities.
+	GLenum blendSrc,blendDest;
+	bool blendFuncKnown;
+	GLenum blendEquation;		//!<0 when not known, as for the other enums.
+
+	int depthTest;
+	int depthWrite;
+	GLenum depthFunc;
+
+	int cullEnabled;
+	GLenum cullFace;
+	GLenum cullFrontFace;
+
+	int issued[STATE_TYPE_COUNT];
+	int elided[STATE_TYPE_COUNT];
+
+	void SetCapability(GLenum capability,bool enable,int& current,StateType type)
+	{
+		const int value = enable ? 1 : 0;
+		if( current == value )
+		{
+			elided[type]++;
+			return;
+		}
+		if( enable )
+			glEnable(capability);
+		else
+			glDisable(capability);
+		current = value;
+		issued[type]++;
+	}
+
+	void SetVertexAttribArray(int location,bool enable)
+	{
+		const uint32_t bit = 1u << location;
+		if( location < MAX_ATTRIBS && (knownAttribs & bit) && ((enabledAttribs & bit) != 0) == enable )
+		{
+			elided[STATE_ATTRIB_ARRAY]++;
+			return;
+		}
+
+		if( enable )
+			glEnableVertexAttribArray(location);
+		else
+			glDisableVertexAttribArray(location);
+		issued[STATE_ATTRIB_ARRAY]++;
+
+		if( location < MAX_ATTRIBS )
+		{
+			enabledAttribs = enable ? (enabledAttribs | bit) : (enabledAttribs & ~bit);
+			knownAttribs |= bit;
+		}
+	}
+
+	static int PopCount(uint32_t bits)
+	{
+		int count = 0;
+		for( ; bits != 0 ; bits &= bits - 1 )
+		{
+			count++;
+		}
+		return count;
+	}
+};
+
+} /* namespace BogDog */
+#endif /* GLSTATECACHE_H_ */
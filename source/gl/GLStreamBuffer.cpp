@@ -0,0 +1,248 @@
+/*
+ * GLStreamBuffer.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "./gl/GLStreamBuffer.h"
+#include "./gl/GLResources.h"
+#include "./gl/OpenGLES20.h"
+
+#ifdef TARGET_GLES
+	#include "EGL/eglext.h"
+#endif
+
+namespace BogDog
+{
+
+#ifdef TARGET_GLES
+/**
+ * EGL_KHR_fence_sync entry points, looked up on first use. If the extension is not there they stay NULL.
+ */
+static bool fenceFunctionsFetched = false;
+static PFNEGLCREATESYNCKHRPROC CreateSync = NULL;
+static PFNEGLDESTROYSYNCKHRPROC DestroySync = NULL;
+static PFNEGLCLIENTWAITSYNCKHRPROC ClientWaitSync = NULL;
+
+static void FetchFenceFunctions()
+{
+	if( fenceFunctionsFetched )
+		return;
+	fenceFunctionsFetched = true;
+
+	EGLDisplay display = eglGetCurrentDisplay();
+	const char* extensions = display != EGL_NO_DISPLAY ? eglQueryString(display,EGL_EXTENSIONS) : NULL;
+	if( extensions == NULL || strstr(extensions,"EGL_KHR_fence_sync") == NULL || OpenGLES_2_0::HasExtension("GL_OES_EGL_sync") == false )
+	{
+		printf("GLStreamBuffer: No EGL_KHR_fence_sync, stream buffers will orphan every frame they are full\n");
+		return;
+	}
+
+	CreateSync = (PFNEGLCREATESYNCKHRPROC)eglGetProcAddress("eglCreateSyncKHR");
+	DestroySync = (PFNEGLDESTROYSYNCKHRPROC)eglGetProcAddress("eglDestroySyncKHR");
+	ClientWaitSync = (PFNEGLCLIENTWAITSYNCKHRPROC)eglGetProcAddress("eglClientWaitSyncKHR");
+	if( CreateSync == NULL || DestroySync == NULL || ClientWaitSync == NULL )
+	{
+		CreateSync = NULL;
+		DestroySync = NULL;
+		ClientWaitSync = NULL;
+	}
+}
+
+static void* CreateFence()
+{
+	FetchFenceFunctions();
+	if( CreateSync == NULL )
+		return NULL;
+
+	EGLSyncKHR sync = CreateSync(eglGetCurrentDisplay(),EGL_SYNC_FENCE_KHR,NULL);
+	return sync != EGL_NO_SYNC_KHR ? (void*)sync : NULL;
+}
+
+/**
+ * Returns true if the GPU has passed the fence, never waits.
+ */
+static bool FenceSignalled(void* fence)
+{
+	if( fence == NULL )
+		return false;
+	return ClientWaitSync(eglGetCurrentDisplay(),(EGLSyncKHR)fence,0,0) == EGL_CONDITION_SATISFIED_KHR;
+}
+
+static void DeleteFence(void* fence)
+{
+	if( fence != NULL )
+		DestroySync(eglGetCurrentDisplay(),(EGLSyncKHR)fence);
+}
+#else
+static void* CreateFence(){return NULL;}
+static bool FenceSignalled(void* fence){return false;}
+static void DeleteFence(void* fence){}
+#endif
+
+GLStreamBuffer::GLStreamBuffer(int pSize,int pTarget,int pFramesInFlight)
+{
+	size = pSize;
+	target = pTarget;
+	framesInFlight = pFramesInFlight > 0 ? pFramesInFlight : 1;
+
+	head = 0;
+	used = 0;
+	frameBytes = 0;
+	flushStart = 0;
+	frameCount = 0;
+	orphanCount = 0;
+
+	shadow = (uint8_t*)malloc(size);
+	frames = new Frame[framesInFlight];
+
+	glGenBuffers(1,&buffer);
+	CHECK_OGL_ERRORS();
+
+	if( !GLResources::Add(RESOURCE_STREAM_BUFFER,buffer,size,GL_STREAM_DRAW) )
+	{//Over budget, with no space every Allocate fails.
+		printf("GLStreamBuffer: not allocating %d bytes\n",size);
+		size = 0;
+	}
+
+	Bind();
+	glBufferData(target,size,NULL,GL_STREAM_DRAW);
+	CHECK_OGL_ERRORS();
+}
+
+GLStreamBuffer::~GLStreamBuffer()
+{
+	for( int n = 0 ; n < frameCount ; n++ )
+	{
+		DeleteFence(frames[n].fence);
+	}
+	delete []frames;
+	free(shadow);
+
+	GLResources::Remove(RESOURCE_STREAM_BUFFER,buffer);
+	OpenGLES_2_0::GetStateCache().DeleteBuffer(buffer);
+	glDeleteBuffers(1,&buffer);
+	CHECK_OGL_ERRORS();
+}
+
+void* GLStreamBuffer::Allocate(int bytes,int alignment,int& offset)
+{
+	int start = alignment > 1 ? ((head + alignment - 1) / alignment) * alignment : head;
+	int needed = (start - head) + bytes;
+
+	// Not enough room before the end of the ring, skip what is left and start again at the beginning.
+	if( start + bytes > size )
+	{
+		start = 0;
+		needed = (size - head) + bytes;
+	}
+
+	if( used + needed > size )
+	{
+		RetireFrames();
+		if( used + needed > size )
+		{
+			return NULL;
+		}
+	}
+
+	if( start < head )
+	{// Wrapped, upload what is at the end before the write position moves.
+		Flush();
+		flushStart = 0;
+	}
+
+	head = start + bytes;
+	used += needed;
+	frameBytes += needed;
+
+	offset = start;
+	return shadow + start;
+}
+
+void GLStreamBuffer::Flush()
+{
+	if( head > flushStart )
+	{
+		Bind();
+		glBufferSubData(target,flushStart,head - flushStart,shadow + flushStart);
+		CHECK_OGL_ERRORS();
+		OpenGLES_2_0::CountBufferUpload(head - flushStart);
+	}
+	flushStart = head;
+}
+
+void GLStreamBuffer::EndFrame()
+{
+	Flush();
+	RetireFrames();
+
+	if( frameCount == framesInFlight || size - used < frameBytes )
+	{// The GPU is too far behind, or we have no fences, and another frame like this one will not fit. Orphan so we don't have to wait for it.
+		Orphan();
+	}
+	else if( frameBytes > 0 )
+	{
+		frames[frameCount].bytes = frameBytes;
+		frames[frameCount].fence = CreateFence();
+		frameCount++;
+	}
+
+	frameBytes = 0;
+}
+
+void GLStreamBuffer::RetireFrames()
+{
+	int retired = 0;
+	while( retired < frameCount && FenceSignalled(frames[retired].fence) )
+	{
+		used -= frames[retired].bytes;
+		DeleteFence(frames[retired].fence);
+		retired++;
+	}
+
+	if( retired > 0 )
+	{
+		frameCount -= retired;
+		memmove(frames,frames + retired,sizeof(Frame) * frameCount);
+	}
+}
+
+void GLStreamBuffer::Orphan()
+{
+	for( int n = 0 ; n < frameCount ; n++ )
+	{
+		DeleteFence(frames[n].fence);
+	}
+	frameCount = 0;
+
+	// Gives us new storage, the driver keeps the old one until the GPU has finished drawing from it.
+	Bind();
+	glBufferData(target,size,NULL,GL_STREAM_DRAW);
+	CHECK_OGL_ERRORS();
+
+	head = 0;
+	used = 0;
+	flushStart = 0;
+	orphanCount++;
+}
+
+} /* namespace BogDog */
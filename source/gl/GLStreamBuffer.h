@@ -0,0 +1,127 @@
+/*
+ * GLStreamBuffer.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GLSTREAMBUFFER_H_
+#define GLSTREAMBUFFER_H_
+
+#include "GLHeaders.h"
+#include "OpenGLES20.h"
+
+namespace BogDog
+{
+
+/**
+ * A big GL buffer used as a ring for geometry that is rewritten every frame, particles, debug lines, UI and so on.
+ * Allocate gives you a pointer to write to and the byte offset in the buffer to draw from.
+ * The GPU is normally a frame or two behind so the ring holds framesInFlight frames of data. When the driver has
+ * EGL_KHR_fence_sync each frame gets a fence and space is reused once the GPU is done with it. If the GPU falls too far
+ * behind, or there are no fences, the buffer is orphaned at the end of the frame instead so the CPU never waits.
+ * GLES 2.0 has no buffer mapping, so writes go to a CPU copy of the ring and Flush uploads the new bytes with glBufferSubData.
+ */
+struct GLStreamBuffer
+{
+	/**
+	 * @param size The size of the ring in bytes, make it big enough for framesInFlight frames of data.
+	 * @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+	 * @param framesInFlight How many frames the GPU can be behind before the buffer is orphaned.
+	 */
+	GLStreamBuffer(int size,int target,int framesInFlight = 3);
+	~GLStreamBuffer();
+
+	// Owns the GL buffer, the shadow copy and the fences, a copy would free them twice.
+	GLStreamBuffer(const GLStreamBuffer&) = delete;
+	GLStreamBuffer& operator=(const GLStreamBuffer&) = delete;
+
+	/**
+	 * Allocates space for this frame.
+	 * The space is valid to draw from after Flush until the end of the frame.
+	 * @param bytes The number of bytes needed.
+	 * @param alignment Alignment of the offset, vertices should be four byte aligned.
+	 * @param offset Set to the byte offset in the GL buffer of the space.
+	 * @return Where to write the data, NULL if this frame has used all the space the GPU is not using.
+	 */
+	void* Allocate(int bytes,int alignment,int& offset);
+
+	/**
+	 * Uploads everything written since the last Flush. Call before drawing the new data.
+	 */
+	void Flush();
+
+	/**
+	 * Call once a frame after the last draw that uses the buffer, before OpenGLES_2_0::Update.
+	 */
+	void EndFrame();
+
+	/**
+	 * Binds the buffer to it's target.
+	 */
+	void Bind()
+	{
+		OpenGLES_2_0::GetStateCache().BindBuffer(target,buffer);
+		CHECK_OGL_ERRORS();
+	}
+
+	GLuint getBuffer()
+	{
+		return buffer;
+	}
+
+	int getSize()
+	{
+		return size;
+	}
+
+	/**
+	 * @return The number of times the buffer has been orphaned, if this keeps going up the ring is too small.
+	 */
+	int getOrphanCount()
+	{
+		return orphanCount;
+	}
+
+private:
+	struct Frame
+	{
+		int bytes;		//!<How much of the ring the frame used, including any skipped when it wrapped.
+		void* fence;	//!<EGLSyncKHR, NULL if there is no fence support.
+	};
+
+	GLuint buffer;
+	int target;
+	int size;
+	uint8_t* shadow;		//!<The CPU copy that Allocate hands out.
+
+	int head;				//!<Where the next allocation goes.
+	int used;				//!<Bytes in use by frames the GPU may not have finished with, includes this frame.
+	int frameBytes;			//!<Bytes used so far by this frame.
+	int flushStart;			//!<Start of the bytes that need uploading.
+
+	Frame* frames;			//!<Frames in flight, oldest first.
+	int frameCount;
+	int framesInFlight;
+	int orphanCount;
+
+	void RetireFrames();
+	void Orphan();
+};
+
+} /* namespace BogDog */
+#endif /* GLSTREAMBUFFER_H_ */
@@ -0,0 +1,369 @@
+/*
+ * GLTrace.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The wrappers call the real functions.
+#define BD_GL_NO_TRACE_MACROS
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "GLHeaders.h"
+#include "GLTrace.h"
+
+namespace BogDog
+{
+
+#define GLTRACE_NAME(CALL) #CALL,
+static const char* callNames[TRACE_CALL_COUNT] = { GLTRACE_CALLS(GLTRACE_NAME) };
+#undef GLTRACE_NAME
+
+static FILE* traceFile = NULL;
+static uint64_t lastStart = 0;
+
+const char* GLTrace::GetCallName(int call)
+{
+	if( call < 0 || call >= TRACE_CALL_COUNT )
+		return "unknown";
+	return callNames[call];
+}
+
+size_t GLTrace::GetImageBytes(int width,int height,uint32_t format,uint32_t type,int alignment)
+{
+	if( width <= 0 || height <= 0 )
+		return 0;
+
+	size_t pixelBytes = 1;
+	if( type == GL_UNSIGNED_SHORT_5_6_5 || type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1 )
+		pixelBytes = 2;
+	else if( format == GL_RGBA )
+		pixelBytes = 4;
+	else if( format == GL_RGB )
+		pixelBytes = 3;
+	else if( format == GL_LUMINANCE_ALPHA )
+		pixelBytes = 2;
+
+	const size_t rowBytes = width * pixelBytes;
+	const size_t pitch = alignment > 1 ? ((rowBytes + alignment - 1) / alignment) * alignment : rowBytes;
+	return (pitch * (height - 1)) + rowBytes;
+}
+
+bool GLTrace::IsRecording()
+{
+	return traceFile != NULL;
+}
+
+uint64_t GLTrace::Now()
+{
+	if( traceFile == NULL )
+		return 0;
+
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return ((uint64_t)t.tv_sec * 1000000000ull) + t.tv_nsec;
+}
+
+void GLTrace::Write(GLTraceCall call,uint64_t start,const uint32_t* args,int argCount,const void* payload,size_t payloadBytes)
+{
+	if( traceFile == NULL || start == 0 )
+		return;
+
+	const uint64_t end = Now();
+	GLTraceRecord record;
+	record.call = (uint16_t)call;
+	record.argCount = (uint8_t)argCount;
+	record.flags = 0;
+	record.payloadBytes = (uint32_t)payloadBytes;
+	record.startDelta = (start - lastStart) > 0xffffffffull ? 0xffffffff : (uint32_t)(start - lastStart);
+	record.duration = (end - start) > 0xffffffffull ? 0xffffffff : (uint32_t)(end - start);
+	lastStart = start;
+
+	fwrite(&record,sizeof(record),1,traceFile);
+	if( argCount > 0 )
+		fwrite(args,sizeof(uint32_t),argCount,traceFile);
+
+	if( payloadBytes > 0 )
+	{
+		static const uint8_t padding[4] = {0,0,0,0};
+		fwrite(payload,1,payloadBytes,traceFile);
+		if( payloadBytes&3 )
+			fwrite(padding,1,4 - (payloadBytes&3),traceFile);
+	}
+}
+
+void GLTrace::SetSurfaceSize(int width,int height)
+{
+	const uint32_t args[] = {(uint32_t)width,(uint32_t)height};
+	Write(TRACE_SurfaceSize,Now(),args,2);
+}
+
+void GLTrace::EndFrame()
+{
+	Write(TRACE_EndFrame,Now(),NULL,0);
+}
+
+void GLTrace::Stop()
+{
+	if( traceFile )
+	{
+		fclose(traceFile);
+		traceFile = NULL;
+		printf("GLTrace: stopped\n");
+	}
+}
+
+#ifdef BD_GL_TRACE
+
+bool GLTrace::Start(const char* filename)
+{
+	Stop();
+	traceFile = fopen(filename,"wb");
+	if( traceFile == NULL )
+	{
+		printf("GLTrace: failed to open %s\n",filename);
+		return false;
+	}
+
+	// Big buffer so the calls rarely wait on the disk.
+	setvbuf(traceFile,NULL,_IOFBF,1024*1024);
+
+	GLTraceHeader header;
+	memcpy(header.magic,"BDGT",4);
+	header.version = GLTRACE_VERSION;
+	fwrite(&header,sizeof(header),1,traceFile);
+	lastStart = Now();
+	printf("GLTrace: recording to %s\n",filename);
+	return true;
+}
+
+/*
+ * The wrappers. Each calls GL then writes the record, the arguments in order as 32 bit words.
+ */
+#define TRACE_ARGS(CALL,...) { const uint32_t args[] = {__VA_ARGS__}; GLTrace::Write(TRACE_##CALL,start,args,sizeof(args) / sizeof(args[0])); }
+#define TRACE_PAYLOAD(CALL,PAYLOAD,BYTES,...) { const uint32_t args[] = {__VA_ARGS__}; GLTrace::Write(TRACE_##CALL,start,args,sizeof(args) / sizeof(args[0]),PAYLOAD,BYTES); }
+
+static int unpackAlignment = 4;
+
+void Trace_glActiveTexture(GLenum texture){const uint64_t start = GLTrace::Now();glActiveTexture(texture);TRACE_ARGS(glActiveTexture,texture);}
+void Trace_glAttachShader(GLuint program,GLuint shader){const uint64_t start = GLTrace::Now();glAttachShader(program,shader);TRACE_ARGS(glAttachShader,program,shader);}
+void Trace_glBindBuffer(GLenum target,GLuint buffer){const uint64_t start = GLTrace::Now();glBindBuffer(target,buffer);TRACE_ARGS(glBindBuffer,target,buffer);}
+void Trace_glBindFramebuffer(GLenum target,GLuint framebuffer){const uint64_t start = GLTrace::Now();glBindFramebuffer(target,framebuffer);TRACE_ARGS(glBindFramebuffer,target,framebuffer);}
+void Trace_glBindRenderbuffer(GLenum target,GLuint renderbuffer){const uint64_t start = GLTrace::Now();glBindRenderbuffer(target,renderbuffer);TRACE_ARGS(glBindRenderbuffer,target,renderbuffer);}
+void Trace_glBindTexture(GLenum target,GLuint texture){const uint64_t start = GLTrace::Now();glBindTexture(target,texture);TRACE_ARGS(glBindTexture,target,texture);}
+void Trace_glBlendEquation(GLenum mode){const uint64_t start = GLTrace::Now();glBlendEquation(mode);TRACE_ARGS(glBlendEquation,mode);}
+void Trace_glBlendFunc(GLenum sfactor,GLenum dfactor){const uint64_t start = GLTrace::Now();glBlendFunc(sfactor,dfactor);TRACE_ARGS(glBlendFunc,sfactor,dfactor);}
+void Trace_glClear(GLbitfield mask){const uint64_t start = GLTrace::Now();glClear(mask);TRACE_ARGS(glClear,mask);}
+void Trace_glColorMask(GLboolean red,GLboolean green,GLboolean blue,GLboolean alpha){const uint64_t start = GLTrace::Now();glColorMask(red,green,blue,alpha);TRACE_ARGS(glColorMask,red,green,blue,alpha);}
+void Trace_glCompileShader(GLuint shader){const uint64_t start = GLTrace::Now();glCompileShader(shader);TRACE_ARGS(glCompileShader,shader);}
+void Trace_glCullFace(GLenum mode){const uint64_t start = GLTrace::Now();glCullFace(mode);TRACE_ARGS(glCullFace,mode);}
+void Trace_glDeleteProgram(GLuint program){const uint64_t start = GLTrace::Now();glDeleteProgram(program);TRACE_ARGS(glDeleteProgram,program);}
+void Trace_glDeleteShader(GLuint shader){const uint64_t start = GLTrace::Now();glDeleteShader(shader);TRACE_ARGS(glDeleteShader,shader);}
+void Trace_glDepthFunc(GLenum func){const uint64_t start = GLTrace::Now();glDepthFunc(func);TRACE_ARGS(glDepthFunc,func);}
+void Trace_glDepthMask(GLboolean flag){const uint64_t start = GLTrace::Now();glDepthMask(flag);TRACE_ARGS(glDepthMask,flag);}
+void Trace_glDisable(GLenum cap){const uint64_t start = GLTrace::Now();glDisable(cap);TRACE_ARGS(glDisable,cap);}
+void Trace_glDisableVertexAttribArray(GLuint index){const uint64_t start = GLTrace::Now();glDisableVertexAttribArray(index);TRACE_ARGS(glDisableVertexAttribArray,index);}
+void Trace_glDrawArrays(GLenum mode,GLint first,GLsizei count){const uint64_t start = GLTrace::Now();glDrawArrays(mode,first,count);TRACE_ARGS(glDrawArrays,mode,(uint32_t)first,(uint32_t)count);}
+void Trace_glDrawElements(GLenum mode,GLsizei count,GLenum type,const void* indices){const uint64_t start = GLTrace::Now();glDrawElements(mode,count,type,indices);TRACE_ARGS(glDrawElements,mode,(uint32_t)count,type,(uint32_t)(size_t)indices);}
+void Trace_glEnable(GLenum cap){const uint64_t start = GLTrace::Now();glEnable(cap);TRACE_ARGS(glEnable,cap);}
+void Trace_glEnableVertexAttribArray(GLuint index){const uint64_t start = GLTrace::Now();glEnableVertexAttribArray(index);TRACE_ARGS(glEnableVertexAttribArray,index);}
+void Trace_glFramebufferRenderbuffer(GLenum target,GLenum attachment,GLenum renderbuffertarget,GLuint renderbuffer){const uint64_t start = GLTrace::Now();glFramebufferRenderbuffer(target,attachment,renderbuffertarget,renderbuffer);TRACE_ARGS(glFramebufferRenderbuffer,target,attachment,renderbuffertarget,renderbuffer);}
+void Trace_glFramebufferTexture2D(GLenum target,GLenum attachment,GLenum textarget,GLuint texture,GLint level){const uint64_t start = GLTrace::Now();glFramebufferTexture2D(target,attachment,textarget,texture,level);TRACE_ARGS(glFramebufferTexture2D,target,attachment,textarget,texture,(uint32_t)level);}
+void Trace_glFrontFace(GLenum mode){const uint64_t start = GLTrace::Now();glFrontFace(mode);TRACE_ARGS(glFrontFace,mode);}
+void Trace_glGenerateMipmap(GLenum target){const uint64_t start = GLTrace::Now();glGenerateMipmap(target);TRACE_ARGS(glGenerateMipmap,target);}
+void Trace_glLinkProgram(GLuint program){const uint64_t start = GLTrace::Now();glLinkProgram(program);TRACE_ARGS(glLinkProgram,program);}
+void Trace_glReadPixels(GLint x,GLint y,GLsizei width,GLsizei height,GLenum format,GLenum type,void* pixels){const uint64_t start = GLTrace::Now();glReadPixels(x,y,width,height,format,type,pixels);TRACE_ARGS(glReadPixels,(uint32_t)x,(uint32_t)y,(uint32_t)width,(uint32_t)height,format,type);}
+void Trace_glRenderbufferStorage(GLenum target,GLenum internalformat,GLsizei width,GLsizei height){const uint64_t start = GLTrace::Now();glRenderbufferStorage(target,internalformat,width,height);TRACE_ARGS(glRenderbufferStorage,target,internalformat,(uint32_t)width,(uint32_t)height);}
+void Trace_glTexParameteri(GLenum target,GLenum pname,GLint param){const uint64_t start = GLTrace::Now();glTexParameteri(target,pname,param);TRACE_ARGS(glTexParameteri,target,pname,(uint32_t)param);}
+void Trace_glUniform1i(GLint location,GLint v0){const uint64_t start = GLTrace::Now();glUniform1i(location,v0);TRACE_ARGS(glUniform1i,(uint32_t)location,(uint32_t)v0);}
+void Trace_glUseProgram(GLuint program){const uint64_t start = GLTrace::Now();glUseProgram(program);TRACE_ARGS(glUseProgram,program);}
+void Trace_glVertexAttribPointer(GLuint index,GLint size,GLenum type,GLboolean normalized,GLsizei stride,const void* pointer){const uint64_t start = GLTrace::Now();glVertexAttribPointer(index,size,type,normalized,stride,pointer);TRACE_ARGS(glVertexAttribPointer,index,(uint32_t)size,type,normalized,(uint32_t)stride,(uint32_t)(size_t)pointer);}
+void Trace_glViewport(GLint x,GLint y,GLsizei width,GLsizei height){const uint64_t start = GLTrace::Now();glViewport(x,y,width,height);TRACE_ARGS(glViewport,(uint32_t)x,(uint32_t)y,(uint32_t)width,(uint32_t)height);}
+
+void Trace_glClearColor(GLfloat red,GLfloat green,GLfloat blue,GLfloat alpha)
+{
+	const uint64_t start = GLTrace::Now();
+	glClearColor(red,green,blue,alpha);
+	TRACE_ARGS(glClearColor,GLTrace::FloatBits(red),GLTrace::FloatBits(green),GLTrace::FloatBits(blue),GLTrace::FloatBits(alpha));
+}
+
+void Trace_glDepthRangef(GLfloat n,GLfloat f)
+{
+	const uint64_t start = GLTrace::Now();
+	glDepthRangef(n,f);
+	TRACE_ARGS(glDepthRangef,GLTrace::FloatBits(n),GLTrace::FloatBits(f));
+}
+
+void Trace_glFinish(void)
+{
+	const uint64_t start = GLTrace::Now();
+	glFinish();
+	GLTrace::Write(TRACE_glFinish,start,NULL,0);
+}
+
+void Trace_glFlush(void)
+{
+	const uint64_t start = GLTrace::Now();
+	glFlush();
+	GLTrace::Write(TRACE_glFlush,start,NULL,0);
+}
+
+void Trace_glPixelStorei(GLenum pname,GLint param)
+{
+	const uint64_t start = GLTrace::Now();
+	glPixelStorei(pname,param);
+	if( pname == GL_UNPACK_ALIGNMENT )
+		unpackAlignment = param;
+	TRACE_ARGS(glPixelStorei,pname,(uint32_t)param);
+}
+
+/*
+ * Calls that make names, the names are the payload so the replay can map them to the ones it gets.
+ */
+void Trace_glGenBuffers(GLsizei n,GLuint* buffers){const uint64_t start = GLTrace::Now();glGenBuffers(n,buffers);TRACE_PAYLOAD(glGenBuffers,buffers,n * sizeof(GLuint),(uint32_t)n);}
+void Trace_glGenFramebuffers(GLsizei n,GLuint* framebuffers){const uint64_t start = GLTrace::Now();glGenFramebuffers(n,framebuffers);TRACE_PAYLOAD(glGenFramebuffers,framebuffers,n * sizeof(GLuint),(uint32_t)n);}
+void Trace_glGenRenderbuffers(GLsizei n,GLuint* renderbuffers){const uint64_t start = GLTrace::Now();glGenRenderbuffers(n,renderbuffers);TRACE_PAYLOAD(glGenRenderbuffers,renderbuffers,n * sizeof(GLuint),(uint32_t)n);}
+void Trace_glGenTextures(GLsizei n,GLuint* textures){const uint64_t start = GLTrace::Now();glGenTextures(n,textures);TRACE_PAYLOAD(glGenTextures,textures,n * sizeof(GLuint),(uint32_t)n);}
+void Trace_glDeleteBuffers(GLsizei n,const GLuint* buffers){const uint64_t start = GLTrace::Now();glDeleteBuffers(n,buffers);TRACE_PAYLOAD(glDeleteBuffers,buffers,n * sizeof(GLuint),(uint32_t)n);}
+void Trace_glDeleteFramebuffers(GLsizei n,const GLuint* framebuffers){const uint64_t start = GLTrace::Now();glDeleteFramebuffers(n,framebuffers);TRACE_PAYLOAD(glDeleteFramebuffers,framebuffers,n * sizeof(GLuint),(uint32_t)n);}
+void Trace_glDeleteRenderbuffers(GLsizei n,const GLuint* renderbuffers){const uint64_t start = GLTrace::Now();glDeleteRenderbuffers(n,renderbuffers);TRACE_PAYLOAD(glDeleteRenderbuffers,renderbuffers,n * sizeof(GLuint),(uint32_t)n);}
+void Trace_glDeleteTextures(GLsizei n,const GLuint* textures){const uint64_t start = GLTrace::Now();glDeleteTextures(n,textures);TRACE_PAYLOAD(glDeleteTextures,textures,n * sizeof(GLuint),(uint32_t)n);}
+
+GLuint Trace_glCreateProgram(void)
+{
+	const uint64_t start = GLTrace::Now();
+	const GLuint program = glCreateProgram();
+	TRACE_ARGS(glCreateProgram,program);
+	return program;
+}
+
+GLuint Trace_glCreateShader(GLenum type)
+{
+	const uint64_t start = GLTrace::Now();
+	const GLuint shader = glCreateShader(type);
+	TRACE_ARGS(glCreateShader,type,shader);
+	return shader;
+}
+
+GLint Trace_glGetUniformLocation(GLuint program,const GLchar* name)
+{
+	const uint64_t start = GLTrace::Now();
+	const GLint location = glGetUniformLocation(program,name);
+	TRACE_PAYLOAD(glGetUniformLocation,name,strlen(name) + 1,program,(uint32_t)location);
+	return location;
+}
+
+void Trace_glBindAttribLocation(GLuint program,GLuint index,const GLchar* name)
+{
+	const uint64_t start = GLTrace::Now();
+	glBindAttribLocation(program,index,name);
+	TRACE_PAYLOAD(glBindAttribLocation,name,strlen(name) + 1,program,index);
+}
+
+/*
+ * Calls that hand data to GL, the data is the payload.
+ */
+void Trace_glShaderSource(GLuint shader,GLsizei count,const GLchar* const* string,const GLint* length)
+{
+	const uint64_t start = GLTrace::Now();
+	glShaderSource(shader,count,string,length);
+	if( start == 0 )
+		return;
+
+	// Joined into one string.
+	size_t total = 0;
+	for( GLsizei n = 0 ; n < count ; n++ )
+		total += (length && length[n] >= 0) ? length[n] : strlen(string[n]);
+
+	char* source = new char[total + 1];
+	char* dest = source;
+	for( GLsizei n = 0 ; n < count ; n++ )
+	{
+		const size_t bytes = (length && length[n] >= 0) ? length[n] : strlen(string[n]);
+		memcpy(dest,string[n],bytes);
+		dest += bytes;
+	}
+	*dest = 0;
+	TRACE_PAYLOAD(glShaderSource,source,total + 1,shader);
+	delete []source;
+}
+
+void Trace_glBufferData(GLenum target,GLsizeiptr size,const void* data,GLenum usage)
+{
+	const uint64_t start = GLTrace::Now();
+	glBufferData(target,size,data,usage);
+	TRACE_PAYLOAD(glBufferData,data,data ? size : 0,target,(uint32_t)size,usage,data ? 1u : 0u);
+}
+
+void Trace_glBufferSubData(GLenum target,GLintptr offset,GLsizeiptr size,const void* data)
+{
+	const uint64_t start = GLTrace::Now();
+	glBufferSubData(target,offset,size,data);
+	TRACE_PAYLOAD(glBufferSubData,data,size,target,(uint32_t)offset,(uint32_t)size);
+}
+
+void Trace_glTexImage2D(GLenum target,GLint level,GLint internalformat,GLsizei width,GLsizei height,GLint border,GLenum format,GLenum type,const void* pixels)
+{
+	const uint64_t start = GLTrace::Now();
+	glTexImage2D(target,level,internalformat,width,height,border,format,type,pixels);
+	const size_t bytes = pixels ? GLTrace::GetImageBytes(width,height,format,type,unpackAlignment) : 0;
+	TRACE_PAYLOAD(glTexImage2D,pixels,bytes,target,(uint32_t)level,(uint32_t)internalformat,(uint32_t)width,(uint32_t)height,(uint32_t)border,format,type);
+}
+
+void Trace_glTexSubImage2D(GLenum target,GLint level,GLint xoffset,GLint yoffset,GLsizei width,GLsizei height,GLenum format,GLenum type,const void* pixels)
+{
+	const uint64_t start = GLTrace::Now();
+	glTexSubImage2D(target,level,xoffset,yoffset,width,height,format,type,pixels);
+	const size_t bytes = GLTrace::GetImageBytes(width,height,format,type,unpackAlignment);
+	TRACE_PAYLOAD(glTexSubImage2D,pixels,bytes,target,(uint32_t)level,(uint32_t)xoffset,(uint32_t)yoffset,(uint32_t)width,(uint32_t)height,format,type);
+}
+
+void Trace_glUniform4fv(GLint location,GLsizei count,const GLfloat* value)
+{
+	const uint64_t start = GLTrace::Now();
+	glUniform4fv(location,count,value);
+	TRACE_PAYLOAD(glUniform4fv,value,count * 4 * sizeof(GLfloat),(uint32_t)location,(uint32_t)count);
+}
+
+void Trace_glUniformMatrix4fv(GLint location,GLsizei count,GLboolean transpose,const GLfloat* value)
+{
+	const uint64_t start = GLTrace::Now();
+	glUniformMatrix4fv(location,count,transpose,value);
+	TRACE_PAYLOAD(glUniformMatrix4fv,value,count * 16 * sizeof(GLfloat),(uint32_t)location,(uint32_t)count,transpose);
+}
+
+EGLBoolean Trace_eglSwapBuffers(EGLDisplay dpy,EGLSurface surface)
+{
+	const uint64_t start = GLTrace::Now();
+	const EGLBoolean result = eglSwapBuffers(dpy,surface);
+	GLTrace::Write(TRACE_eglSwapBuffers,start,NULL,0);
+	return result;
+}
+
+#else
+
+bool GLTrace::Start(const char* filename)
+{
+	printf("GLTrace: built without BD_GL_TRACE, can't record %s\n",filename);
+	return false;
+}
+
+#endif //#ifdef BD_GL_TRACE
+
+} /* namespace BogDog */
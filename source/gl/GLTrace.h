@@ -0,0 +1,254 @@
+/*
+ * GLTrace.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GLTRACE_H_
+#define GLTRACE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace BogDog
+{
+
+/*
+ * The calls that are recorded, every other GL call goes straight to the driver.
+ * Queries, glGet* and so on, are not recorded as the replay asks the driver for itself.
+ * Only add to the end, the position is the id in the file.
+ */
+#define GLTRACE_CALLS(F) \
+	F(glActiveTexture) F(glAttachShader) F(glBindAttribLocation) F(glBindBuffer) F(glBindFramebuffer) F(glBindRenderbuffer) \
+	F(glBindTexture) F(glBlendEquation) F(glBlendFunc) F(glBufferData) F(glBufferSubData) F(glClear) F(glClearColor) \
+	F(glColorMask) F(glCompileShader) F(glCreateProgram) F(glCreateShader) F(glCullFace) F(glDeleteBuffers) \
+	F(glDeleteFramebuffers) F(glDeleteProgram) F(glDeleteRenderbuffers) F(glDeleteShader) F(glDeleteTextures) F(glDepthFunc) \
+	F(glDepthMask) F(glDepthRangef) F(glDisable) F(glDisableVertexAttribArray) F(glDrawArrays) F(glDrawElements) F(glEnable) \
+	F(glEnableVertexAttribArray) F(glFinish) F(glFlush) F(glFramebufferRenderbuffer) F(glFramebufferTexture2D) F(glFrontFace) \
+	F(glGenBuffers) F(glGenFramebuffers) F(glGenRenderbuffers) F(glGenTextures) F(glGenerateMipmap) F(glGetUniformLocation) \
+	F(glLinkProgram) F(glPixelStorei) F(glReadPixels) F(glRenderbufferStorage) F(glShaderSource) F(glTexImage2D) \
+	F(glTexParameteri) F(glTexSubImage2D) F(glUniform1i) F(glUniform4fv) F(glUniformMatrix4fv) F(glUseProgram) \
+	F(glVertexAttribPointer) F(glViewport) F(eglSwapBuffers) F(SurfaceSize) F(EndFrame)
+
+#define GLTRACE_ENUM(CALL) TRACE_##CALL,
+
+enum GLTraceCall
+{
+	GLTRACE_CALLS(GLTRACE_ENUM)
+	TRACE_CALL_COUNT
+};
+
+#undef GLTRACE_ENUM
+
+/**
+ * The file starts with this, then the records follow to the end of the file.
+ */
+struct GLTraceHeader
+{
+	char magic[4];		//!<"BDGT"
+	uint32_t version;
+};
+
+/**
+ * Every call is this then argCount 32 bit arguments then payloadBytes of payload padded to 4 bytes.
+ * Arguments are the call's arguments in order, floats as their bits, pointers into buffers as offsets, the names
+ * made by glGen* and glCreate* are in the payload or the last argument.
+ * The payload is the data handed to GL, buffer and texture contents, uniform values and strings.
+ */
+struct GLTraceRecord
+{
+	uint16_t call;			//!<GLTraceCall
+	uint8_t argCount;
+	uint8_t flags;
+	uint32_t payloadBytes;
+	uint32_t startDelta;	//!<Nanoseconds since the previous call started.
+	uint32_t duration;		//!<Nanoseconds the driver took to return, the CPU cost of the call.
+};
+
+static const uint32_t GLTRACE_VERSION = 1;
+
+/**
+ * Records the GL calls the engine makes to a file that tools/bdreplay can play back on any GL context, headless too.
+ * Build with BD_GL_TRACE defined and the GL calls in the engine go through the recorder, without it Start fails and
+ * there is no cost. Start before OpenGLES_2_0::Create so the trace has every object the frames use.
+ * The calls must come from one thread at a time, which is the case when only the thread owning the context draws.
+ */
+struct GLTrace
+{
+	/**
+	 * Starts recording to a file, replacing it.
+	 * @return false if the file can't be made or the engine was built without BD_GL_TRACE.
+	 */
+	static bool Start(const char* filename);
+
+	/**
+	 * Stops recording and closes the file.
+	 */
+	static void Stop();
+
+	static bool IsRecording();
+
+	/**
+	 * Records the size of the surface being drawn to, OpenGLES_2_0 does this when it is created.
+	 */
+	static void SetSurfaceSize(int width,int height);
+
+	/**
+	 * Marks the end of a frame, OpenGLES_2_0::Update does this, headless or not.
+	 */
+	static void EndFrame();
+
+	/**
+	 * Adds a record, used by the wrappers. Does nothing when not recording.
+	 * @param start The time the call started, from Now.
+	 */
+	static void Write(GLTraceCall call,uint64_t start,const uint32_t* args,int argCount,const void* payload = NULL,size_t payloadBytes = 0);
+
+	/**
+	 * @return Nanoseconds on the monotonic clock, 0 when not recording so the untraced path does not read the clock.
+	 */
+	static uint64_t Now();
+
+	static const char* GetCallName(int call);
+
+	/**
+	 * @return The bytes glTexImage2D and friends read for an image, following the unpack alignment.
+	 */
+	static size_t GetImageBytes(int width,int height,uint32_t format,uint32_t type,int alignment);
+
+	/**
+	 * Bit cast of a float to store in an argument.
+	 */
+	static uint32_t FloatBits(float value)
+	{
+		union { float f; uint32_t u; } bits;
+		bits.f = value;
+		return bits.u;
+	}
+
+	static float BitsFloat(uint32_t value)
+	{
+		union { float f; uint32_t u; } bits;
+		bits.u = value;
+		return bits.f;
+	}
+};
+
+} /* namespace BogDog */
+
+/*
+ * With BD_GL_TRACE the engine's calls to the recorded functions go to wrappers that call GL then write the record.
+ * GLTrace.cpp and NullGL.cpp define BD_GL_NO_TRACE_MACROS as they need the real names.
+ */
+#if defined(BD_GL_TRACE) && !defined(BD_GL_NO_TRACE_MACROS)
+
+#include "GLHeaders.h"
+
+#define GLTRACE_DECLARE(CALL) extern decltype(::CALL) Trace_##CALL;
+
+namespace BogDog
+{
+	GLTRACE_DECLARE(glActiveTexture) GLTRACE_DECLARE(glAttachShader) GLTRACE_DECLARE(glBindAttribLocation)
+	GLTRACE_DECLARE(glBindBuffer) GLTRACE_DECLARE(glBindFramebuffer) GLTRACE_DECLARE(glBindRenderbuffer)
+	GLTRACE_DECLARE(glBindTexture) GLTRACE_DECLARE(glBlendEquation) GLTRACE_DECLARE(glBlendFunc)
+	GLTRACE_DECLARE(glBufferData) GLTRACE_DECLARE(glBufferSubData) GLTRACE_DECLARE(glClear)
+	GLTRACE_DECLARE(glClearColor) GLTRACE_DECLARE(glColorMask) GLTRACE_DECLARE(glCompileShader)
+	GLTRACE_DECLARE(glCreateProgram) GLTRACE_DECLARE(glCreateShader) GLTRACE_DECLARE(glCullFace)
+	GLTRACE_DECLARE(glDeleteBuffers) GLTRACE_DECLARE(glDeleteFramebuffers) GLTRACE_DECLARE(glDeleteProgram)
+	GLTRACE_DECLARE(glDeleteRenderbuffers) GLTRACE_DECLARE(glDeleteShader) GLTRACE_DECLARE(glDeleteTextures)
+	GLTRACE_DECLARE(glDepthFunc) GLTRACE_DECLARE(glDepthMask) GLTRACE_DECLARE(glDepthRangef)
+	GLTRACE_DECLARE(glDisable) GLTRACE_DECLARE(glDisableVertexAttribArray) GLTRACE_DECLARE(glDrawArrays)
+	GLTRACE_DECLARE(glDrawElements) GLTRACE_DECLARE(glEnable) GLTRACE_DECLARE(glEnableVertexAttribArray)
+	GLTRACE_DECLARE(glFinish) GLTRACE_DECLARE(glFlush) GLTRACE_DECLARE(glFramebufferRenderbuffer)
+	GLTRACE_DECLARE(glFramebufferTexture2D) GLTRACE_DECLARE(glFrontFace) GLTRACE_DECLARE(glGenBuffers)
+	GLTRACE_DECLARE(glGenFramebuffers) GLTRACE_DECLARE(glGenRenderbuffers) GLTRACE_DECLARE(glGenTextures)
+	GLTRACE_DECLARE(glGenerateMipmap) GLTRACE_DECLARE(glGetUniformLocation) GLTRACE_DECLARE(glLinkProgram)
+	GLTRACE_DECLARE(glPixelStorei) GLTRACE_DECLARE(glReadPixels) GLTRACE_DECLARE(glRenderbufferStorage)
+	GLTRACE_DECLARE(glShaderSource) GLTRACE_DECLARE(glTexImage2D) GLTRACE_DECLARE(glTexParameteri)
+	GLTRACE_DECLARE(glTexSubImage2D) GLTRACE_DECLARE(glUniform1i) GLTRACE_DECLARE(glUniform4fv)
+	GLTRACE_DECLARE(glUniformMatrix4fv) GLTRACE_DECLARE(glUseProgram) GLTRACE_DECLARE(glVertexAttribPointer)
+	GLTRACE_DECLARE(glViewport) GLTRACE_DECLARE(eglSwapBuffers)
+};
+
+#undef GLTRACE_DECLARE
+
+#define GLTRACE_REDIRECT(CALL) BogDog::Trace_##CALL
+
+#define glActiveTexture GLTRACE_REDIRECT(glActiveTexture)
+#define glAttachShader GLTRACE_REDIRECT(glAttachShader)
+#define glBindAttribLocation GLTRACE_REDIRECT(glBindAttribLocation)
+#define glBindBuffer GLTRACE_REDIRECT(glBindBuffer)
+#define glBindFramebuffer GLTRACE_REDIRECT(glBindFramebuffer)
+#define glBindRenderbuffer GLTRACE_REDIRECT(glBindRenderbuffer)
+#define glBindTexture GLTRACE_REDIRECT(glBindTexture)
+#define glBlendEquation GLTRACE_REDIRECT(glBlendEquation)
+#define glBlendFunc GLTRACE_REDIRECT(glBlendFunc)
+#define glBufferData GLTRACE_REDIRECT(glBufferData)
+#define glBufferSubData GLTRACE_REDIRECT(glBufferSubData)
+#define glClear GLTRACE_REDIRECT(glClear)
+#define glClearColor GLTRACE_REDIRECT(glClearColor)
+#define glColorMask GLTRACE_REDIRECT(glColorMask)
+#define glCompileShader GLTRACE_REDIRECT(glCompileShader)
+#define glCreateProgram GLTRACE_REDIRECT(glCreateProgram)
+#define glCreateShader GLTRACE_REDIRECT(glCreateShader)
+#define glCullFace GLTRACE_REDIRECT(glCullFace)
+#define glDeleteBuffers GLTRACE_REDIRECT(glDeleteBuffers)
+#define glDeleteFramebuffers GLTRACE_REDIRECT(glDeleteFramebuffers)
+#define glDeleteProgram GLTRACE_REDIRECT(glDeleteProgram)
+#define glDeleteRenderbuffers GLTRACE_REDIRECT(glDeleteRenderbuffers)
+#define glDeleteShader GLTRACE_REDIRECT(glDeleteShader)
+#define glDeleteTextures GLTRACE_REDIRECT(glDeleteTextures)
+#define glDepthFunc GLTRACE_REDIRECT(glDepthFunc)
+#define glDepthMask GLTRACE_REDIRECT(glDepthMask)
+#define glDepthRangef GLTRACE_REDIRECT(glDepthRangef)
+#define glDisable GLTRACE_REDIRECT(glDisable)
+#define glDisableVertexAttribArray GLTRACE_REDIRECT(glDisableVertexAttribArray)
+#define glDrawArrays GLTRACE_REDIRECT(glDrawArrays)
+#define glDrawElements GLTRACE_REDIRECT(glDrawElements)
+#define glEnable GLTRACE_REDIRECT(glEnable)
+#define glEnableVertexAttribArray GLTRACE_REDIRECT(glEnableVertexAttribArray)
+#define glFinish GLTRACE_REDIRECT(glFinish)
+#define glFlush GLTRACE_REDIRECT(glFlush)
+#define glFramebufferRenderbuffer GLTRACE_REDIRECT(glFramebufferRenderbuffer)
+#define glFramebufferTexture2D GLTRACE_REDIRECT(glFramebufferTexture2D)
+#define glFrontFace GLTRACE_REDIRECT(glFrontFace)
+#define glGenBuffers GLTRACE_REDIRECT(glGenBuffers)
+#define glGenFramebuffers GLTRACE_REDIRECT(glGenFramebuffers)
+#define glGenRenderbuffers GLTRACE_REDIRECT(glGenRenderbuffers)
+#define glGenTextures GLTRACE_REDIRECT(glGenTextures)
+#define glGenerateMipmap GLTRACE_REDIRECT(glGenerateMipmap)
+#define glGetUniformLocation GLTRACE_REDIRECT(glGetUniformLocation)
+#define glLinkProgram GLTRACE_REDIRECT(glLinkProgram)
+#define glPixelStorei GLTRACE_REDIRECT(glPixelStorei)
+#define glReadPixels GLTRACE_REDIRECT(glReadPixels)
+#define glRenderbufferStorage GLTRACE_REDIRECT(glRenderbufferStorage)
+#define glShaderSource GLTRACE_REDIRECT(glShaderSource)
+#define glTexImage2D GLTRACE_REDIRECT(glTexImage2D)
+#define glTexParameteri GLTRACE_REDIRECT(glTexParameteri)
+#define glTexSubImage2D GLTRACE_REDIRECT(glTexSubImage2D)
+#define glUniform1i GLTRACE_REDIRECT(glUniform1i)
+#define glUniform4fv GLTRACE_REDIRECT(glUniform4fv)
+#define glUniformMatrix4fv GLTRACE_REDIRECT(glUniformMatrix4fv)
+#define glUseProgram GLTRACE_REDIRECT(glUseProgram)
+#define glVertexAttribPointer GLTRACE_REDIRECT(glVertexAttribPointer)
+#define glViewport GLTRACE_REDIRECT(glViewport)
+#define eglSwapBuffers GLTRACE_REDIRECT(eglSwapBuffers)
+
+#endif //#if defined(BD_GL_TRACE) && !defined(BD_GL_NO_TRACE_MACROS)
+
+#endif /* GLTRACE_H_ */
@@ -0,0 +1,785 @@
+/*
+ * NullGL.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef PLATFORM_NULL
+
+// These are the real functions, not the GLTrace wrappers.
+#define BD_GL_NO_TRACE_MACROS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "NullGL.h"
+#include "DynamicBuffer.h"
+
+namespace BogDog
+{
+
+#define NULLGL_FUNCTIONS(F) \
+	F(glActiveTexture) F(glAttachShader) F(glBindAttribLocation) F(glBindBuffer) F(glBindFramebuffer) F(glBindRenderbuffer) \
+	F(glBindTexture) F(glBlendEquation) F(glBlendFunc) F(glBufferData) F(glBufferSubData) F(glCheckFramebufferStatus) \
+	F(glClear) F(glClearColor) F(glColorMask) F(glCompileShader) F(glCreateProgram) F(glCreateShader) F(glCullFace) \
+	F(glDeleteBuffers) F(glDeleteFramebuffers) F(glDeleteProgram) F(glDeleteRenderbuffers) F(glDeleteShader) F(glDeleteTextures) \
+	F(glDepthFunc) F(glDepthMask) F(glDepthRangef) F(glDisable) F(glDisableVertexAttribArray) F(glDrawArrays) F(glDrawElements) \
+	F(glEnable) F(glEnableVertexAttribArray) F(glFinish) F(glFlush) F(glFramebufferRenderbuffer) F(glFramebufferTexture2D) \
+	F(glFrontFace) F(glGenBuffers) F(glGenFramebuffers) F(glGenRenderbuffers) F(glGenTextures) F(glGenerateMipmap) \
+	F(glGetActiveUniform) F(glGetAttribLocation) F(glGetError) F(glGetIntegerv) F(glGetProgramInfoLog) F(glGetProgramiv) \
+	F(glGetShaderInfoLog) F(glGetShaderiv) F(glGetString) F(glGetUniformLocation) F(glLinkProgram) F(glPixelStorei) \
+	F(glReadPixels) F(glRenderbufferStorage) F(glShaderSource) F(glTexImage2D) F(glTexParameteri) F(glTexSubImage2D) \
+	F(glUniform1i) F(glUniform4fv) F(glUniformMatrix4fv) F(glUseProgram) F(glVertexAttribPointer) F(glViewport) \
+	F(eglBindAPI) F(eglChooseConfig) F(eglCreateContext) F(eglCreatePbufferSurface) F(eglCreateWindowSurface) \
+	F(eglGetConfigAttrib) F(eglGetConfigs) F(eglGetCurrentDisplay) F(eglGetDisplay) F(eglGetError) F(eglGetPlatformDisplayEXT) \
+	F(eglGetProcAddress) F(eglInitialize) F(eglMakeCurrent) F(eglQueryString) F(eglQuerySurface) F(eglSwapBuffers) F(eglSwapInterval)
+
+#define NULLGL_ENUM(FUNCTION) CALL_##FUNCTION,
+#define NULLGL_NAME(FUNCTION) #FUNCTION,
+
+enum NullGLCall
+{
+	NULLGL_FUNCTIONS(NULLGL_ENUM)
+	CALL_COUNT
+};
+
+static const char* callNames[CALL_COUNT] = { NULLGL_FUNCTIONS(NULLGL_NAME) };
+
+static NullGL::Stats stats;
+static uint64_t callCounts[CALL_COUNT];
+
+#define NULLGL_COUNT(FUNCTION) { stats.calls++; callCounts[CALL_##FUNCTION]++; }
+
+static const int NULL_WINDOW_WIDTH = 1280;
+static const int NULL_WINDOW_HEIGHT = 720;
+static const int MAX_PROGRAM_UNIFORMS = 32;
+
+struct NullShader
+{
+	GLuint name;
+	char* source;
+};
+
+struct NullUniform
+{
+	char name[32];
+	GLenum type;
+	GLint size;
+	GLint location;
+};
+
+struct NullProgram
+{
+	GLuint name;
+	GLuint shaders[2];
+	int uniformCount;
+	NullUniform uniforms[MAX_PROGRAM_UNIFORMS];
+};
+
+static GLuint nextName = 1;
+static DynamicBuffer<NullShader,16,16> shaders;
+static DynamicBuffer<NullProgram,16,16> programs;
+static GLsizei pbufferWidth = 1,pbufferHeight = 1;
+
+const NullGL::Stats& NullGL::GetStats()
+{
+	return stats;
+}
+
+uint64_t NullGL::GetCallCount(const char* function)
+{
+	for( int n = 0 ; n < CALL_COUNT ; n++ )
+	{
+		if( strcmp(callNames[n],function) == 0 )
+			return callCounts[n];
+	}
+	return 0;
+}
+
+void NullGL::ResetStats()
+{
+	memset(&stats,0,sizeof(stats));
+	memset(callCounts,0,sizeof(callCounts));
+}
+
+void NullGL::PrintReport()
+{
+	printf("Null GL: %llu calls, %llu frames\n",(unsigned long long)stats.calls,(unsigned long long)stats.frames);
+	printf("  Draws %llu, vertices %llu, triangles %llu\n",(unsigned long long)stats.drawCalls,(unsigned long long)stats.vertices,(unsigned long long)stats.triangles);
+	printf("  Uniforms %llu calls %llu KB\n",(unsigned long long)stats.uniformCalls,(unsigned long long)(stats.uniformBytes / 1024));
+	printf("  Buffers %llu KB, textures %llu KB, read back %llu KB\n",
+			(unsigned long long)(stats.bufferBytes / 1024),(unsigned long long)(stats.textureBytes / 1024),(unsigned long long)(stats.readBytes / 1024));
+	for( int n = 0 ; n < CALL_COUNT ; n++ )
+	{
+		if( callCounts[n] > 0 )
+			printf("  %-28s %10llu\n",callNames[n],(unsigned long long)callCounts[n]);
+	}
+}
+
+static NullShader* FindShader(GLuint name)
+{
+	for( size_t n = 0 ; n < shaders.GetSize() ; n++ )
+	{
+		if( shaders[n].name == name )
+			return &shaders[n];
+	}
+	return NULL;
+}
+
+static NullProgram* FindProgram(GLuint name)
+{
+	for( size_t n = 0 ; n < programs.GetSize() ; n++ )
+	{
+		if( programs[n].name == name )
+			return &programs[n];
+	}
+	return NULL;
+}
+
+static GLenum GetUniformType(const char* type)
+{
+	static const struct { const char* name; GLenum type; } types[] =
+	{
+		{"float",GL_FLOAT},{"vec2",GL_FLOAT_VEC2},{"vec3",GL_FLOAT_VEC3},{"vec4",GL_FLOAT_VEC4},
+		{"int",GL_INT},{"ivec2",GL_INT_VEC2},{"ivec3",GL_INT_VEC3},{"ivec4",GL_INT_VEC4},{"bool",GL_BOOL},
+		{"mat2",GL_FLOAT_MAT2},{"mat3",GL_FLOAT_MAT3},{"mat4",GL_FLOAT_MAT4},
+		{"sampler2D",GL_SAMPLER_2D},{"samplerCube",GL_SAMPLER_CUBE}
+	};
+
+	for( const auto& t : types )
+	{
+		if( strcmp(t.name,type) == 0 )
+			return t.type;
+	}
+	return GL_FLOAT_VEC4;
+}
+
+/**
+ * Reads the next identifier or number, skipping anything else, returns NULL at the end of the source.
+ */
+static const char* NextToken(const char* source,char* token,int tokenSize,char* stop)
+{
+	while( *source && !isalnum((unsigned char)*source) && *source != '_' )
+	{
+		if( *source == ';' || *source == ',' || *source == '[' )
+		{
+			*stop = *source;
+		}
+		source++;
+	}
+
+	if( *source == 0 )
+		return NULL;
+
+	int length = 0;
+	while( isalnum((unsigned char)*source) || *source == '_' )
+	{
+		if( length < tokenSize - 1 )
+			token[length++] = *source;
+		source++;
+	}
+	token[length] = 0;
+	return source;
+}
+
+/**
+ * Finds the uniforms the shader declares, as in "uniform mediump vec4 u_colour, u_extra[4];", adding the ones the program does not have yet.
+ */
+static void ReadUniforms(NullProgram* program,const char* source)
+{
+	char token[32];
+	char stop = 0;
+	GLint location = 0;
+	for( int n = 0 ; n < program->uniformCount ; n++ )
+	{
+		location += program->uniforms[n].size;
+	}
+
+	while( (source = NextToken(source,token,sizeof(token),&stop)) != NULL )
+	{
+		if( strcmp(token,"uniform") != 0 )
+			continue;
+
+		source = NextToken(source,token,sizeof(token),&stop);
+		if( source && (strcmp(token,"lowp") == 0 || strcmp(token,"mediump") == 0 || strcmp(token,"highp") == 0) )
+			source = NextToken(source,token,sizeof(token),&stop);
+		if( source == NULL )
+			return;
+
+		const GLenum type = GetUniformType(token);
+		do
+		{
+			stop = 0;
+			source = NextToken(source,token,sizeof(token),&stop);
+			if( source == NULL )
+				return;
+
+			GLint size = 1;
+			while( *source == ' ' || *source == '\t' )
+				source++;
+			if( *source == '[' )
+			{
+				size = atoi(source + 1);
+				if( size < 1 )
+					size = 1;
+				source = strchr(source,']');
+				if( source == NULL )
+					return;
+				source++;
+			}
+
+			bool found = false;
+			for( int n = 0 ; n < program->uniformCount && !found ; n++ )
+			{
+				found = strcmp(program->uniforms[n].name,token) == 0;
+			}
+
+			if( !found && program->uniformCount < MAX_PROGRAM_UNIFORMS )
+			{
+				NullUniform& uniform = program->uniforms[program->uniformCount++];
+				strcpy(uniform.name,token);
+				uniform.type = type;
+				uniform.size = size;
+				uniform.location = location;
+				location += size;
+			}
+
+			// Skip to the end of this declarator, a comma means another follows.
+			while( *source && *source != ',' && *source != ';' )
+				source++;
+			stop = *source;
+		}while( stop == ',' );
+	}
+}
+
+static size_t GetPixelBytes(GLenum format,GLenum type)
+{
+	if( type == GL_UNSIGNED_SHORT_5_6_5 || type == GL_UNSIGNED_SHORT_4_4_4_4 || type == GL_UNSIGNED_SHORT_5_5_5_1 )
+		return 2;
+
+	switch( format )
+	{
+	case GL_RGBA:
+		return 4;
+	case GL_RGB:
+		return 3;
+	case GL_LUMINANCE_ALPHA:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+static void GenNames(GLsizei n,GLuint* names)
+{
+	for( GLsizei i = 0 ; i < n ; i++ )
+	{
+		names[i] = nextName++;
+	}
+}
+
+} /* namespace BogDog */
+
+using namespace BogDog;
+
+/*
+ * The GL entry points, declared by GLES2/gl2.h.
+ */
+GL_APICALL void GL_APIENTRY glActiveTexture(GLenum texture){NULLGL_COUNT(glActiveTexture);}
+GL_APICALL void GL_APIENTRY glBindAttribLocation(GLuint program,GLuint index,const GLchar* name){NULLGL_COUNT(glBindAttribLocation);}
+GL_APICALL void GL_APIENTRY glBindBuffer(GLenum target,GLuint buffer){NULLGL_COUNT(glBindBuffer);}
+GL_APICALL void GL_APIENTRY glBindFramebuffer(GLenum target,GLuint framebuffer){NULLGL_COUNT(glBindFramebuffer);}
+GL_APICALL void GL_APIENTRY glBindRenderbuffer(GLenum target,GLuint renderbuffer){NULLGL_COUNT(glBindRenderbuffer);}
+GL_APICALL void GL_APIENTRY glBindTexture(GLenum target,GLuint texture){NULLGL_COUNT(glBindTexture);}
+GL_APICALL void GL_APIENTRY glBlendEquation(GLenum mode){NULLGL_COUNT(glBlendEquation);}
+GL_APICALL void GL_APIENTRY glBlendFunc(GLenum sfactor,GLenum dfactor){NULLGL_COUNT(glBlendFunc);}
+GL_APICALL void GL_APIENTRY glClear(GLbitfield mask){NULLGL_COUNT(glClear);}
+GL_APICALL void GL_APIENTRY glClearColor(GLfloat red,GLfloat green,GLfloat blue,GLfloat alpha){NULLGL_COUNT(glClearColor);}
+GL_APICALL void GL_APIENTRY glColorMask(GLboolean red,GLboolean green,GLboolean blue,GLboolean alpha){NULLGL_COUNT(glColorMask);}
+GL_APICALL void GL_APIENTRY glCompileShader(GLuint shader){NULLGL_COUNT(glCompileShader);}
+GL_APICALL void GL_APIENTRY glCullFace(GLenum mode){NULLGL_COUNT(glCullFace);}
+GL_APICALL void GL_APIENTRY glDeleteBuffers(GLsizei n,const GLuint* buffers){NULLGL_COUNT(glDeleteBuffers);}
+GL_APICALL void GL_APIENTRY glDeleteFramebuffers(GLsizei n,const GLuint* framebuffers){NULLGL_COUNT(glDeleteFramebuffers);}
+GL_APICALL void GL_APIENTRY glDeleteRenderbuffers(GLsizei n,const GLuint* renderbuffers){NULLGL_COUNT(glDeleteRenderbuffers);}
+GL_APICALL void GL_APIENTRY glDeleteTextures(GLsizei n,const GLuint* textures){NULLGL_COUNT(glDeleteTextures);}
+GL_APICALL void GL_APIENTRY glDepthFunc(GLenum func){NULLGL_COUNT(glDepthFunc);}
+GL_APICALL void GL_APIENTRY glDepthMask(GLboolean flag){NULLGL_COUNT(glDepthMask);}
+GL_APICALL void GL_APIENTRY glDepthRangef(GLfloat n,GLfloat f){NULLGL_COUNT(glDepthRangef);}
+GL_APICALL void GL_APIENTRY glDisable(GLenum cap){NULLGL_COUNT(glDisable);}
+GL_APICALL void GL_APIENTRY glDisableVertexAttribArray(GLuint index){NULLGL_COUNT(glDisableVertexAttribArray);}
+GL_APICALL void GL_APIENTRY glEnable(GLenum cap){NULLGL_COUNT(glEnable);}
+GL_APICALL void GL_APIENTRY glEnableVertexAttribArray(GLuint index){NULLGL_COUNT(glEnableVertexAttribArray);}
+GL_APICALL void GL_APIENTRY glFinish(void){NULLGL_COUNT(glFinish);}
+GL_APICALL void GL_APIENTRY glFlush(void){NULLGL_COUNT(glFlush);}
+GL_APICALL void GL_APIENTRY glFramebufferRenderbuffer(GLenum target,GLenum attachment,GLenum renderbuffertarget,GLuint renderbuffer){NULLGL_COUNT(glFramebufferRenderbuffer);}
+GL_APICALL void GL_APIENTRY glFramebufferTexture2D(GLenum target,GLenum attachment,GLenum textarget,GLuint texture,GLint level){NULLGL_COUNT(glFramebufferTexture2D);}
+GL_APICALL void GL_APIENTRY glFrontFace(GLenum mode){NULLGL_COUNT(glFrontFace);}
+GL_APICALL void GL_APIENTRY glGenerateMipmap(GLenum target){NULLGL_COUNT(glGenerateMipmap);}
+GL_APICALL void GL_APIENTRY glPixelStorei(GLenum pname,GLint param){NULLGL_COUNT(glPixelStorei);}
+GL_APICALL void GL_APIENTRY glRenderbufferStorage(GLenum target,GLenum internalformat,GLsizei width,GLsizei height){NULLGL_COUNT(glRenderbufferStorage);}
+GL_APICALL void GL_APIENTRY glTexParameteri(GLenum target,GLenum pname,GLint param){NULLGL_COUNT(glTexParameteri);}
+GL_APICALL void GL_APIENTRY glUseProgram(GLuint program){NULLGL_COUNT(glUseProgram);}
+GL_APICALL void GL_APIENTRY glVertexAttribPointer(GLuint index,GLint size,GLenum type,GLboolean normalized,GLsizei stride,const void* pointer){NULLGL_COUNT(glVertexAttribPointer);}
+GL_APICALL void GL_APIENTRY glViewport(GLint x,GLint y,GLsizei width,GLsizei height){NULLGL_COUNT(glViewport);}
+GL_APICALL GLenum GL_APIENTRY glGetError(void){NULLGL_COUNT(glGetError);return GL_NO_ERROR;}
+GL_APICALL GLenum GL_APIENTRY glCheckFramebufferStatus(GLenum target){NULLGL_COUNT(glCheckFramebufferStatus);return GL_FRAMEBUFFER_COMPLETE;}
+
+GL_APICALL void GL_APIENTRY glGenBuffers(GLsizei n,GLuint* buffers){NULLGL_COUNT(glGenBuffers);GenNames(n,buffers);}
+GL_APICALL void GL_APIENTRY glGenFramebuffers(GLsizei n,GLuint* framebuffers){NULLGL_COUNT(glGenFramebuffers);GenNames(n,framebuffers);}
+GL_APICALL void GL_APIENTRY glGenRenderbuffers(GLsizei n,GLuint* renderbuffers){NULLGL_COUNT(glGenRenderbuffers);GenNames(n,renderbuffers);}
+GL_APICALL void GL_APIENTRY glGenTextures(GLsizei n,GLuint* textures){NULLGL_COUNT(glGenTextures);GenNames(n,textures);}
+
+GL_APICALL void GL_APIENTRY glBufferData(GLenum target,GLsizeiptr size,const void* data,GLenum usage)
+{
+	NULLGL_COUNT(glBufferData);
+	if( data != NULL )
+		stats.bufferBytes += size;
+}
+
+GL_APICALL void GL_APIENTRY glBufferSubData(GLenum target,GLintptr offset,GLsizeiptr size,const void* data)
+{
+	NULLGL_COUNT(glBufferSubData);
+	stats.bufferBytes += size;
+}
+
+GL_APICALL void GL_APIENTRY glTexImage2D(GLenum target,GLint level,GLint internalformat,GLsizei width,GLsizei height,GLint border,GLenum format,GLenum type,const void* pixels)
+{
+	NULLGL_COUNT(glTexImage2D);
+	if( pixels != NULL )
+		stats.textureBytes += (uint64_t)width * height * GetPixelBytes(format,type);
+}
+
+GL_APICALL void GL_APIENTRY glTexSubImage2D(GLenum target,GLint level,GLint xoffset,GLint yoffset,GLsizei width,GLsizei height,GLenum format,GLenum type,const void* pixels)
+{
+	NULLGL_COUNT(glTexSubImage2D);
+	stats.textureBytes += (uint64_t)width * height * GetPixelBytes(format,type);
+}
+
+GL_APICALL void GL_APIENTRY glReadPixels(GLint x,GLint y,GLsizei width,GLsizei height,GLenum format,GLenum type,void* pixels)
+{
+	NULLGL_COUNT(glReadPixels);
+	const size_t bytes = (size_t)width * height * GetPixelBytes(format,type);
+	memset(pixels,0,bytes);
+	stats.readBytes += bytes;
+}
+
+GL_APICALL void GL_APIENTRY glDrawArrays(GLenum mode,GLint first,GLsizei count)
+{
+	NULLGL_COUNT(glDrawArrays);
+	stats.drawCalls++;
+	stats.vertices += count;
+	if( mode == GL_TRIANGLES )
+		stats.triangles += count / 3;
+}
+
+GL_APICALL void GL_APIENTRY glDrawElements(GLenum mode,GLsizei count,GLenum type,const void* indices)
+{
+	NULLGL_COUNT(glDrawElements);
+	stats.drawCalls++;
+	stats.vertices += count;
+	if( mode == GL_TRIANGLES )
+		stats.triangles += count / 3;
+}
+
+GL_APICALL void GL_APIENTRY glUniform1i(GLint location,GLint v0)
+{
+	NULLGL_COUNT(glUniform1i);
+	stats.uniformCalls++;
+	stats.uniformBytes += sizeof(GLint);
+}
+
+GL_APICALL void GL_APIENTRY glUniform4fv(GLint location,GLsizei count,const GLfloat* value)
+{
+	NULLGL_COUNT(glUniform4fv);
+	stats.uniformCalls++;
+	stats.uniformBytes += count * 4 * sizeof(GLfloat);
+}
+
+GL_APICALL void GL_APIENTRY glUniformMatrix4fv(GLint location,GLsizei count,GLboolean transpose,const GLfloat* value)
+{
+	NULLGL_COUNT(glUniformMatrix4fv);
+	stats.uniformCalls++;
+	stats.uniformBytes += count * 16 * sizeof(GLfloat);
+}
+
+GL_APICALL void GL_APIENTRY glGetIntegerv(GLenum pname,GLint* data)
+{
+	NULLGL_COUNT(glGetIntegerv);
+	switch( pname )
+	{
+	case GL_MAX_VERTEX_UNIFORM_VECTORS:
+		*data = 256;
+		break;
+
+	case GL_MAX_FRAGMENT_UNIFORM_VECTORS:
+	case GL_MAX_VARYING_VECTORS:
+		*data = 64;
+		break;
+
+	case GL_MAX_VERTEX_ATTRIBS:
+		*data = 16;
+		break;
+
+	case GL_MAX_TEXTURE_IMAGE_UNITS:
+	case GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS:
+		*data = 8;
+		break;
+
+	case GL_MAX_TEXTURE_SIZE:
+	case GL_MAX_RENDERBUFFER_SIZE:
+		*data = 4096;
+		break;
+
+	default:
+		*data = 0;
+		break;
+	}
+}
+
+GL_APICALL const GLubyte* GL_APIENTRY glGetString(GLenum name)
+{
+	NULLGL_COUNT(glGetString);
+	switch( name )
+	{
+	case GL_VENDOR:
+		return (const GLubyte*)"BogDog";
+	case GL_RENDERER:
+		return (const GLubyte*)"BogDog null GL";
+	case GL_VERSION:
+		return (const GLubyte*)"OpenGL ES 2.0 null";
+	case GL_SHADING_LANGUAGE_VERSION:
+		return (const GLubyte*)"OpenGL ES GLSL ES 1.0.16";
+	case GL_EXTENSIONS:
+		return (const GLubyte*)"GL_OES_vertex_half_float GL_OES_depth24";
+	}
+	return NULL;
+}
+
+/*
+ * Shaders and programs, the source is kept so linking can find the uniforms.
+ */
+GL_APICALL GLuint GL_APIENTRY glCreateShader(GLenum type)
+{
+	NULLGL_COUNT(glCreateShader);
+	NullShader* shader = FindShader(0);// Reuse a deleted one.
+	if( shader == NULL )
+		shader = shaders.PushBack();
+	shader->name = nextName++;
+	shader->source = NULL;
+	return shader->name;
+}
+
+GL_APICALL void GL_APIENTRY glShaderSource(GLuint shader,GLsizei count,const GLchar* const* string,const GLint* length)
+{
+	NULLGL_COUNT(glShaderSource);
+	NullShader* nullShader = shader ? FindShader(shader) : NULL;
+	if( nullShader == NULL )
+		return;
+
+	size_t total = 0;
+	for( GLsizei n = 0 ; n < count ; n++ )
+	{
+		total += (length && length[n] >= 0) ? length[n] : strlen(string[n]);
+	}
+
+	free(nullShader->source);
+	nullShader->source = (char*)malloc(total + 1);
+	char* dest = nullShader->source;
+	for( GLsizei n = 0 ; n < count ; n++ )
+	{
+		const size_t bytes = (length && length[n] >= 0) ? length[n] : strlen(string[n]);
+		memcpy(dest,string[n],bytes);
+		dest += bytes;
+	}
+	*dest = 0;
+}
+
+GL_APICALL void GL_APIENTRY glDeleteShader(GLuint shader)
+{
+	NULLGL_COUNT(glDeleteShader);
+	NullShader* nullShader = shader ? FindShader(shader) : NULL;
+	if( nullShader )
+	{
+		free(nullShader->source);
+		nullShader->source = NULL;
+		nullShader->name = 0;
+	}
+}
+
+GL_APICALL void GL_APIENTRY glGetShaderiv(GLuint shader,GLenum pname,GLint* params)
+{
+	NULLGL_COUNT(glGetShaderiv);
+	*params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+GL_APICALL void GL_APIENTRY glGetShaderInfoLog(GLuint shader,GLsizei bufSize,GLsizei* length,GLchar* infoLog)
+{
+	NULLGL_COUNT(glGetShaderInfoLog);
+	if( length )
+		*length = 0;
+	if( bufSize > 0 )
+		infoLog[0] = 0;
+}
+
+GL_APICALL GLuint GL_APIENTRY glCreateProgram(void)
+{
+	NULLGL_COUNT(glCreateProgram);
+	NullProgram* program = FindProgram(0);
+	if( program == NULL )
+		program = programs.PushBack();
+	memset(program,0,sizeof(NullProgram));
+	program->name = nextName++;
+	return program->name;
+}
+
+GL_APICALL void GL_APIENTRY glDeleteProgram(GLuint program)
+{
+	NULLGL_COUNT(glDeleteProgram);
+	NullProgram* nullProgram = program ? FindProgram(program) : NULL;
+	if( nullProgram )
+		nullProgram->name = 0;
+}
+
+GL_APICALL void GL_APIENTRY glAttachShader(GLuint program,GLuint shader)
+{
+	NULLGL_COUNT(glAttachShader);
+	NullProgram* nullProgram = FindProgram(program);
+	if( nullProgram )
+		nullProgram->shaders[nullProgram->shaders[0] ? 1 : 0] = shader;
+}
+
+GL_APICALL void GL_APIENTRY glLinkProgram(GLuint program)
+{
+	NULLGL_COUNT(glLinkProgram);
+	NullProgram* nullProgram = FindProgram(program);
+	if( nullProgram == NULL )
+		return;
+
+	nullProgram->uniformCount = 0;
+	for( GLuint shader : nullProgram->shaders )
+	{
+		NullShader* nullShader = FindShader(shader);
+		if( nullShader && nullShader->source )
+			ReadUniforms(nullProgram,nullShader->source);
+	}
+}
+
+GL_APICALL void GL_APIENTRY glGetProgramiv(GLuint program,GLenum pname,GLint* params)
+{
+	NULLGL_COUNT(glGetProgramiv);
+	NullProgram* nullProgram = FindProgram(program);
+	switch( pname )
+	{
+	case GL_LINK_STATUS:
+	case GL_VALIDATE_STATUS:
+		*params = GL_TRUE;
+		break;
+
+	case GL_ACTIVE_UNIFORMS:
+		*params = nullProgram ? nullProgram->uniformCount : 0;
+		break;
+
+	case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+		*params = 32 + 3;
+		break;
+
+	default:
+		*params = 0;
+		break;
+	}
+}
+
+GL_APICALL void GL_APIENTRY glGetProgramInfoLog(GLuint program,GLsizei bufSize,GLsizei* length,GLchar* infoLog)
+{
+	NULLGL_COUNT(glGetProgramInfoLog);
+	if( length )
+		*length = 0;
+	if( bufSize > 0 )
+		infoLog[0] = 0;
+}
+
+GL_APICALL void GL_APIENTRY glGetActiveUniform(GLuint program,GLuint index,GLsizei bufSize,GLsizei* length,GLint* size,GLenum* type,GLchar* name)
+{
+	NULLGL_COUNT(glGetActiveUniform);
+	NullProgram* nullProgram = FindProgram(program);
+	if( nullProgram == NULL || (int)index >= nullProgram->uniformCount || bufSize <= 0 )
+		return;
+
+	// Arrays are named with [0] on the end like real drivers do.
+	const NullUniform& uniform = nullProgram->uniforms[index];
+	const int written = snprintf(name,bufSize,uniform.size > 1 ? "%s[0]" : "%s",uniform.name);
+	if( length )
+		*length = written < bufSize ? written : bufSize - 1;
+	*size = uniform.size;
+	*type = uniform.type;
+}
+
+GL_APICALL GLint GL_APIENTRY glGetUniformLocation(GLuint program,const GLchar* name)
+{
+	NULLGL_COUNT(glGetUniformLocation);
+	NullProgram* nullProgram = FindProgram(program);
+	if( nullProgram == NULL )
+		return -1;
+
+	for( int n = 0 ; n < nullProgram->uniformCount ; n++ )
+	{
+		const NullUniform& uniform = nullProgram->uniforms[n];
+		const size_t length = strlen(uniform.name);
+		if( strncmp(uniform.name,name,length) == 0 && (name[length] == 0 || strcmp(name + length,"[0]") == 0) )
+			return uniform.location;
+	}
+	return -1;
+}
+
+GL_APICALL GLint GL_APIENTRY glGetAttribLocation(GLuint program,const GLchar* name)
+{
+	NULLGL_COUNT(glGetAttribLocation);
+	return -1;
+}
+
+/*
+ * The EGL entry points, declared by EGL/egl.h. There is one display, config, context and window.
+ */
+static EGLDisplay EGLAPIENTRY NullGetPlatformDisplay(EGLenum platform,void* nativeDisplay,const EGLint* attribList)
+{
+	NULLGL_COUNT(eglGetPlatformDisplayEXT);
+	return (EGLDisplay)1;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglBindAPI(EGLenum api){NULLGL_COUNT(eglBindAPI);return EGL_TRUE;}
+EGLAPI EGLDisplay EGLAPIENTRY eglGetDisplay(EGLNativeDisplayType display_id){NULLGL_COUNT(eglGetDisplay);return (EGLDisplay)1;}
+EGLAPI EGLDisplay EGLAPIENTRY eglGetCurrentDisplay(void){NULLGL_COUNT(eglGetCurrentDisplay);return (EGLDisplay)1;}
+EGLAPI EGLint EGLAPIENTRY eglGetError(void){NULLGL_COUNT(eglGetError);return EGL_SUCCESS;}
+EGLAPI EGLBoolean EGLAPIENTRY eglSwapInterval(EGLDisplay dpy,EGLint interval){NULLGL_COUNT(eglSwapInterval);return EGL_TRUE;}
+EGLAPI EGLBoolean EGLAPIENTRY eglMakeCurrent(EGLDisplay dpy,EGLSurface draw,EGLSurface read,EGLContext ctx){NULLGL_COUNT(eglMakeCurrent);return EGL_TRUE;}
+EGLAPI EGLContext EGLAPIENTRY eglCreateContext(EGLDisplay dpy,EGLConfig config,EGLContext share_context,const EGLint* attrib_list){NULLGL_COUNT(eglCreateContext);return (EGLContext)1;}
+EGLAPI EGLSurface EGLAPIENTRY eglCreateWindowSurface(EGLDisplay dpy,EGLConfig config,EGLNativeWindowType win,const EGLint* attrib_list){NULLGL_COUNT(eglCreateWindowSurface);return (EGLSurface)1;}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglInitialize(EGLDisplay dpy,EGLint* major,EGLint* minor)
+{
+	NULLGL_COUNT(eglInitialize);
+	if( major )
+		*major = 1;
+	if( minor )
+		*minor = 4;
+	return EGL_TRUE;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglGetConfigs(EGLDisplay dpy,EGLConfig* configs,EGLint config_size,EGLint* num_config)
+{
+	NULLGL_COUNT(eglGetConfigs);
+	if( configs && config_size > 0 )
+		configs[0] = (EGLConfig)1;
+	*num_config = 1;
+	return EGL_TRUE;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglChooseConfig(EGLDisplay dpy,const EGLint* attrib_list,EGLConfig* configs,EGLint config_size,EGLint* num_config)
+{
+	NULLGL_COUNT(eglChooseConfig);
+	return eglGetConfigs(dpy,configs,config_size,num_config);
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglGetConfigAttrib(EGLDisplay dpy,EGLConfig config,EGLint attribute,EGLint* value)
+{
+	NULLGL_COUNT(eglGetConfigAttrib);
+	switch( attribute )
+	{
+	case EGL_BUFFER_SIZE:
+		*value = 32;
+		break;
+
+	case EGL_RED_SIZE:
+	case EGL_GREEN_SIZE:
+	case EGL_BLUE_SIZE:
+	case EGL_ALPHA_SIZE:
+		*value = 8;
+		break;
+
+	case EGL_DEPTH_SIZE:
+		*value = 24;
+		break;
+
+	default:
+		*value = 0;
+		break;
+	}
+	return EGL_TRUE;
+}
+
+EGLAPI EGLSurface EGLAPIENTRY eglCreatePbufferSurface(EGLDisplay dpy,EGLConfig config,const EGLint* attrib_list)
+{
+	NULLGL_COUNT(eglCreatePbufferSurface);
+	for( ; attrib_list && attrib_list[0] != EGL_NONE ; attrib_list += 2 )
+	{
+		if( attrib_list[0] == EGL_WIDTH )
+			pbufferWidth = attrib_list[1];
+		else if( attrib_list[0] == EGL_HEIGHT )
+			pbufferHeight = attrib_list[1];
+	}
+	return (EGLSurface)2;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglQuerySurface(EGLDisplay dpy,EGLSurface surface,EGLint attribute,EGLint* value)
+{
+	NULLGL_COUNT(eglQuerySurface);
+	const bool window = surface == (EGLSurface)1;
+	if( attribute == EGL_WIDTH )
+		*value = window ? NULL_WINDOW_WIDTH : pbufferWidth;
+	else if( attribute == EGL_HEIGHT )
+		*value = window ? NULL_WINDOW_HEIGHT : pbufferHeight;
+	else
+		*value = 0;
+	return EGL_TRUE;
+}
+
+EGLAPI EGLBoolean EGLAPIENTRY eglSwapBuffers(EGLDisplay dpy,EGLSurface surface)
+{
+	NULLGL_COUNT(eglSwapBuffers);
+	stats.frames++;
+	return EGL_TRUE;
+}
+
+EGLAPI const char* EGLAPIENTRY eglQueryString(EGLDisplay dpy,EGLint name)
+{
+	NULLGL_COUNT(eglQueryString);
+	switch( name )
+	{
+	case EGL_VENDOR:
+		return "BogDog";
+	case EGL_VERSION:
+		return "1.4 null";
+	case EGL_CLIENT_APIS:
+		return "OpenGL_ES";
+	case EGL_EXTENSIONS:
+		// No fence sync, GLStreamBuffer orphans instead which costs the same on the CPU.
+		return dpy == EGL_NO_DISPLAY ? "EGL_EXT_platform_base EGL_MESA_platform_surfaceless" : "EGL_KHR_surfaceless_context";
+	}
+	return NULL;
+}
+
+EGLAPI __eglMustCastToProperFunctionPointerType EGLAPIENTRY eglGetProcAddress(const char* procname)
+{
+	NULLGL_COUNT(eglGetProcAddress);
+	if( strcmp(procname,"eglGetPlatformDisplayEXT") == 0 )
+		return (__eglMustCastToProperFunctionPointerType)NullGetPlatformDisplay;
+	return NULL;
+}
+
+#endif //#ifdef PLATFORM_NULL
@@ -0,0 +1,71 @@
+/*
+ * NullGL.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NULLGL_H_
+#define NULLGL_H_
+
+#include <stdint.h>
+#include "GLHeaders.h"
+
+namespace BogDog
+{
+
+/**
+ * Build with PLATFORM_NULL, and without linking GLESv2 and EGL, and the GL and EGL entry points BogDog uses are
+ * replaced by ones in NullGL.cpp that draw nothing and only count the calls and the bytes handed to them.
+ * OpenGLES_2_0 creates its context as normal, Create gives a 1280x720 window and CreateHeadless the size asked for.
+ * Use it to measure what the engine itself costs on the CPU without the driver in the way.
+ * Shaders always compile and link, their uniforms are found by reading the source so GLShader works as normal.
+ * Only use from the thread that owns the GL context.
+ */
+struct NullGL
+{
+	struct Stats
+	{
+		uint64_t calls;				//!<Every GL and EGL call.
+		uint64_t drawCalls;
+		uint64_t vertices;			//!<Vertices, or indices, the draws used.
+		uint64_t triangles;
+		uint64_t uniformCalls;
+		uint64_t uniformBytes;
+		uint64_t bufferBytes;		//!<Handed to glBufferData and glBufferSubData.
+		uint64_t textureBytes;		//!<Handed to glTexImage2D and glTexSubImage2D.
+		uint64_t readBytes;			//!<Asked for by glReadPixels.
+		uint64_t frames;			//!<Calls to eglSwapBuffers.
+	};
+
+	static const Stats& GetStats();
+
+	/**
+	 * @return How many times a GL or EGL function, by name, has been called since the last ResetStats.
+	 */
+	static uint64_t GetCallCount(const char* function);
+
+	static void ResetStats();
+
+	/**
+	 * Prints the totals and the number of calls to each function that has been called.
+	 */
+	static void PrintReport();
+};
+
+} /* namespace BogDog */
+#endif /* NULLGL_H_ */
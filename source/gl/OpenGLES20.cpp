@@ -21,21 +21,30 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
 #include <unistd.h>
 #include <sys/time.h>
+#include <time.h>
 #include <assert.h>
 #include <signal.h>
 #include <iostream>
 
 #include "gl/OpenGLES20.h"
+#include "gl/GLResources.h"
+#include "Profiler.h"
+#include "LiveMetrics.h"
 #include "Common.h"
 #include "Timer.h"
 #include "gfx/ImageLoader.h"
 
+#ifdef TARGET_GLES
+	#include "GLES2/gl2ext.h"
+#endif
+
 namespace BogDog
 {
 
@@ -75,13 +84,27 @@ float channel_to_float_convert[256] =
 	0.97254902f,0.97647059f,0.98039216f,0.98431373f,0.98823529f,0.99215686f,0.99607843f,1.00000000f,
 };
 
+GLStateCache OpenGLES_2_0::stateCache;
+FrameStats OpenGLES_2_0::frameStats;
+FrameStats OpenGLES_2_0::lastFrameStats;
+FrameStatsHistory OpenGLES_2_0::frameStatsHistory;
+int OpenGLES_2_0::frameStartIssued[3] = {0,0,0};
+ErrorCheckPolicy OpenGLES_2_0::errorCheckPolicy = ERROR_CHECK_FRAME;
+int OpenGLES_2_0::errorCheckInterval = 100;
+int OpenGLES_2_0::errorCheckCountdown = 100;
+int OpenGLES_2_0::errorCount = 0;
+const char* OpenGLES_2_0::lastCheckFile = "no check yet";
+int OpenGLES_2_0::lastCheckLine = 0;
+
 static bool applicationRunning = false;
 
+#if defined(PLATFORM_BCM_HOST) || defined(TARGET_GL)
 static void ExitApplication()
 {
 	printf("Recived app close message\n");
 	applicationRunning = false;
 }
+#endif
 
 #ifdef PLATFORM_BCM_HOST
 static void RPI_Exit(int)
@@ -90,7 +113,11 @@ static void RPI_Exit(int)
 }
 #endif
 
-OpenGLES_2_0::OpenGLES_2_0()
+OpenGLES_2_0::OpenGLES_2_0():
+	m_headless(false),
+	m_framebuffer(0),
+	m_colourTexture(0),
+	m_depthBuffer(0)
 {
 #ifdef PLATFORM_BCM_HOST
 	struct sigaction act;
@@ -122,7 +149,15 @@ OpenGLES_2_0::OpenGLES_2_0()
 
 OpenGLES_2_0::~OpenGLES_2_0()
 {
-
+	if( m_framebuffer )
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER,0);
+		glDeleteFramebuffers(1,&m_framebuffer);
+		glDeleteRenderbuffers(1,&m_depthBuffer);
+		stateCache.DeleteTexture(m_colourTexture);
+		glDeleteTextures(1,&m_colourTexture);
+	}
+	GLResources::ReportLeaks();
 }
 
 bool OpenGLES_2_0::ApplicationRunning()
@@ -142,16 +177,72 @@ bool OpenGLES_2_0::Create(bool syncWithDisplay)
 	CHECK_OGL_ERRORS();
 
 	printf("Display at %dx%d\n",m_info.width,m_info.height);
+#ifdef BD_GL_TRACE
+	GLTrace::SetSurfaceSize(m_info.width,m_info.height);
+#endif
+
+	applicationRunning = true;
+	InitialiseState();
+	return true;
+}
+
+bool OpenGLES_2_0::CreateHeadless(int width,int height)
+{
+#ifdef TARGET_GLES
+	if( width <= 0 || height <= 0 )
+	{
+		printf("CreateHeadless: bad size %dx%d\n",width,height);
+		return false;
+	}
+
+	m_info.width = width;
+	m_info.height = height;
+	m_info.display_aspect = (float)width / (float)height;
+
+	if( !OpenGLESHeadless() || !CreateBackBuffer() )
+		return false;
+
+	printf("Headless at %dx%d\n",m_info.width,m_info.height);
+#ifdef BD_GL_TRACE
+	GLTrace::SetSurfaceSize(m_info.width,m_info.height);
+#endif
 
+	m_headless = true;
 	applicationRunning = true;
+	InitialiseState();
+	return true;
+#endif //#ifdef TARGET_GLES
+
+#ifdef TARGET_GL
+	printf("CreateHeadless: not supported with GLUT, build with TARGET_GLES\n");
+	return false;
+#endif //#ifdef TARGET_GL
+}
+
+void OpenGLES_2_0::InitialiseState()
+{
+	ReadErrorCheckPolicyFromEnvironment();
+
+	frameStats.Reset();
+	lastFrameStats.Reset();
+	frameStatsHistory.Reset();
+
+	// BD_METRICS=1 publishes to /dev/shm/bogdog.<pid>, anything else is the name to use.
+	const char* metrics = getenv("BD_METRICS");
+	if( metrics != NULL && !LiveMetrics::IsOpen() )
+	{
+		LiveMetrics::Open(strcmp(metrics,"1") == 0 ? NULL : metrics);
+	}
+	//New context so nothing the cache has is valid.
+	stateCache.Invalidate();
+	stateCache.ResetCounters();
+	frameStartIssued[0] = frameStartIssued[1] = frameStartIssued[2] = 0;
 
-	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LESS);
-	glDepthMask(true);
+	stateCache.SetDepthTest(true);
+	stateCache.SetDepthFunc(GL_LESS);
+	stateCache.SetDepthWrite(true);
 
-	glEnable(GL_CULL_FACE);
-	glFrontFace(GL_CW);
-	glCullFace(GL_BACK);
+	stateCache.SetCull(true,GL_BACK,GL_CW);
 
 	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
 	SetBlendMode(BLENDMODE_OFF);
@@ -161,9 +252,6 @@ bool OpenGLES_2_0::Create(bool syncWithDisplay)
 #endif//#ifdef TARGET_GLES
 
 	CHECK_OGL_ERRORS();
-
-
-	return true;
 }
 
 void OpenGLES_2_0::SetBlendMode(BLENDMODE mode)
@@ -171,25 +259,19 @@ void OpenGLES_2_0::SetBlendMode(BLENDMODE mode)
 	switch(mode)
 	{
 	case BLENDMODE_OFF:
-		glDisable(GL_BLEND);
+		stateCache.SetBlend(false);
 		break;
 
 	case BLENDMODE_NORMAL:
-		glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-		glBlendEquation(GL_FUNC_ADD);
-		glEnable(GL_BLEND);
+		stateCache.SetBlend(true,GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA,GL_FUNC_ADD);
 		break;
 
 	case BLENDMODE_ADDITIVE:
-		glBlendFunc(GL_SRC_ALPHA,GL_ONE);
-		glBlendEquation(GL_FUNC_ADD);
-		glEnable(GL_BLEND);
+		stateCache.SetBlend(true,GL_SRC_ALPHA,GL_ONE,GL_FUNC_ADD);
 		break;
 
 	case BLENDMODE_SUBTRACTIVE:
-		glBlendFunc(GL_SRC_ALPHA,GL_ONE);
-		glBlendEquation(GL_FUNC_SUBTRACT);
-		glEnable(GL_BLEND);
+		stateCache.SetBlend(true,GL_SRC_ALPHA,GL_ONE,GL_FUNC_SUBTRACT);
 		break;
 	}
 	CHECK_OGL_ERRORS();
@@ -197,18 +279,143 @@ void OpenGLES_2_0::SetBlendMode(BLENDMODE mode)
 
 void OpenGLES_2_0::Update()
 {
+	BD_PROFILE_SCOPE("OpenGLES_2_0::Update");
+#ifdef BD_GL_TRACE
+	GLTrace::EndFrame();
+#endif
+	if( errorCheckPolicy == ERROR_CHECK_FRAME )
+	{// Any error from this frame, it came after the last check.
+		ReadOGLErrors(lastCheckFile,lastCheckLine);
+	}
+
+	struct timespec swapStart,swapEnd;
+	clock_gettime(CLOCK_MONOTONIC,&swapStart);
+
+	if( m_headless )
+	{// Nothing to show it on, make sure the driver gets on with it.
+		glFlush();
+	}
+	else
+	{
 #ifdef TARGET_GLES
-	eglSwapBuffers(m_display,m_surface);
+		eglSwapBuffers(m_display,m_surface);
 #endif //#define TARGET_GLES
 
 #ifdef TARGET_GL
-	glutSwapBuffers();
-	glutMainLoopEvent();
+		glutSwapBuffers();
+		glutMainLoopEvent();
 #endif //#define TARGET_GL
+	}
+
+	clock_gettime(CLOCK_MONOTONIC,&swapEnd);
+	EndFrameStats((float)(swapEnd.tv_sec - swapStart.tv_sec) * 1000.0f + (float)(swapEnd.tv_nsec - swapStart.tv_nsec) / 1000000.0f);
 
 	CHECK_OGL_ERRORS();
 }
 
+void OpenGLES_2_0::EndFrameStats(float swapMilliseconds)
+{
+	const int program = stateCache.getIssued(GLStateCache::STATE_PROGRAM);
+	const int texture = stateCache.getIssued(GLStateCache::STATE_TEXTURE);
+	const int uniform = stateCache.getIssued(GLStateCache::STATE_UNIFORM);
+
+	frameStats.programSwitches = program - frameStartIssued[0];
+	frameStats.textureBinds = texture - frameStartIssued[1];
+	frameStats.uniformUploads = uniform - frameStartIssued[2];
+	frameStats.swapMilliseconds = swapMilliseconds;
+
+	lastFrameStats = frameStats;
+	frameStatsHistory.Add(frameStats);
+	if( LiveMetrics::IsOpen() )
+	{
+		LiveMetrics::EndFrame(lastFrameStats);
+	}
+
+	frameStats.Reset();
+	frameStartIssued[0] = program;
+	frameStartIssued[1] = texture;
+	frameStartIssued[2] = uniform;
+}
+
+void OpenGLES_2_0::PrintFrameStats()
+{
+	lastFrameStats.Print("Last frame");
+	frameStatsHistory.GetAverage().Print("Average");
+	frameStatsHistory.GetPercentile(95.0f).Print("95th percentile");
+}
+
+bool OpenGLES_2_0::MakeCurrent()
+{
+#ifdef TARGET_GLES
+	if( !eglMakeCurrent(m_display,m_surface,m_surface,m_context) )
+	{
+		printf("MakeCurrent: eglMakeCurrent failed 0x%x\n",eglGetError());
+		return false;
+	}
+	return true;
+#endif //#define TARGET_GLES
+
+#ifdef TARGET_GL
+	printf("MakeCurrent: the GLUT context can not be moved to another thread\n");
+	return false;
+#endif //#define TARGET_GL
+}
+
+void OpenGLES_2_0::ReleaseCurrent()
+{
+#ifdef TARGET_GLES
+	eglMakeCurrent(m_display,EGL_NO_SURFACE,EGL_NO_SURFACE,EGL_NO_CONTEXT);
+#endif //#define TARGET_GLES
+}
+
+void OpenGLES_2_0::SetSwapInterval(int interval)
+{
+#ifdef TARGET_GLES
+	eglSwapInterval(m_display,interval);
+#endif //#define TARGET_GLES
+}
+
+bool OpenGLES_2_0::ReadFrame(uint8_t* rgba,bool topRowFirst)
+{
+	assert( rgba != NULL );
+
+	// Errors from earlier calls are reported where they happened, not blamed on the read.
+	CHECK_OGL_ERRORS();
+
+	GLint packAlignment = 4;
+	glGetIntegerv(GL_PACK_ALIGNMENT,&packAlignment);
+	glPixelStorei(GL_PACK_ALIGNMENT,1);
+	glReadPixels(0,0,m_info.width,m_info.height,GL_RGBA,GL_UNSIGNED_BYTE,rgba);
+	const GLenum error = glGetError();
+	glPixelStorei(GL_PACK_ALIGNMENT,packAlignment);
+	if( error != GL_NO_ERROR )
+	{
+		printf("ReadFrame: glReadPixels failed 0x%x\n",error);
+		return false;
+	}
+
+	if( topRowFirst )
+	{
+		FlipRows(rgba,m_info.width * 4,m_info.height);
+	}
+	return true;
+}
+
+void OpenGLES_2_0::FlipRows(uint8_t* pixels,int rowBytes,int height)
+{
+	uint8_t* top = pixels;
+	uint8_t* bottom = pixels + (height - 1) * rowBytes;
+	for( ; top < bottom ; top += rowBytes , bottom -= rowBytes )
+	{
+		for( int n = 0 ; n < rowBytes ; n++ )
+		{
+			const uint8_t swap = top[n];
+			top[n] = bottom[n];
+			bottom[n] = swap;
+		}
+	}
+}
+
 void OpenGLES_2_0::Clear(uint32_t pRed, uint32_t pGreen, uint32_t pBlue)
 {
 	glClearColor(
@@ -276,7 +483,25 @@ GLuint OpenGLES_2_0::CreateTexture(TextureFormat textureFormat,int width,int hei
 	CHECK_OGL_ERRORS();
 	assert(tex);
 
-	glBindTexture(GL_TEXTURE_2D,tex);
+	//Work out the memory including the mip chain.
+	size_t bytes = 0;
+	int levels = 0;
+	for( int w = width, h = height ; ; w = w > 1 ? w / 2 : 1 , h = h > 1 ? h / 2 : 1 )
+	{
+		bytes += (size_t)w * h * PixelSizeFromFormat(textureFormat);
+		levels++;
+		if( !mipMap || (w == 1 && h == 1) )
+			break;
+	}
+
+	if( !GLResources::Add(RESOURCE_TEXTURE,tex,bytes,levels) )
+	{
+		printf("CreateTexture: not creating %dx%d texture\n",width,height);
+		glDeleteTextures(1,&tex);
+		return 0;
+	}
+
+	stateCache.BindTexture(0,tex);
 	CHECK_OGL_ERRORS();
 
 	glTexImage2D(
@@ -291,6 +516,10 @@ GLuint OpenGLES_2_0::CreateTexture(TextureFormat textureFormat,int width,int hei
 		pixels);
 
 	CHECK_OGL_ERRORS();
+	if( pixels != NULL )
+	{
+		CountTextureUpload((size_t)width * height * PixelSizeFromFormat(textureFormat));
+	}
 
 	//Unlike GLES 1.1 this is called after texture creation, in GLES 1.1 you say that you want glTexImage2D to make the mips.
 	if( mipMap )
@@ -335,12 +564,23 @@ GLuint OpenGLES_2_0::CreateTexture(TextureFormat textureFormat,int width,int hei
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	}
 
-	glBindTexture(GL_TEXTURE_2D,0);//Because we had to change it to setup the texture! Stupid GL!
+	stateCache.BindTexture(0,0);//Because we had to change it to setup the texture! Stupid GL!
 	CHECK_OGL_ERRORS();
 
 	return tex;
 }
 
+void OpenGLES_2_0::DeleteTexture(GLuint texture)
+{
+	if( texture != 0 )
+	{
+		GLResources::Remove(RESOURCE_TEXTURE,texture);
+		stateCache.DeleteTexture(texture);
+		glDeleteTextures(1,&texture);
+		CHECK_OGL_ERRORS();
+	}
+}
+
 GLuint OpenGLES_2_0::CreateTexture(const LoadedImage& image, bool mipMap,bool filtered,bool uvClamp)
 {
 	if( image.image == NULL )
@@ -370,6 +610,30 @@ int OpenGLES_2_0::GetGLTypeSize(int type)
 	return 0;
 }
 
+bool OpenGLES_2_0::HasExtension(const char* name)
+{
+	const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+	if( extensions == NULL || name == NULL )
+	{
+		return false;
+	}
+
+	//Have to check for the whole word, some extension names are the start of others.
+	const size_t nameLength = strlen(name);
+	const char* found = strstr(extensions,name);
+	while( found != NULL )
+	{
+		const bool startOk = found == extensions || found[-1] == ' ';
+		const bool endOk = found[nameLength] == ' ' || found[nameLength] == 0;
+		if( startOk && endOk )
+		{
+			return true;
+		}
+		found = strstr(found + nameLength,name);
+	}
+	return false;
+}
+
 void OpenGLES_2_0::ReadOGLErrors(const char *pSource_file_name,int pLine_number)
 {
 	int gl_error_code = glGetError();
@@ -383,6 +647,7 @@ void OpenGLES_2_0::ReadOGLErrors(const char *pSource_file_name,int pLine_number)
 	printf("\n**********************\nline %d file %s\n",pLine_number,pSource_file_name);
 	while(gl_error_code != GL_NO_ERROR)
 	{
+		errorCount++;
 		printf("GL error[%d]: :",gl_error_code);
 		switch(gl_error_code)
 		{
@@ -416,10 +681,98 @@ void OpenGLES_2_0::ReadOGLErrors(const char *pSource_file_name,int pLine_number)
 	printf("**********************\n");
 }
 
+ErrorCheckPolicy OpenGLES_2_0::SetErrorCheckPolicy(ErrorCheckPolicy policy,int interval)
+{
+#ifdef TARGET_GLES
+	static PFNGLDEBUGMESSAGECALLBACKKHRPROC debugMessageCallback = NULL;
+	if( debugMessageCallback == NULL && HasExtension("GL_KHR_debug") )
+	{
+		debugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKKHRPROC)eglGetProcAddress("glDebugMessageCallbackKHR");
+	}
+
+	if( debugMessageCallback != NULL )
+	{
+		if( policy == ERROR_CHECK_KHR_DEBUG )
+		{
+			// Synchronous so the callback comes from inside the call that went wrong, after the last CHECK_OGL_ERRORS.
+			glEnable(GL_DEBUG_OUTPUT_KHR);
+			glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+			debugMessageCallback(DebugMessage,NULL);
+		}
+		else if( errorCheckPolicy == ERROR_CHECK_KHR_DEBUG )
+		{
+			debugMessageCallback(NULL,NULL);
+			glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+			glDisable(GL_DEBUG_OUTPUT_KHR);
+		}
+	}
+	else if( policy == ERROR_CHECK_KHR_DEBUG )
+	{
+		printf("No GL_KHR_debug, checking for GL errors once a frame instead\n");
+		policy = ERROR_CHECK_FRAME;
+	}
+#else
+	if( policy == ERROR_CHECK_KHR_DEBUG )
+	{
+		policy = ERROR_CHECK_FRAME;
+	}
+#endif
+
+	errorCheckPolicy = policy;
+	errorCheckInterval = interval > 0 ? interval : 1;
+	errorCheckCountdown = errorCheckInterval;
+	return errorCheckPolicy;
+}
+
+void OpenGLES_2_0::ReadErrorCheckPolicyFromEnvironment()
+{
+	ErrorCheckPolicy policy = errorCheckPolicy;
+	int interval = errorCheckInterval;
+
+	const char* setting = getenv("BD_GL_ERRORS");
+	if( setting != NULL )
+	{
+		if( strcmp(setting,"off") == 0 )
+			policy = ERROR_CHECK_OFF;
+		else if( strcmp(setting,"frame") == 0 )
+			policy = ERROR_CHECK_FRAME;
+		else if( strcmp(setting,"all") == 0 )
+			policy = ERROR_CHECK_EVERY_CALL;
+		else if( strcmp(setting,"debug") == 0 )
+			policy = ERROR_CHECK_KHR_DEBUG;
+		else if( atoi(setting) > 0 )
+		{
+			policy = ERROR_CHECK_EVERY_N;
+			interval = atoi(setting);
+		}
+		else
+			printf("BD_GL_ERRORS should be off, frame, all, debug or a number, not %s\n",setting);
+	}
+
+	// Always set, a new context needs the debug callback again.
+	SetErrorCheckPolicy(policy,interval);
+}
+
+#ifdef TARGET_GLES
+void GL_APIENTRY OpenGLES_2_0::DebugMessage(GLenum source,GLenum type,GLuint id,GLenum severity,GLsizei length,const GLchar* message,const void* userParam)
+{
+	if( type == GL_DEBUG_TYPE_ERROR_KHR )
+	{
+		errorCount++;
+		printf("\n**********************\nGL error after line %d file %s\n%s\n**********************\n",lastCheckLine,lastCheckFile,message);
+	}
+	else if( severity == GL_DEBUG_SEVERITY_HIGH_KHR || severity == GL_DEBUG_SEVERITY_MEDIUM_KHR )
+	{
+		printf("GL debug, after line %d file %s: %s\n",lastCheckLine,lastCheckFile,message);
+	}
+}
+#endif //#ifdef TARGET_GLES
+
 bool OpenGLES_2_0::OpenGLES(bool syncWithDisplay)
 {
 #ifdef TARGET_GLES
 
+#ifdef PLATFORM_MESA
 	struct gbm_device *gbm = NULL;
 
 	int fd = open("/dev/dri/card0", O_RDWR | FD_CLOEXEC);
@@ -445,15 +798,16 @@ bool OpenGLES_2_0::OpenGLES(bool syncWithDisplay)
 		std::cout << "eglGetPlatformDisplayEXT failed" << std::endl;
 		return false;
 	}
-
-/*	m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+#else
+	m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 
 	if( m_display == EGL_NO_DISPLAY )
 	{
 		std::cout << "Error: Couldn\'t open the EGL default display" << std::endl;
 		return false;
 	}
-*/
+#endif //#ifdef PLATFORM_MESA
+
 	//Now we have a display lets initialize it.
 	if( !eglInitialize(m_display, &m_major_version, &m_minor_version) )
 	{
@@ -463,7 +817,7 @@ bool OpenGLES_2_0::OpenGLES(bool syncWithDisplay)
 
 	printf("m_major_version(%d) m_minor_version(%d)\n",m_major_version, m_minor_version);
 
-	if( !GetGLConfig() )
+	if( !GetGLConfig(EGL_WINDOW_BIT) )
 	{
 		return false;
 	}
@@ -522,7 +876,7 @@ bool OpenGLES_2_0::OpenGLES(bool syncWithDisplay)
 	vc_dispmanx_update_submit_sync( dispman_update );
 #endif //PLATFORM_BCM_HOST
 
-#ifdef PLATFORM_MESA
+#if defined(PLATFORM_MESA) || defined(PLATFORM_NULL)
 	m_native_window = 0;
 #endif
 
@@ -575,7 +929,107 @@ bool OpenGLES_2_0::OpenGLES(bool syncWithDisplay)
 #endif //#ifdef TARGET_GL
 }
 
-bool OpenGLES_2_0::GetGLConfig()
+bool OpenGLES_2_0::OpenGLESHeadless()
+{
+#ifdef TARGET_GLES
+	m_surface = EGL_NO_SURFACE;
+	m_display = EGL_NO_DISPLAY;
+
+	// Surfaceless needs no display server or DRM device at all.
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY,EGL_EXTENSIONS);
+	const bool surfaceless = clientExtensions != NULL && strstr(clientExtensions,"EGL_MESA_platform_surfaceless") != NULL;
+	if( surfaceless )
+	{
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if( getPlatformDisplay != NULL )
+		{
+			m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,EGL_DEFAULT_DISPLAY,NULL);
+		}
+	}
+
+	if( m_display == EGL_NO_DISPLAY )
+	{
+		m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	if( m_display == EGL_NO_DISPLAY || !eglInitialize(m_display,&m_major_version,&m_minor_version) )
+	{
+		printf("Error: could not open an EGL display for headless rendering\n");
+		return false;
+	}
+	printf("Headless EGL %d.%d, %s\n",m_major_version,m_minor_version,surfaceless ? "surfaceless" : "pbuffer");
+
+	if( !GetGLConfig(EGL_PBUFFER_BIT) )
+	{
+		return false;
+	}
+
+	eglBindAPI(EGL_OPENGL_ES_API);
+
+	EGLint contextAttribs[] = { EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE };
+	m_context = eglCreateContext(m_display,m_config,EGL_NO_CONTEXT,contextAttribs);
+	if( m_context == EGL_NO_CONTEXT )
+	{
+		printf("Error: Failed to get a rendering context\n");
+		return false;
+	}
+
+	// We draw into our own frame buffer so the surface is only needed where the driver can not do without one.
+	const char* extensions = eglQueryString(m_display,EGL_EXTENSIONS);
+	if( extensions == NULL || strstr(extensions,"EGL_KHR_surfaceless_context") == NULL )
+	{
+		const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		m_surface = eglCreatePbufferSurface(m_display,m_config,pbufferAttribs);
+		if( m_surface == EGL_NO_SURFACE )
+		{
+			printf("Error: Failed to create a pbuffer surface\n");
+			return false;
+		}
+	}
+
+	if( !eglMakeCurrent(m_display,m_surface,m_surface,m_context) )
+	{
+		printf("Error: eglMakeCurrent failed 0x%x\n",eglGetError());
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif //#ifdef TARGET_GLES
+}
+
+bool OpenGLES_2_0::CreateBackBuffer()
+{
+	glGenTextures(1,&m_colourTexture);
+	stateCache.BindTexture(0,m_colourTexture);
+	glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA,m_info.width,m_info.height,0,GL_RGBA,GL_UNSIGNED_BYTE,NULL);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+	stateCache.BindTexture(0,0);
+
+	// 24 bit depth if we can, 16 is all GLES 2.0 has to support.
+	glGenRenderbuffers(1,&m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER,m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER,HasExtension("GL_OES_depth24") ? 0x81A6/*GL_DEPTH_COMPONENT24_OES*/ : GL_DEPTH_COMPONENT16,m_info.width,m_info.height);
+
+	glGenFramebuffers(1,&m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER,m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,GL_TEXTURE_2D,m_colourTexture,0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER,GL_DEPTH_ATTACHMENT,GL_RENDERBUFFER,m_depthBuffer);
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if( status != GL_FRAMEBUFFER_COMPLETE )
+	{
+		printf("Error: headless frame buffer incomplete 0x%x\n",status);
+		return false;
+	}
+
+	glViewport(0,0,m_info.width,m_info.height);
+	CHECK_OGL_ERRORS();
+	return true;
+}
+
+bool OpenGLES_2_0::GetGLConfig(int surfaceType)
 {
 #ifdef TARGET_GLES
 
@@ -593,6 +1047,7 @@ bool OpenGLES_2_0::GetGLConfig()
 			EGL_DEPTH_SIZE,			depths_32_to_16[c],
 			EGL_CONFORMANT,			EGL_OPENGL_ES2_BIT,
 			EGL_RENDERABLE_TYPE,	EGL_OPENGL_ES2_BIT,
+			EGL_SURFACE_TYPE,		surfaceType,
 			EGL_NONE,				EGL_NONE
 		};
 
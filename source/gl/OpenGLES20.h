@@ -23,12 +23,14 @@
 #define OPENGLES20_H_
 
 #include "GLHeaders.h"
+#include "GLStateCache.h"
+#include "FrameStats.h"
 
-//#ifdef _DEBUG
-//	#define CHECK_OGL_ERRORS()	BogDog::OpenGLES_2_0::ReadOGLErrors(__FILE__,__LINE__)
-//#else
-	#define CHECK_OGL_ERRORS()
-//#endif
+/*
+ * What this does depends on the error check policy, see OpenGLES_2_0::SetErrorCheckPolicy.
+ * When it is off this is one compare, so leave them in.
+ */
+#define CHECK_OGL_ERRORS()	BogDog::OpenGLES_2_0::CheckOGLErrors(__FILE__,__LINE__)
 
 namespace BogDog
 {
@@ -107,6 +109,18 @@ typedef enum
 	TEX_INVALID = 0x7fffffff,
 }TextureFormat;
 
+/*
+ * How often GL is asked for errors. glGetError waits for the GPU on some drivers so asking after every call is slow.
+ */
+typedef enum
+{
+	ERROR_CHECK_OFF,
+	ERROR_CHECK_FRAME,			// Once a frame in Update, reported with the last CHECK_OGL_ERRORS passed.
+	ERROR_CHECK_EVERY_N,		// Every Nth CHECK_OGL_ERRORS.
+	ERROR_CHECK_EVERY_CALL,		// Every CHECK_OGL_ERRORS.
+	ERROR_CHECK_KHR_DEBUG,		// The driver calls back as the error happens, needs GL_KHR_debug.
+}ErrorCheckPolicy;
+
 struct LoadedImage;
 
 struct OpenGLES_2_0
@@ -123,19 +137,67 @@ struct OpenGLES_2_0
 
 	bool Create(bool syncWithDisplay);
 
-	void SetBlendMode(BLENDMODE mode);
+	/*!
+	 * Creates a context that draws to an offscreen frame buffer, no display or GPU is needed so it runs on Mesa llvmpipe.
+	 * Uses EGL_MESA_platform_surfaceless when the driver has it, else a pbuffer on the default display.
+	 * Either way the frame is drawn into a frame buffer object of the size asked for, read it back with ReadFrame.
+	 * Update does not swap, there is nothing to show it on.
+	 */
+	bool CreateHeadless(int width,int height);
+
+	bool IsHeadless(){return m_headless;}
+
+	/*!
+	 * The frame buffer object drawn to when headless, 0 when drawing to the display.
+	 */
+	GLuint GetFramebuffer(){return m_framebuffer;}
+
+	static void SetBlendMode(BLENDMODE mode);
 
 	void Update();
+
+	/*!
+	 * Makes the context made by Create current on the calling thread so another thread can do the GL work.
+	 * The thread that had it must call ReleaseCurrent first, a context can only be current on one thread.
+	 * @return false if the context could not be moved, the GLUT build can not move it.
+	 */
+	bool MakeCurrent();
+	void ReleaseCurrent();
+
+	/*!
+	 * Sets how many display refreshes a swap waits for, 0 for none. Create sets 1 or 0 from syncWithDisplay.
+	 * Call on the thread that has the context.
+	 */
+	void SetSwapInterval(int interval);
 	void Clear(uint32_t pRed, uint32_t pGreen, uint32_t pBlue);
 	void Clear(uint32_t pColour);
 	void ClearZ();
 
 	float GetAspectRatio(){return (float)m_info.width / (float)m_info.height;}
+	int GetWidth(){return m_info.width;}
+	int GetHeight(){return m_info.height;}
+
+	/*!
+	 * Reads the frame drawn so far as 8 bit RGBA, waits for the GPU to finish it.
+	 * @param rgba Room for GetWidth() * GetHeight() * 4 bytes.
+	 * @param topRowFirst GL gives the bottom row first, true flips it so the top row is first as image files want.
+	 */
+	bool ReadFrame(uint8_t* rgba,bool topRowFirst = true);
+
+	/*!
+	 * Swaps the rows of an image over top to bottom, for turning what glReadPixels gives into the order files want.
+	 */
+	static void FlipRows(uint8_t* pixels,int rowBytes,int height);
 
 	GLuint CreateTexture(TextureFormat textureFormat,int width,int height,const GLvoid* pixels,bool mipMap = true,bool filtered = true,bool uvClamp = false);
 
 	GLuint CreateTexture(const LoadedImage& image,bool mipMap = true,bool filtered = true,bool uvClamp = false);
 
+	/*!
+	 * Deletes a texture made by CreateTexture. Textures that are not deleted are listed by GLResources when this object is destroyed.
+	 */
+	void DeleteTexture(GLuint texture);
+
 	/*!
 	 * Get the size of the GL prim type.
 	 *
@@ -144,9 +206,91 @@ struct OpenGLES_2_0
 	 */
 	static int GetGLTypeSize(int type);
 
+	/*!
+	 * The cache all the engine's program, texture, buffer, attribute, blend, depth and cull changes go through.
+	 * Call Invalidate on it if you change any of that state with GL yourself.
+	 */
+	static GLStateCache& GetStateCache(){return stateCache;}
+
+	/*!
+	 * The counters of the last frame Update finished.
+	 */
+	static const FrameStats& GetFrameStats(){return lastFrameStats;}
+
+	/*!
+	 * The last FrameStatsHistory::HISTORY frames, for rolling averages and percentiles.
+	 */
+	static const FrameStatsHistory& GetFrameStatsHistory(){return frameStatsHistory;}
+
+	/*!
+	 * Prints the last frame, the average and the 95th percentile.
+	 */
+	static void PrintFrameStats();
+
+	/*!
+	 * Where the engine draws it counts it, all it draws are triangles.
+	 */
+	static void CountDraw(int vertices)
+	{
+		frameStats.drawCalls++;
+		frameStats.vertices += vertices;
+		frameStats.triangles += vertices / 3;
+	}
+
+	static void CountBufferUpload(size_t bytes)
+	{
+		frameStats.bufferBytes += (uint32_t)bytes;
+	}
+
+	static void CountTextureUpload(size_t bytes)
+	{
+		frameStats.textureBytes += (uint32_t)bytes;
+	}
+
 
 	static void ReadOGLErrors(const char *pSource_file_name,int pLine_number);
 
+	/*!
+	 * Sets how GL errors are found, can be changed at any time once created.
+	 * The BD_GL_ERRORS environment variable sets it when the context is made, off, frame, all, debug or a number for every Nth.
+	 * ERROR_CHECK_KHR_DEBUG falls back to ERROR_CHECK_FRAME when the driver does not have GL_KHR_debug.
+	 * @param interval For ERROR_CHECK_EVERY_N, how many CHECK_OGL_ERRORS between checks.
+	 * @return The policy now in use.
+	 */
+	static ErrorCheckPolicy SetErrorCheckPolicy(ErrorCheckPolicy policy,int interval = 100);
+
+	static ErrorCheckPolicy GetErrorCheckPolicy(){return errorCheckPolicy;}
+
+	/*!
+	 * @return The number of GL errors reported since the context was made.
+	 */
+	static int GetErrorCount(){return errorCount;}
+
+	/*!
+	 * What CHECK_OGL_ERRORS calls, checks for errors if the policy says it is time.
+	 */
+	static void CheckOGLErrors(const char* file,int line)
+	{
+		if( errorCheckPolicy == ERROR_CHECK_OFF )
+			return;
+
+		lastCheckFile = file;
+		lastCheckLine = line;
+		if( errorCheckPolicy == ERROR_CHECK_EVERY_CALL || (errorCheckPolicy == ERROR_CHECK_EVERY_N && --errorCheckCountdown <= 0) )
+		{
+			errorCheckCountdown = errorCheckInterval;
+			ReadOGLErrors(file,line);
+		}
+	}
+
+	/*!
+	 * Checks the GL extension string for an extension.
+	 * Needs the GL context to have been created.
+	 * @param name The full name, for example "GL_OES_vertex_half_float".
+	 * @return true if the driver has the extension.
+	 */
+	static bool HasExtension(const char* name);
+
 	static int PixelSizeFromFormat(TextureFormat format)
 	{
 		switch(format)
@@ -185,10 +329,39 @@ private:
     EGL_DISPMANX_WINDOW_T m_native_window;			//!<The RPi window object needed to create the render surface.
 #endif
 
-#ifdef PLATFORM_MESA // sudo apt install libgles2-mesa-dev
+#if defined(PLATFORM_MESA) || defined(PLATFORM_NULL) // sudo apt install libgles2-mesa-dev
 	EGLNativeWindowType m_native_window;
 #endif
 
+	static GLStateCache stateCache;
+
+	static FrameStats frameStats;				//!<The frame being drawn.
+	static FrameStats lastFrameStats;
+	static FrameStatsHistory frameStatsHistory;
+	static int frameStartIssued[3];				//!<The state cache's program, texture and uniform counts when the frame started.
+
+	/*!
+	 * Finishes the frame's stats and starts the next.
+	 */
+	static void EndFrameStats(float swapMilliseconds);
+
+	static ErrorCheckPolicy errorCheckPolicy;
+	static int errorCheckInterval;
+	static int errorCheckCountdown;
+	static int errorCount;
+	static const char* lastCheckFile;			//!<Where the last CHECK_OGL_ERRORS was, errors found later happened after it.
+	static int lastCheckLine;
+
+	static void ReadErrorCheckPolicyFromEnvironment();
+#ifdef TARGET_GLES
+	static void GL_APIENTRY DebugMessage(GLenum source,GLenum type,GLuint id,GLenum severity,GLsizei length,const GLchar* message,const void* userParam);
+#endif
+
+	bool m_headless;
+	GLuint m_framebuffer;						//!<The offscreen back buffer when headless.
+	GLuint m_colourTexture;
+	GLuint m_depthBuffer;
+
 	struct
 	{
     	int width,height;
@@ -196,7 +369,14 @@ private:
 	}m_info;
 
 	bool OpenGLES(bool syncWithDisplay);
-	bool GetGLConfig();
+	bool OpenGLESHeadless();
+	bool CreateBackBuffer();
+	bool GetGLConfig(int surfaceType);
+
+	/*!
+	 * Sets the GL state every context starts with, called once the context is current.
+	 */
+	void InitialiseState();
 
 };
 
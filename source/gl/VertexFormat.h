@@ -0,0 +1,395 @@
+/*
+ * VertexFormat.h
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *	Compile time vertex formats. A format is a list of attributes, for example VertexFormat<Pos3f,ColourU8x4,UV2f>.
+ *	The vertices are interleaved into one buffer, the stride and the offset of each attribute are worked out by the compiler
+ *	so enabling the streams is a fixed sequence of glVertexAttribPointer calls with no loops or branches.
+ */
+
+#ifndef __VERTEXFORMAT_H__
+#define __VERTEXFORMAT_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <utility>
+#include "GLHeaders.h"
+#include "gl/OpenGLES20.h"
+#include "gl/GLShader.h"
+#include "maths/Vector2.h"
+#include "maths/Vector3.h"
+#include "maths/Maths.h"
+
+//From GL_OES_vertex_half_float, only use the half formats if OpenGLES_2_0::HasExtension says it's there.
+#ifndef GL_HALF_FLOAT_OES
+	#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+
+namespace BogDog
+{
+
+/**
+ * The data for one vertex before it is written out in a vertex format.
+ * Each attribute type picks the bits it needs from this.
+ */
+struct VertexSource
+{
+	Vector3 xyz;
+	int colour;//As per GLES ABGR
+	Vector2 uv0;
+	int instance;//Which copy of the mesh, for instanced meshes.
+};
+
+/**
+ * Vertex position as three floats.
+ */
+struct Pos3f
+{
+	enum
+	{
+		LOCATION = ATTRIB_POS,
+		COMPONENTS = 3,
+		DATA_TYPE = GL_FLOAT,
+		NORMALISED = GL_FALSE,
+		SIZE = 12,
+		QUANTISED_POSITION = 0
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		float xyz[3] = {source.xyz.x,source.xyz.y,source.xyz.z};
+		memcpy(dest,xyz,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		float xyz[3];
+		memcpy(xyz,src,SIZE);
+		dest.xyz.Set(xyz[0],xyz[1],xyz[2]);
+	}
+};
+
+/**
+ * Vertex colour as four bytes, ABGR as GL wants it.
+ */
+struct ColourU8x4
+{
+	enum
+	{
+		LOCATION = ATTRIB_COLOUR,
+		COMPONENTS = 4,
+		DATA_TYPE = GL_UNSIGNED_BYTE,
+		NORMALISED = GL_TRUE,
+		SIZE = 4,
+		QUANTISED_POSITION = 0
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		memcpy(dest,&source.colour,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		memcpy(&dest.colour,src,SIZE);
+	}
+};
+
+/**
+ * Texture coordinates as two floats.
+ */
+struct UV2f
+{
+	enum
+	{
+		LOCATION = ATTRIB_UV0,
+		COMPONENTS = 2,
+		DATA_TYPE = GL_FLOAT,
+		NORMALISED = GL_FALSE,
+		SIZE = 8,
+		QUANTISED_POSITION = 0
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		float uv[2] = {source.uv0.x,source.uv0.y};
+		memcpy(dest,uv,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		float uv[2];
+		memcpy(uv,src,SIZE);
+		dest.uv0.Set(uv[0],uv[1]);
+	}
+};
+
+/**
+ * Vertex position as three normalised shorts, padded to eight bytes.
+ * The position written must already be in the range -1 to 1, the mesh holds the scale and offset to get it back.
+ * ShapeBuilder does this for you from the bounds of the shape.
+ */
+struct Pos3s16
+{
+	enum
+	{
+		LOCATION = ATTRIB_POS,
+		COMPONENTS = 3,
+		DATA_TYPE = GL_SHORT,
+		NORMALISED = GL_TRUE,
+		SIZE = 8,
+		QUANTISED_POSITION = 1
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		int16_t xyz[4] = {Quantise(source.xyz.x),Quantise(source.xyz.y),Quantise(source.xyz.z),0};
+		memcpy(dest,xyz,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		int16_t xyz[4];
+		memcpy(xyz,src,SIZE);
+		dest.xyz.Set(Dequantise(xyz[0]),Dequantise(xyz[1]),Dequantise(xyz[2]));
+	}
+
+	static int16_t Quantise(float value)
+	{
+		return (int16_t)lrintf(md_clamp(value,-1.0f,1.0f) * 32767.0f);
+	}
+
+	//As GL does it, -32768 and -32767 are both -1.
+	static float Dequantise(int16_t value)
+	{
+		return md_clamp(value / 32767.0f,-1.0f,1.0f);
+	}
+};
+
+/**
+ * Vertex position as three half floats, padded to eight bytes. Needs GL_OES_vertex_half_float.
+ */
+struct Pos3h
+{
+	enum
+	{
+		LOCATION = ATTRIB_POS,
+		COMPONENTS = 3,
+		DATA_TYPE = GL_HALF_FLOAT_OES,
+		NORMALISED = GL_FALSE,
+		SIZE = 8,
+		QUANTISED_POSITION = 0
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		uint16_t xyz[4] = {md_Maths_FloatToHalf(source.xyz.x),md_Maths_FloatToHalf(source.xyz.y),md_Maths_FloatToHalf(source.xyz.z),0};
+		memcpy(dest,xyz,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		uint16_t xyz[4];
+		memcpy(xyz,src,SIZE);
+		dest.xyz.Set(md_Maths_HalfToFloat(xyz[0]),md_Maths_HalfToFloat(xyz[1]),md_Maths_HalfToFloat(xyz[2]));
+	}
+};
+
+/**
+ * Texture coordinates as two normalised unsigned shorts, only for uv's in the range 0 to 1. Anything outside is clamped.
+ */
+struct UV2u16
+{
+	enum
+	{
+		LOCATION = ATTRIB_UV0,
+		COMPONENTS = 2,
+		DATA_TYPE = GL_UNSIGNED_SHORT,
+		NORMALISED = GL_TRUE,
+		SIZE = 4,
+		QUANTISED_POSITION = 0
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		uint16_t uv[2] = {Quantise(source.uv0.x),Quantise(source.uv0.y)};
+		memcpy(dest,uv,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		uint16_t uv[2];
+		memcpy(uv,src,SIZE);
+		dest.uv0.Set(uv[0] / 65535.0f,uv[1] / 65535.0f);
+	}
+
+	static uint16_t Quantise(float value)
+	{
+		return (uint16_t)lrintf(md_clamp(value,0.0f,1.0f) * 65535.0f);
+	}
+};
+
+/**
+ * Texture coordinates as two half floats. Needs GL_OES_vertex_half_float.
+ */
+struct UV2h
+{
+	enum
+	{
+		LOCATION = ATTRIB_UV0,
+		COMPONENTS = 2,
+		DATA_TYPE = GL_HALF_FLOAT_OES,
+		NORMALISED = GL_FALSE,
+		SIZE = 4,
+		QUANTISED_POSITION = 0
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		uint16_t uv[2] = {md_Maths_FloatToHalf(source.uv0.x),md_Maths_FloatToHalf(source.uv0.y)};
+		memcpy(dest,uv,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		uint16_t uv[2];
+		memcpy(uv,src,SIZE);
+		dest.uv0.Set(md_Maths_HalfToFloat(uv[0]),md_Maths_HalfToFloat(uv[1]));
+	}
+};
+
+/**
+ * Which copy of the geometry a vertex belongs to in an instanced mesh, one byte padded to four.
+ * The shader uses it to index the per instance uniforms, see GLShader::DrawInstanced.
+ */
+struct InstanceIndex
+{
+	enum
+	{
+		LOCATION = ATTRIB_INSTANCE,
+		COMPONENTS = 1,
+		DATA_TYPE = GL_UNSIGNED_BYTE,
+		NORMALISED = GL_FALSE,
+		SIZE = 4,
+		QUANTISED_POSITION = 0
+	};
+
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		uint8_t index[4] = {(uint8_t)source.instance,0,0,0};
+		memcpy(dest,index,SIZE);
+	}
+
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		dest.instance = src[0];
+	}
+};
+
+/**
+ * The format of an interleaved vertex, made from a list of the attribute types above.
+ * All sizes are a multiple of four bytes so every attribute is word aligned, GLES drivers can be very slow otherwise.
+ */
+template <class... ATTRIBS> struct VertexFormat
+{
+	/**
+	 * Size of one vertex in bytes.
+	 */
+	static constexpr int STRIDE = (0 + ... + ATTRIBS::SIZE);
+
+	/**
+	 * Bit mask of the attribute locations this format supplies, bit n is location n.
+	 */
+	static constexpr uint32_t ATTRIB_MASK = (0 | ... | (1u<<ATTRIBS::LOCATION));
+
+	/**
+	 * True if the position is stored in the range -1 to 1 and the mesh has to scale it back.
+	 */
+	static constexpr bool QUANTISED_POSITION = (false || ... || ATTRIBS::QUANTISED_POSITION);
+
+	/**
+	 * Returns the byte offset of the attribute at index in the list.
+	 */
+	static constexpr int OffsetOf(size_t index)
+	{
+		constexpr int sizes[] = {ATTRIBS::SIZE...};
+		int offset = 0;
+		for( size_t n = 0 ; n < index ; n++ )
+		{
+			offset += sizes[n];
+		}
+		return offset;
+	}
+
+	/**
+	 * Writes one vertex to dest, dest must have STRIDE bytes free.
+	 */
+	static void Write(uint8_t* dest,const VertexSource& source)
+	{
+		WriteAttributes(dest,source,std::index_sequence_for<ATTRIBS...>());
+	}
+
+	/**
+	 * Reads one vertex back from src. Attributes not in the format are left as white, a uv of 0,0 and instance 0.
+	 * Quantised positions come back in the range -1 to 1.
+	 */
+	static void Read(const uint8_t* src,VertexSource& dest)
+	{
+		dest.colour = -1;
+		dest.uv0.Set(0.0f,0.0f);
+		dest.instance = 0;
+		ReadAttributes(src,dest,std::index_sequence_for<ATTRIBS...>());
+	}
+
+	/**
+	 * Sets the vertex streams for the currently bound array buffer.
+	 * Locations that this format does not supply are disabled so they do not read the last mesh's data.
+	 * @param baseOffset The byte offset into the buffer of the first vertex.
+	 */
+	static void Enable(int baseOffset)
+	{
+		EnableAttributes(baseOffset,std::index_sequence_for<ATTRIBS...>());
+		OpenGLES_2_0::GetStateCache().SetAttribMask(ATTRIB_MASK);
+		CHECK_OGL_ERRORS();
+	}
+
+private:
+	template <size_t... INDEX> static void WriteAttributes(uint8_t* dest,const VertexSource& source,std::index_sequence<INDEX...>)
+	{
+		(ATTRIBS::Write(dest + OffsetOf(INDEX),source),...);
+	}
+
+	template <size_t... INDEX> static void ReadAttributes(const uint8_t* src,VertexSource& dest,std::index_sequence<INDEX...>)
+	{
+		(ATTRIBS::Read(src + OffsetOf(INDEX),dest),...);
+	}
+
+	template <size_t... INDEX> static void EnableAttributes(int baseOffset,std::index_sequence<INDEX...>)
+	{
+		(EnableAttribute<ATTRIBS,OffsetOf(INDEX)>(baseOffset),...);
+	}
+
+	template <class ATTRIB,int OFFSET> static void EnableAttribute(int baseOffset)
+	{
+		glVertexAttribPointer(ATTRIB::LOCATION,ATTRIB::COMPONENTS,ATTRIB::DATA_TYPE,ATTRIB::NORMALISED,STRIDE,(const GLvoid*)(size_t)(baseOffset + OFFSET));
+	}
+};
+
+} /* namespace BogDog */
+#endif /* __VERTEXFORMAT_H__ */
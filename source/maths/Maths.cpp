@@ -20,6 +20,7 @@
 
 #include <assert.h>
 #include <float.h>
+#include <string.h>
 #include "./maths/Maths.h"
 #include "./maths/Vector3.h"
 
@@ -398,5 +399,83 @@ int target_less_angle;
 
 	return ( pTarget != rAngle );
 }
+
+uint16_t md_Maths_FloatToHalf(float pValue)
+{
+uint32_t bits;
+
+	memcpy(&bits,&pValue,sizeof(bits));
+
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x007fffff;
+
+	if( ((bits >> 23) & 0xff) == 0xff )
+	{//NaN or infinity.
+		return (uint16_t)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+	}
+
+	if( exponent >= 0x1f )
+	{//Too big, infinity.
+		return (uint16_t)(sign | 0x7c00);
+	}
+
+	if( exponent <= 0 )
+	{//Denormal or zero.
+		if( exponent < -10 )
+			return (uint16_t)sign;
+
+		mantissa |= 0x00800000;
+		const int shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+		if( (mantissa >> (shift - 1)) & 1 )//Round.
+			half++;
+		return (uint16_t)(sign | half);
+	}
+
+	uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+	if( mantissa & 0x00001000 )//Round, a carry into the exponent is still correct.
+		half++;
+	return (uint16_t)half;
+}
+
+float md_Maths_HalfToFloat(uint16_t pValue)
+{
+	const uint32_t sign = (uint32_t)(pValue & 0x8000) << 16;
+	int exponent = (pValue >> 10) & 0x1f;
+	uint32_t mantissa = pValue & 0x3ff;
+	uint32_t bits;
+
+	if( exponent == 0x1f )
+	{//NaN or infinity.
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if( exponent == 0 )
+	{
+		if( mantissa == 0 )
+		{//Zero.
+			bits = sign;
+		}
+		else
+		{//Denormal, normalise it.
+			exponent = 1;
+			while( (mantissa & 0x400) == 0 )
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			mantissa &= 0x3ff;
+			bits = sign | ((uint32_t)(exponent - 15 + 127) << 23) | (mantissa << 13);
+		}
+	}
+	else
+	{
+		bits = sign | ((uint32_t)(exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	float value;
+	memcpy(&value,&bits,sizeof(value));
+	return value;
+}
 // ---------------------------------------------------------------------------
 };//namespace BogDog{
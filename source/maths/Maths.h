@@ -21,6 +21,7 @@
 #define __MATHS_H__
 
 #include <stddef.h>
+#include <stdint.h>
 #include <math.h>
 
 namespace BogDog{
@@ -87,6 +88,12 @@ extern int md_Maths_ColourLerp(int pColourA,int pColourB,float pFrac);//Could'nt
 //Returns TRUE is rAngle changed, else FALSE.
 extern int md_Maths_RotateViaShortestDistance(const float pTarget,const float pStep,float &rAngle,const float pMax = 360.0f);
 
+//Converts to a 16 bit IEEE half float, rounds to nearest. Too big goes to infinity, too small to zero.
+extern uint16_t md_Maths_FloatToHalf(float pValue);
+
+//Converts a 16 bit IEEE half float back to a float, exact.
+extern float md_Maths_HalfToFloat(uint16_t pValue);
+
 // ---------------------------------------------------------------------------
 };//namespace BogDog{
 #endif//#ifndef __MATHS_H__
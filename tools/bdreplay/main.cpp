@@ -0,0 +1,496 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Plays back a trace recorded with GLTrace, build with Replay.proj.
+ * The calls are made as fast as they can be, there is no waiting for the times they were recorded at.
+ * Runs headless at the size the trace was recorded at unless -display is given.
+ *
+ * bdreplay trace.bdt [-display] [-frames N] [-calls]
+ * -frames stops after N frames, -calls times every call and prints the cost of each kind next to the recorded cost.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "BogDog.h"
+
+using namespace BogDog;
+
+static uint64_t NowNanoseconds()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return ((uint64_t)t.tv_sec * 1000000000ull) + t.tv_nsec;
+}
+
+/**
+ * @return The record after the one at next, NULL if the one at next is not all there, as when the recording was killed.
+ */
+static const uint8_t* NextRecord(const uint8_t* next,const uint8_t* end)
+{
+	const size_t left = end - next;
+	if( left < sizeof(GLTraceRecord) )
+	{
+		return NULL;
+	}
+
+	const GLTraceRecord* record = (const GLTraceRecord*)next;
+	const size_t bytes = sizeof(GLTraceRecord) + (record->argCount * sizeof(uint32_t)) + (((size_t)record->payloadBytes + 3) & ~(size_t)3);
+	return bytes <= left ? next + bytes : NULL;
+}
+
+/**
+ * The names in the trace to the names this context gave out, names are small numbers so it's a flat array.
+ */
+struct NameMap
+{
+	GLuint Get(uint32_t traced)
+	{
+		return traced < names.GetSize() ? names[traced] : 0;
+	}
+
+	void Set(uint32_t traced,GLuint name)
+	{
+		while( names.GetSize() <= traced )
+			names.PushBack((GLuint)0);
+		names[traced] = name;
+	}
+
+private:
+	DynamicBuffer<GLuint,256,256> names;
+};
+
+struct CallStats
+{
+	uint64_t count;
+	uint64_t recordedNanoseconds;
+	uint64_t replayNanoseconds;
+};
+
+struct Replay
+{
+	static const int MAX_LOCATIONS = 1024;
+
+	OpenGLES_2_0& gl;
+	bool timeCalls;
+	bool traceSwaps;		//!<The trace has eglSwapBuffers, else it was headless and frames are only marked.
+	int frames;
+	uint64_t recordedFrameNanoseconds;
+	CallStats calls[TRACE_CALL_COUNT];
+
+	Replay(OpenGLES_2_0& pGL,bool pTimeCalls) :
+		gl(pGL),
+		timeCalls(pTimeCalls),
+		traceSwaps(false),
+		frames(0),
+		recordedFrameNanoseconds(0),
+		currentProgram(0)
+	{
+		memset(calls,0,sizeof(calls));
+	}
+
+	~Replay()
+	{
+		for( size_t n = 0 ; n < locations.GetSize() ; n++ )
+		{
+			delete []locations[n];
+		}
+	}
+
+	/**
+	 * Plays the records from data to the end or until maxFrames have been played, 0 for all of them.
+	 * A trace that is cut short is played up to the last complete record.
+	 * @return false if the trace is not a valid GLTrace file.
+	 */
+	bool Play(const uint8_t* data,size_t size,int maxFrames)
+	{
+		const GLTraceHeader* header = (const GLTraceHeader*)data;
+		if( size < sizeof(GLTraceHeader) || memcmp(header->magic,"BDGT",4) != 0 || header->version != GLTRACE_VERSION )
+		{
+			printf("Not a BogDog GL trace, or the wrong version\n");
+			return false;
+		}
+
+		const uint8_t* end = data + size;
+		const uint8_t* next = data + sizeof(GLTraceHeader);
+		while( next < end )
+		{
+			const GLTraceRecord* record = (const GLTraceRecord*)next;
+			const uint8_t* after = NextRecord(next,end);
+			if( after == NULL || record->call >= TRACE_CALL_COUNT )
+			{
+				printf("WARNING: trace is cut short or corrupt %zu bytes in, stopping at the last complete record\n",(size_t)(next - data));
+				break;
+			}
+			const uint32_t* args = (const uint32_t*)(record + 1);
+			const uint8_t* payload = (const uint8_t*)(args + record->argCount);
+			next = after;
+
+			if( record->call == TRACE_EndFrame )
+			{
+				recordedFrameNanoseconds += record->startDelta;
+				if( !traceSwaps )
+				{
+					gl.Update();
+				}
+				frames++;
+				if( maxFrames > 0 && frames >= maxFrames )
+					break;
+				continue;
+			}
+			recordedFrameNanoseconds += record->startDelta;
+
+			CallStats& stats = calls[record->call];
+			stats.count++;
+			stats.recordedNanoseconds += record->duration;
+			if( timeCalls )
+			{
+				const uint64_t start = NowNanoseconds();
+				Call(record->call,args,payload,record->payloadBytes);
+				stats.replayNanoseconds += NowNanoseconds() - start;
+			}
+			else
+			{
+				Call(record->call,args,payload,record->payloadBytes);
+			}
+		}
+		glFinish();
+
+		const GLenum error = glGetError();
+		if( error != GL_NO_ERROR )
+		{
+			printf("GL error 0x%x during the replay, the driver may not support everything the trace uses\n",error);
+		}
+		return true;
+	}
+
+	/**
+	 * Looks for the size the trace was recorded at and if it presents with eglSwapBuffers.
+	 */
+	void Scan(const uint8_t* data,size_t size,int& width,int& height)
+	{
+		if( size < sizeof(GLTraceHeader) )
+		{
+			return;
+		}
+
+		const uint8_t* end = data + size;
+		const uint8_t* next = data + sizeof(GLTraceHeader);
+		for( const uint8_t* after = NextRecord(next,end) ; after != NULL ; next = after , after = NextRecord(next,end) )
+		{
+			const GLTraceRecord* record = (const GLTraceRecord*)next;
+			const uint32_t* args = (const uint32_t*)(record + 1);
+			if( record->call == TRACE_SurfaceSize && record->argCount == 2 )
+			{
+				width = (int)args[0];
+				height = (int)args[1];
+			}
+			else if( record->call == TRACE_eglSwapBuffers )
+			{
+				traceSwaps = true;
+			}
+		}
+	}
+
+	void PrintReport(double seconds)
+	{
+		printf("Replayed %d frames in %.3f seconds, %.1f fps\n",frames,seconds,frames > 0 ? frames / seconds : 0.0);
+		if( frames > 0 )
+		{
+			printf("Frame time recorded %.3fms replayed %.3fms\n",(recordedFrameNanoseconds / 1000000.0) / frames,(seconds * 1000.0) / frames);
+		}
+
+		printf("%-28s %10s %14s %14s\n","Call","Count","Recorded ms",timeCalls ? "Replayed ms" : "");
+		for( int n = 0 ; n < TRACE_CALL_COUNT ; n++ )
+		{
+			const CallStats& stats = calls[n];
+			if( stats.count == 0 )
+				continue;
+
+			if( timeCalls )
+				printf("%-28s %10llu %14.3f %14.3f\n",GLTrace::GetCallName(n),(unsigned long long)stats.count,stats.recordedNanoseconds / 1000000.0,stats.replayNanoseconds / 1000000.0);
+			else
+				printf("%-28s %10llu %14.3f\n",GLTrace::GetCallName(n),(unsigned long long)stats.count,stats.recordedNanoseconds / 1000000.0);
+		}
+	}
+
+private:
+	NameMap buffers,textures,framebuffers,renderbuffers,shaders,programs;
+	DynamicBuffer<GLint*,16,16> locations;	//!<Per traced program, the traced uniform location to ours.
+	uint32_t currentProgram;				//!<As traced, uniforms are set on this one.
+	DynamicBuffer<uint8_t> scratch;
+	DynamicBuffer<GLuint,64,64> names;
+
+	void SetLocation(uint32_t program,uint32_t traced,GLint location)
+	{
+		if( (GLint)traced < 0 || traced >= MAX_LOCATIONS )
+		{
+			return;
+		}
+
+		while( locations.GetSize() <= program )
+			locations.PushBack((GLint*)NULL);
+
+		if( locations[program] == NULL )
+		{
+			locations[program] = new GLint[MAX_LOCATIONS];
+			for( int n = 0 ; n < MAX_LOCATIONS ; n++ )
+				locations[program][n] = -1;
+		}
+		locations[program][traced] = location;
+	}
+
+	GLint GetLocation(uint32_t traced)
+	{
+		if( (GLint)traced < 0 || traced >= MAX_LOCATIONS || currentProgram >= locations.GetSize() || locations[currentProgram] == NULL )
+			return -1;
+		return locations[currentProgram][traced];
+	}
+
+	/**
+	 * Makes new names for glGen* and maps the traced ones to them.
+	 */
+	GLuint* GenNames(NameMap& map,uint32_t count,const uint32_t* traced)
+	{
+		GLuint* made = names.Get(count);
+		for( uint32_t n = 0 ; n < count ; n++ )
+			map.Set(traced[n],made[n]);
+		return made;
+	}
+
+	/**
+	 * Maps the traced names for glDelete* and forgets them.
+	 */
+	GLuint* DeleteNames(NameMap& map,uint32_t count,const uint32_t* traced)
+	{
+		GLuint* mapped = names.Get(count);
+		for( uint32_t n = 0 ; n < count ; n++ )
+		{
+			mapped[n] = map.Get(traced[n]);
+			map.Set(traced[n],0);
+		}
+		return mapped;
+	}
+
+	void Call(int call,const uint32_t* a,const uint8_t* payload,uint32_t payloadBytes)
+	{
+		const uint32_t* payloadNames = (const uint32_t*)payload;
+		const float* payloadFloats = (const float*)payload;
+		switch( call )
+		{
+		case TRACE_glActiveTexture:				glActiveTexture(a[0]);break;
+		case TRACE_glAttachShader:				glAttachShader(programs.Get(a[0]),shaders.Get(a[1]));break;
+		case TRACE_glBindAttribLocation:		glBindAttribLocation(programs.Get(a[0]),a[1],(const GLchar*)payload);break;
+		case TRACE_glBindBuffer:				glBindBuffer(a[0],buffers.Get(a[1]));break;
+		case TRACE_glBindFramebuffer:			glBindFramebuffer(a[0],a[1] == 0 ? gl.GetFramebuffer() : framebuffers.Get(a[1]));break;
+		case TRACE_glBindRenderbuffer:			glBindRenderbuffer(a[0],renderbuffers.Get(a[1]));break;
+		case TRACE_glBindTexture:				glBindTexture(a[0],textures.Get(a[1]));break;
+		case TRACE_glBlendEquation:				glBlendEquation(a[0]);break;
+		case TRACE_glBlendFunc:					glBlendFunc(a[0],a[1]);break;
+		case TRACE_glBufferData:				glBufferData(a[0],a[1],a[3] ? payload : NULL,a[2]);break;
+		case TRACE_glBufferSubData:				glBufferSubData(a[0],a[1],a[2],payload);break;
+		case TRACE_glClear:						glClear(a[0]);break;
+		case TRACE_glClearColor:				glClearColor(GLTrace::BitsFloat(a[0]),GLTrace::BitsFloat(a[1]),GLTrace::BitsFloat(a[2]),GLTrace::BitsFloat(a[3]));break;
+		case TRACE_glColorMask:					glColorMask(a[0],a[1],a[2],a[3]);break;
+		case TRACE_glCullFace:					glCullFace(a[0]);break;
+		case TRACE_glDepthFunc:					glDepthFunc(a[0]);break;
+		case TRACE_glDepthMask:					glDepthMask(a[0]);break;
+		case TRACE_glDepthRangef:				glDepthRangef(GLTrace::BitsFloat(a[0]),GLTrace::BitsFloat(a[1]));break;
+		case TRACE_glDisable:					glDisable(a[0]);break;
+		case TRACE_glDisableVertexAttribArray:	glDisableVertexAttribArray(a[0]);break;
+		case TRACE_glDrawArrays:				glDrawArrays(a[0],a[1],a[2]);break;
+		case TRACE_glDrawElements:				glDrawElements(a[0],a[1],a[2],(const GLvoid*)(size_t)a[3]);break;
+		case TRACE_glEnable:					glEnable(a[0]);break;
+		case TRACE_glEnableVertexAttribArray:	glEnableVertexAttribArray(a[0]);break;
+		case TRACE_glFinish:					glFinish();break;
+		case TRACE_glFlush:						glFlush();break;
+		case TRACE_glFramebufferRenderbuffer:	glFramebufferRenderbuffer(a[0],a[1],a[2],renderbuffers.Get(a[3]));break;
+		case TRACE_glFramebufferTexture2D:		glFramebufferTexture2D(a[0],a[1],a[2],textures.Get(a[3]),a[4]);break;
+		case TRACE_glFrontFace:					glFrontFace(a[0]);break;
+		case TRACE_glGenerateMipmap:			glGenerateMipmap(a[0]);break;
+		case TRACE_glPixelStorei:				glPixelStorei(a[0],a[1]);break;
+		case TRACE_glRenderbufferStorage:		glRenderbufferStorage(a[0],a[1],a[2],a[3]);break;
+		case TRACE_glTexParameteri:				glTexParameteri(a[0],a[1],a[2]);break;
+		case TRACE_glTexImage2D:				glTexImage2D(a[0],a[1],a[2],a[3],a[4],a[5],a[6],a[7],payloadBytes ? payload : NULL);break;
+		case TRACE_glTexSubImage2D:				glTexSubImage2D(a[0],a[1],a[2],a[3],a[4],a[5],a[6],a[7],payload);break;
+		case TRACE_glUniform1i:					glUniform1i(GetLocation(a[0]),a[1]);break;
+		case TRACE_glUniform4fv:				glUniform4fv(GetLocation(a[0]),a[1],payloadFloats);break;
+		case TRACE_glUniformMatrix4fv:			glUniformMatrix4fv(GetLocation(a[0]),a[1],a[2],payloadFloats);break;
+		case TRACE_glVertexAttribPointer:		glVertexAttribPointer(a[0],a[1],a[2],a[3],a[4],(const GLvoid*)(size_t)a[5]);break;
+		case TRACE_glViewport:					glViewport(a[0],a[1],a[2],a[3]);break;
+
+		case TRACE_glGenBuffers:				glGenBuffers(a[0],names.Get(a[0]));GenNames(buffers,a[0],payloadNames);break;
+		case TRACE_glGenFramebuffers:			glGenFramebuffers(a[0],names.Get(a[0]));GenNames(framebuffers,a[0],payloadNames);break;
+		case TRACE_glGenRenderbuffers:			glGenRenderbuffers(a[0],names.Get(a[0]));GenNames(renderbuffers,a[0],payloadNames);break;
+		case TRACE_glGenTextures:				glGenTextures(a[0],names.Get(a[0]));GenNames(textures,a[0],payloadNames);break;
+		case TRACE_glDeleteBuffers:				glDeleteBuffers(a[0],DeleteNames(buffers,a[0],payloadNames));break;
+		case TRACE_glDeleteFramebuffers:		glDeleteFramebuffers(a[0],DeleteNames(framebuffers,a[0],payloadNames));break;
+		case TRACE_glDeleteRenderbuffers:		glDeleteRenderbuffers(a[0],DeleteNames(renderbuffers,a[0],payloadNames));break;
+		case TRACE_glDeleteTextures:			glDeleteTextures(a[0],DeleteNames(textures,a[0],payloadNames));break;
+
+		case TRACE_glCreateProgram:
+			programs.Set(a[0],glCreateProgram());
+			break;
+
+		case TRACE_glCreateShader:
+			shaders.Set(a[1],glCreateShader(a[0]));
+			break;
+
+		case TRACE_glDeleteProgram:
+			glDeleteProgram(programs.Get(a[0]));
+			programs.Set(a[0],0);
+			break;
+
+		case TRACE_glDeleteShader:
+			glDeleteShader(shaders.Get(a[0]));
+			shaders.Set(a[0],0);
+			break;
+
+		case TRACE_glShaderSource:
+			{
+				const GLchar* source = (const GLchar*)payload;
+				glShaderSource(shaders.Get(a[0]),1,&source,NULL);
+			}
+			break;
+
+		case TRACE_glCompileShader:
+			{
+				const GLuint shader = shaders.Get(a[0]);
+				glCompileShader(shader);
+				GLint compiled = GL_FALSE;
+				glGetShaderiv(shader,GL_COMPILE_STATUS,&compiled);
+				if( compiled == GL_FALSE )
+				{
+					char log[1024];
+					glGetShaderInfoLog(shader,sizeof(log),NULL,log);
+					printf("Shader %u failed to compile on this driver: %s\n",a[0],log);
+				}
+			}
+			break;
+
+		case TRACE_glLinkProgram:
+			glLinkProgram(programs.Get(a[0]));
+			break;
+
+		case TRACE_glGetUniformLocation:
+			SetLocation(a[0],a[1],glGetUniformLocation(programs.Get(a[0]),(const GLchar*)payload));
+			break;
+
+		case TRACE_glUseProgram:
+			currentProgram = a[0];
+			glUseProgram(programs.Get(a[0]));
+			break;
+
+		case TRACE_glReadPixels:
+			glReadPixels(a[0],a[1],a[2],a[3],a[4],a[5],scratch.Get(GLTrace::GetImageBytes(a[2],a[3],a[4],a[5],4)));
+			break;
+
+		case TRACE_eglSwapBuffers:
+			gl.Update();
+			break;
+
+		case TRACE_SurfaceSize:
+			break;
+		}
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	const char* traceFile = NULL;
+	bool display = false;
+	bool timeCalls = false;
+	int maxFrames = 0;
+	for( int arg = 1 ; arg < argc ; arg++ )
+	{
+		if( strcmp(argv[arg],"-display") == 0 )
+		{
+			display = true;
+		}
+		else if( strcmp(argv[arg],"-calls") == 0 )
+		{
+			timeCalls = true;
+		}
+		else if( strcmp(argv[arg],"-frames") == 0 && arg + 1 < argc )
+		{
+			maxFrames = atoi(argv[++arg]);
+		}
+		else if( argv[arg][0] != '-' && traceFile == NULL )
+		{
+			traceFile = argv[arg];
+		}
+		else
+		{
+			traceFile = NULL;
+			break;
+		}
+	}
+
+	if( traceFile == NULL )
+	{
+		printf("Usage: bdreplay trace.bdt [-display] [-frames N] [-calls]\n");
+		return 1;
+	}
+
+	FILE* file = fopen(traceFile,"rb");
+	if( file == NULL )
+	{
+		printf("Failed to open %s\n",traceFile);
+		return 1;
+	}
+
+	// All of it in memory so reading the trace does not get in the way of the replay.
+	fseek(file,0,SEEK_END);
+	const size_t size = ftell(file);
+	fseek(file,0,SEEK_SET);
+	DynamicBuffer<uint8_t> trace;
+	uint8_t* data = trace.Get(size);
+	const bool read = fread(data,1,size,file) == size;
+	fclose(file);
+	if( !read )
+	{
+		printf("Failed to read %s\n",traceFile);
+		return 1;
+	}
+
+	OpenGLES_2_0 gl;
+	Replay replay(gl,timeCalls);
+
+	int width = 1280,height = 720;
+	replay.Scan(data,size,width,height);
+	if( (display ? gl.Create(false) : gl.CreateHeadless(width,height)) == false )
+	{
+		return 1;
+	}
+
+	const uint64_t start = NowNanoseconds();
+	if( !replay.Play(data,size,maxFrames) )
+	{
+		return 1;
+	}
+	const double seconds = (NowNanoseconds() - start) / 1000000000.0;
+
+	replay.PrintReport(seconds);
+	return 0;
+}
@@ -0,0 +1,231 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Shows the live metrics a BogDog process publishes with LiveMetrics, build with Top.proj.
+ * Only reads the shared memory, the process being watched never waits for it.
+ *
+ * bdtop [name] [-once] [-interval ms]
+ * name is the segment, for example bogdog.1234, without it the first /dev/shm/bogdog.* of a running process is used.
+ * -once prints one report and exits, for scripts.
+ *
+ * A process killed by a signal can't remove it's segment, bdtop skips those. Clear them out with rm /dev/shm/bogdog.*
+ * once nothing is running.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <dirent.h>
+#include "LiveMetrics.h"
+
+using namespace BogDog;
+
+static const int MAX_NAME = 64;
+static const int HISTOGRAM_ROWS = 10;		//!<The 1ms buckets are shown in this many rows.
+static const int BAR_WIDTH = 40;
+
+static uint64_t NowNanoseconds()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return ((uint64_t)t.tv_sec * 1000000000ull) + t.tv_nsec;
+}
+
+static bool IsRunning(uint32_t pid)
+{
+	// EPERM means it is there but belongs to someone else.
+	return kill((pid_t)pid,0) == 0 || errno == EPERM;
+}
+
+/**
+ * Finds the segment of a process that is still running.
+ * @param name Set to the segment's name.
+ * @return The attached segment, NULL if there is none.
+ */
+static const LiveMetricsSegment* FindSegment(char* name)
+{
+	DIR* dir = opendir("/dev/shm");
+	if( dir == NULL )
+	{
+		return NULL;
+	}
+
+	const LiveMetricsSegment* found = NULL;
+	for( struct dirent* entry = readdir(dir) ; entry != NULL && found == NULL ; entry = readdir(dir) )
+	{
+		const size_t length = strlen(entry->d_name);
+		if( strncmp(entry->d_name,"bogdog.",7) != 0 || length + 2 > (size_t)MAX_NAME )
+		{
+			continue;
+		}
+
+		name[0] = '/';
+		memcpy(name + 1,entry->d_name,length + 1);
+		found = LiveMetrics::Attach(name);
+		if( found != NULL && !IsRunning(found->pid) )
+		{// Left behind by a process that was killed.
+			LiveMetrics::Detach(found);
+			found = NULL;
+		}
+	}
+	closedir(dir);
+	return found;
+}
+
+/**
+ * @return The frame time in ms that percent of frames were at or under, to the histogram's 1ms resolution.
+ */
+static int GetPercentile(const LiveMetricsData& data,float percent)
+{
+	uint64_t total = 0;
+	for( int n = 0 ; n < LiveMetricsData::HISTOGRAM_BUCKETS ; n++ )
+	{
+		total += data.histogram[n];
+	}
+
+	const uint64_t wanted = (uint64_t)(total * percent / 100.0f);
+	uint64_t count = 0;
+	for( int n = 0 ; n < LiveMetricsData::HISTOGRAM_BUCKETS ; n++ )
+	{
+		count += data.histogram[n];
+		if( count > wanted )
+		{
+			return n + 1;
+		}
+	}
+	return LiveMetricsData::HISTOGRAM_BUCKETS;
+}
+
+static void PrintReport(const char* name,uint32_t pid,const LiveMetricsData& data)
+{
+	const float stale = (float)(NowNanoseconds() - data.timestamp) / 1000000000.0f;
+	printf("%s pid %u frame %llu%s\n",name,pid,(unsigned long long)data.frameCount,
+			!IsRunning(pid) ? "  NOT RUNNING" : (stale > 2.0f ? "  NOT UPDATING" : ""));
+	printf("FPS %.1f frame %.2fms average %.2fms worst %.2fms p50 %dms p95 %dms p99 %dms\n",
+			data.averageMilliseconds > 0.0f ? 1000.0f / data.averageMilliseconds : 0.0f,
+			data.frameMilliseconds,data.averageMilliseconds,data.worstMilliseconds,
+			GetPercentile(data,50.0f),GetPercentile(data,95.0f),GetPercentile(data,99.0f));
+
+	const FrameStats& f = data.lastFrame;
+	printf("draws %u tris %u verts %u programs %u textures %u uniforms %u uploads %.1fKB buffer %.1fKB texture swap %.2fms\n",
+			f.drawCalls,f.triangles,f.vertices,f.programSwitches,f.textureBinds,f.uniformUploads,
+			f.bufferBytes / 1024.0f,f.textureBytes / 1024.0f,f.swapMilliseconds);
+
+	printf("heap %.2fMB\n",data.heapBytes / (1024.0f * 1024.0f));
+	for( int n = 0 ; n < RESOURCE_CATEGORY_COUNT ; n++ )
+	{
+		printf("%-16s %5u %10.2fMB high %10.2fMB\n",GLResources::GetCategoryName((ResourceCategory)n),data.resourceCount[n],
+				data.resourceBytes[n] / (1024.0f * 1024.0f),data.resourceHighWater[n] / (1024.0f * 1024.0f));
+	}
+
+	// Rows of 10ms, the last row has everything 90ms and over.
+	const int perRow = LiveMetricsData::HISTOGRAM_BUCKETS / HISTOGRAM_ROWS;
+	uint32_t rows[HISTOGRAM_ROWS] = {0};
+	uint32_t most = 1;
+	for( int n = 0 ; n < LiveMetricsData::HISTOGRAM_BUCKETS ; n++ )
+	{
+		rows[n / perRow] += data.histogram[n];
+	}
+	for( int n = 0 ; n < HISTOGRAM_ROWS ; n++ )
+	{
+		most = rows[n] > most ? rows[n] : most;
+	}
+	for( int n = 0 ; n < HISTOGRAM_ROWS ; n++ )
+	{
+		char bar[BAR_WIDTH + 1];
+		const int length = (int)((uint64_t)rows[n] * BAR_WIDTH / most);
+		memset(bar,'#',length);
+		bar[length] = 0;
+		printf("%3d-%-3dms %8u %s\n",n * perRow,(n + 1) * perRow - 1,rows[n],bar);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	char name[MAX_NAME] = "";
+	bool once = false;
+	int interval = 1000;
+
+	for( int n = 1 ; n < argc ; n++ )
+	{
+		if( strcmp(argv[n],"-once") == 0 )
+		{
+			once = true;
+		}
+		else if( strcmp(argv[n],"-interval") == 0 && n + 1 < argc )
+		{
+			interval = atoi(argv[++n]);
+		}
+		else
+		{
+			snprintf(name,MAX_NAME,"%s%s",argv[n][0] == '/' ? "" : "/",argv[n]);
+		}
+	}
+
+	const LiveMetricsSegment* segment = NULL;
+	if( name[0] == 0 )
+	{
+		segment = FindSegment(name);
+		if( segment == NULL )
+		{
+			printf("No BogDog process is publishing metrics, start one with BD_METRICS=1\n");
+			return 1;
+		}
+	}
+	else
+	{
+		segment = LiveMetrics::Attach(name);
+		if( segment == NULL )
+		{
+			printf("Could not open %s\n",name);
+			return 1;
+		}
+	}
+
+	for(;;)
+	{
+		LiveMetricsData data;
+		if( LiveMetrics::Read(segment,data) )
+		{
+			if( !once )
+			{
+				printf("\033[H\033[2J");
+			}
+			PrintReport(name,segment->pid,data);
+			fflush(stdout);
+		}
+
+		if( once )
+		{
+			break;
+		}
+		usleep(interval * 1000);
+	}
+
+	LiveMetrics::Detach(segment);
+	return 0;
+}
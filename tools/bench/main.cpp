@@ -0,0 +1,566 @@
+/*
+ * main.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *
+ *  BogDog GLES 2.0 3D Engine for Raspberry Pi
+ *	Copyright (C) 2012  Richard e Collins
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ * 	You should have received a copy of the GNU General Public License along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Rendering throughput benchmarks, build with Bench.proj.
+ * Runs headless by default so it works on machines without a display, -display draws to the screen instead.
+ * Build the null-GLES configuration to measure only the engine's CPU cost, see NullGL.h.
+ * Results are written as JSON, one result per line, and can be compared to a stored run with -baseline.
+ *
+ * bench [-display] [-seconds 1.0] [-out bench.json] [-baseline base.json] [-tolerance 10]
+ * Exits with 2 if any result is worse than the baseline by more than the tolerance, as a percentage.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "BogDog.h"
+
+struct BenchResult
+{
+	char name[32];
+	int param;
+	double value;
+	char unit[16];
+	bool higherIsBetter;
+};
+
+struct Bench
+{
+	BogDog::OpenGLES_2_0& gl;
+	BogDog::View view;
+	double seconds;
+	BogDog::DynamicBuffer<BenchResult,32,32> results;
+
+	Bench(BogDog::OpenGLES_2_0& pGL,double pSeconds) : gl(pGL),seconds(pSeconds)
+	{
+		view.SetFrustum(40.0f,gl.GetAspectRatio(),0.1f,100.0f);
+		view.SetCamera(0,0,-40,0,0,0);
+	}
+
+	static double Now()
+	{
+		timespec t;
+		clock_gettime(CLOCK_MONOTONIC,&t);
+		return (double)t.tv_sec + ((double)t.tv_nsec / 1000000000.0);
+	}
+
+	void Add(const char* name,int param,double value,const char* unit,bool higherIsBetter)
+	{
+		BenchResult* r = results.PushBack();
+		strncpy(r->name,name,sizeof(r->name)-1);
+		r->name[sizeof(r->name)-1] = 0;
+		strncpy(r->unit,unit,sizeof(r->unit)-1);
+		r->unit[sizeof(r->unit)-1] = 0;
+		r->param = param;
+		r->value = value;
+		r->higherIsBetter = higherIsBetter;
+		printf("  %-16s %8d %14.2f %s\n",name,param,value,unit);
+	}
+
+	/**
+	 * Draws count boxes spread over the screen, switching between the two shaders and textures every draw when asked.
+	 * The shaders must be the same type, they only differ in the program object.
+	 */
+	void DrawBoxes(BogDog::Mesh* mesh,int count,BogDog::GLShader* shaderA,BogDog::GLShader* shaderB,GLint texA,GLint texB,bool switchBlend)
+	{
+		const BogDog::Matrix& projInvcam = view.GetProjectionCameraMatrix();
+		BogDog::Matrix transform;
+		transform.SetIdentity();
+		BogDog::GLShader* current = NULL;
+		BogDog::GLStateCache& cache = BogDog::OpenGLES_2_0::GetStateCache();
+
+		for( int n = 0 ; n < count ; n++ )
+		{
+			BogDog::GLShader* shader = (n&1) ? shaderB : shaderA;
+			if( shader != current )
+			{
+				current = shader;
+				current->Enable(projInvcam);
+				mesh->Enable(current);
+			}
+
+			if( texA )
+			{
+				current->setTexture(0,(n&1) ? texB : texA);
+			}
+
+			if( switchBlend )
+			{
+				if( n&1 )
+					cache.SetBlend(true,GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+				else
+					cache.SetBlend(false,GL_ONE,GL_ZERO);
+			}
+
+			transform[3].x = (float)((n % 31) - 15);
+			transform[3].y = (float)(((n / 31) % 31) - 15);
+			current->setTransform(transform);
+			current->setGlobalColour(1,1,1,1);
+			mesh->Draw();
+		}
+		cache.SetBlend(false,GL_ONE,GL_ZERO);
+	}
+
+	/**
+	 * Draws frames of count boxes for the benchmark time, returns the seconds per frame.
+	 */
+	double TimeBoxes(BogDog::Mesh* mesh,int count,BogDog::GLShader* shaderA,BogDog::GLShader* shaderB,GLint texA = 0,GLint texB = 0,bool switchBlend = false)
+	{
+		// One frame to warm up, the driver may compile and upload on first use.
+		gl.Clear(0);
+		DrawBoxes(mesh,count,shaderA,shaderB,texA,texB,switchBlend);
+		gl.Update();
+		glFinish();
+
+		// At least one frame is timed so the result is never a divide by zero.
+		int frames = 0;
+		const double start = Now();
+		double elapsed = 0;
+		while( elapsed < seconds || frames == 0 )
+		{
+			gl.Clear(0);
+			DrawBoxes(mesh,count,shaderA,shaderB,texA,texB,switchBlend);
+			gl.Update();
+			frames++;
+			if( (frames&7) == 0 )
+			{
+				glFinish();
+				elapsed = Now() - start;
+			}
+		}
+		glFinish();
+		return (Now() - start) / frames;
+	}
+
+	void DrawsPerSecond()
+	{
+		printf("Draws per second vs object count\n");
+		BogDog::GLShaderColour* shader = BogDog::GLShaderColour::Allocate();
+		BogDog::ShapeBuilder* builder = BogDog::ShapeBuilder::MakeBox(0.7f,0.7f,0.7f);
+		BogDog::Mesh* box = builder->BuildMesh(true,false);
+
+		const int counts[] = {1,10,100,1000};
+		for( int count : counts )
+		{
+			Add("draws",count,count / TimeBoxes(box,count,shader,shader),"draws/s",true);
+		}
+
+		delete box;
+		delete builder;
+		delete shader;
+	}
+
+	/**
+	 * A flat grid of size by size quads, size is at most 255 so the vertices can be indexed with 16 bits.
+	 */
+	static BogDog::Mesh* MakeGrid(int size)
+	{
+		BogDog::ShapeBuilder builder;
+		const float step = 20.0f / size;
+		for( int y = 0 ; y <= size ; y++ )
+		{
+			for( int x = 0 ; x <= size ; x++ )
+			{
+				builder.addVertex((x * step) - 10.0f,(y * step) - 10.0f,0.0f);
+			}
+		}
+
+		const int row = size + 1;
+		for( int y = 0 ; y < size ; y++ )
+		{
+			for( int x = 0 ; x < size ; x++ )
+			{
+				const int v = (y * row) + x;
+				builder.addQuad(v,v+1,v+row+1,v+row,(int)0xff808080);
+			}
+		}
+		return builder.BuildMesh(true,false);
+	}
+
+	void TrianglesPerSecond()
+	{
+		printf("Triangles per second vs mesh size\n");
+		BogDog::GLShaderColour* shader = BogDog::GLShaderColour::Allocate();
+		const int sizes[] = {8,32,128,250};
+		for( int size : sizes )
+		{
+			BogDog::Mesh* grid = MakeGrid(size);
+			const int triangles = grid->getTriangleCount();
+			Add("triangles",triangles,(triangles * 4) / TimeBoxes(grid,4,shader,shader),"tris/s",true);
+			delete grid;
+		}
+		delete shader;
+	}
+
+	/**
+	 * The cost of a change is the extra time a frame takes when every draw changes the state, over the same draws without.
+	 */
+	void StateChangeCost(BogDog::GLShaderColourTex* texShader,BogDog::Mesh* texBox,GLint texA,GLint texB)
+	{
+		printf("State change cost\n");
+		const int count = 1000;
+		BogDog::GLShaderColour* shader = BogDog::GLShaderColour::Allocate();
+		BogDog::ShapeBuilder* builder = BogDog::ShapeBuilder::MakeBox(0.7f,0.7f,0.7f);
+		BogDog::Mesh* box = builder->BuildMesh(true,false);
+
+		const double same = TimeBoxes(box,count,shader,shader);
+		const double blend = TimeBoxes(box,count,shader,shader,0,0,true);
+		Add("state_blend",count,((blend - same) * 1000000000.0) / count,"ns/change",false);
+
+		const double sameTex = TimeBoxes(texBox,count,texShader,texShader,texA,texA);
+		const double switchTex = TimeBoxes(texBox,count,texShader,texShader,texA,texB);
+		Add("state_texture",count,((switchTex - sameTex) * 1000000000.0) / count,"ns/change",false);
+
+		delete box;
+		delete builder;
+		delete shader;
+	}
+
+	void ShaderSwitchCost()
+	{
+		printf("Shader switch cost\n");
+		const int count = 1000;
+		BogDog::GLShaderColour* shaderA = BogDog::GLShaderColour::Allocate();
+		BogDog::GLShaderColour* shaderB = BogDog::GLShaderColour::Allocate();
+		BogDog::ShapeBuilder* builder = BogDog::ShapeBuilder::MakeBox(0.7f,0.7f,0.7f);
+		BogDog::Mesh* box = builder->BuildMesh(true,false);
+
+		const double same = TimeBoxes(box,count,shaderA,shaderA);
+		const double switched = TimeBoxes(box,count,shaderA,shaderB);
+		Add("shader_switch",count,((switched - same) * 1000000000.0) / count,"ns/switch",false);
+
+		delete box;
+		delete builder;
+		delete shaderB;
+		delete shaderA;
+	}
+
+	void TextureUpload()
+	{
+		printf("Texture upload bandwidth\n");
+		const int sizes[] = {64,256,1024};
+		for( int size : sizes )
+		{
+			const size_t bytes = (size_t)size * size * 4;
+			uint8_t* pixels = new uint8_t[bytes];
+			for( size_t n = 0 ; n < bytes ; n++ )
+			{
+				pixels[n] = (uint8_t)(n * 7);
+			}
+
+			GLuint tex = gl.CreateTexture(BogDog::TEX_R8G8B8A8,size,size,pixels,false,false,true);
+			BogDog::OpenGLES_2_0::GetStateCache().BindTexture(0,tex);
+			glFinish();
+
+			int uploads = 0;
+			const double start = Now();
+			double elapsed = 0;
+			while( elapsed < seconds || uploads == 0 )
+			{
+				pixels[uploads&1023]++;// So the driver can not skip it.
+				glTexSubImage2D(GL_TEXTURE_2D,0,0,0,size,size,GL_RGBA,GL_UNSIGNED_BYTE,pixels);
+				uploads++;
+				if( (uploads&3) == 0 )
+				{
+					glFinish();
+					elapsed = Now() - start;
+				}
+			}
+			glFinish();
+			elapsed = Now() - start;
+			Add("texture_upload",size,((double)bytes * uploads) / (elapsed * 1024.0 * 1024.0),"MB/s",true);
+
+			gl.DeleteTexture(tex);
+			delete []pixels;
+		}
+	}
+
+	/**
+	 * Works out and records a frame of count spinning boxes, the simulation side of ThreadedFrames.
+	 */
+	static void RecordBoxes(BogDog::CommandBuffer& commands,BogDog::GLShader* shader,BogDog::Mesh* mesh,int count,int frame)
+	{
+		commands.UseShader(shader);
+		commands.BindMesh(mesh);
+
+		BogDog::Matrix transform;
+		for( int n = 0 ; n < count ; n++ )
+		{
+			const Angle a = (Angle)((frame * 200) + (n * 100));
+			transform.SetRotation(a,a*3,a*2);
+			transform[3].x = (float)((n % 31) - 15);
+			transform[3].y = (float)(((n / 31) % 31) - 15);
+			commands.DrawMesh(mesh,transform,1.0f,(n % 5) * 0.25f,1.0f,1.0f);
+		}
+	}
+
+	/**
+	 * The same frames recorded into a CommandBuffer and drawn on this thread after each one, then handed to a RenderThread
+	 * so the next frame is recorded while this one is drawn. Threaded only wins when there is a spare core.
+	 */
+	void ThreadedFrames()
+	{
+		printf("Serial vs threaded frame time\n");
+		const int count = 961;
+		BogDog::GLShaderColour* shader = BogDog::GLShaderColour::Allocate();
+		BogDog::ShapeBuilder* builder = BogDog::ShapeBuilder::MakeBox(0.7f,0.7f,0.7f);
+		BogDog::Mesh* box = builder->BuildMesh(true,false);
+		const BogDog::Matrix& projInvcam = view.GetProjectionCameraMatrix();
+
+		BogDog::CommandBuffer commands;
+		RecordBoxes(commands,shader,box,count,0);
+		gl.Clear(0);
+		commands.Execute(projInvcam);
+		gl.Update();
+		glFinish();
+
+		int frames = 0;
+		double start = Now();
+		double elapsed = 0;
+		while( elapsed < seconds || frames == 0 )
+		{
+			commands.Reset();
+			RecordBoxes(commands,shader,box,count,frames);
+			gl.Clear(0);
+			commands.Execute(projInvcam);
+			gl.Update();
+			frames++;
+			if( (frames&7) == 0 )
+			{
+				glFinish();
+				elapsed = Now() - start;
+			}
+		}
+		glFinish();
+		Add("frame_serial",count,((Now() - start) * 1000.0) / frames,"ms/frame",false);
+
+		BogDog::RenderThread renderThread(gl,2);
+		if( renderThread.Start() )
+		{
+			frames = 0;
+			start = Now();
+			while( Now() - start < seconds || frames == 0 )
+			{
+				BogDog::RenderFrame* frame = renderThread.BeginFrame();
+				frame->projInvcam = projInvcam;
+				frame->clearColour = 0;
+				RecordBoxes(frame->commands,shader,box,count,frames);
+				renderThread.SubmitFrame(frame);
+				frames++;
+			}
+			renderThread.Stop();
+			glFinish();
+			Add("frame_threaded",count,((Now() - start) * 1000.0) / frames,"ms/frame",false);
+		}
+
+		delete box;
+		delete builder;
+		delete shader;
+	}
+
+	void Run()
+	{
+		DrawsPerSecond();
+		TrianglesPerSecond();
+
+		BogDog::GLShaderColourTex* texShader = BogDog::GLShaderColourTex::Allocate();
+		BogDog::ShapeBuilder* builder = BogDog::ShapeBuilder::MakeBox(0.7f,0.7f,0.7f);
+		BogDog::Mesh* texBox = builder->BuildMesh(true,true);
+		const uint32_t white[4] = {0xffffffff,0xffffffff,0xffffffff,0xffffffff};
+		const uint32_t grey[4] = {0xff808080,0xff808080,0xff808080,0xff808080};
+		GLint texA = gl.CreateTexture(BogDog::TEX_R8G8B8A8,2,2,white,false,false,true);
+		GLint texB = gl.CreateTexture(BogDog::TEX_R8G8B8A8,2,2,grey,false,false,true);
+
+		StateChangeCost(texShader,texBox,texA,texB);
+
+		gl.DeleteTexture(texB);
+		gl.DeleteTexture(texA);
+		delete texBox;
+		delete builder;
+		delete texShader;
+
+		ShaderSwitchCost();
+		TextureUpload();
+		ThreadedFrames();
+		CHECK_OGL_ERRORS();
+	}
+
+	bool WriteJSON(const char* filename)
+	{
+		FILE* file = fopen(filename,"w");
+		if( file == NULL )
+		{
+			printf("Failed to open %s for writing\n",filename);
+			return false;
+		}
+
+		fprintf(file,"{\n");
+		fprintf(file,"  \"renderer\": \"%s\",\n",(const char*)glGetString(GL_RENDERER));
+		fprintf(file,"  \"width\": %d,\n  \"height\": %d,\n  \"seconds\": %g,\n",gl.GetWidth(),gl.GetHeight(),seconds);
+		fprintf(file,"  \"results\": [\n");
+		for( size_t n = 0 ; n < results.GetSize() ; n++ )
+		{
+			const BenchResult& r = results[n];
+			fprintf(file,"    {\"name\": \"%s\", \"param\": %d, \"value\": %.3f, \"unit\": \"%s\", \"higher_is_better\": %s}%s\n",
+					r.name,r.param,r.value,r.unit,r.higherIsBetter ? "true" : "false",n + 1 < results.GetSize() ? "," : "");
+		}
+		fprintf(file,"  ]\n}\n");
+		fclose(file);
+		printf("Results written to %s\n",filename);
+		return true;
+	}
+
+	/**
+	 * Reads the results of a file written by WriteJSON and prints how this run compares.
+	 * @return The number of results worse than the baseline by more than tolerance percent, -1 if the file could not be read.
+	 */
+	int CompareBaseline(const char* filename,double tolerance)
+	{
+		FILE* file = fopen(filename,"r");
+		if( file == NULL )
+		{
+			printf("Failed to open baseline %s\n",filename);
+			return -1;
+		}
+
+		BogDog::DynamicBuffer<BenchResult,32,32> baseline;
+		char line[512];
+		while( fgets(line,sizeof(line),file) )
+		{
+			BenchResult r;
+			const char* start = strstr(line,"{\"name\"");
+			if( start && sscanf(start,"{\"name\": \"%31[^\"]\", \"param\": %d, \"value\": %lf",r.name,&r.param,&r.value) == 3 )
+			{
+				baseline.PushBack(r);
+			}
+		}
+		fclose(file);
+
+		printf("Compared to %s, tolerance %.1f%%\n",filename,tolerance);
+		int regressions = 0;
+		for( size_t n = 0 ; n < results.GetSize() ; n++ )
+		{
+			const BenchResult& r = results[n];
+			const BenchResult* base = NULL;
+			for( size_t b = 0 ; b < baseline.GetSize() && base == NULL ; b++ )
+			{
+				if( baseline[b].param == r.param && strcmp(baseline[b].name,r.name) == 0 )
+					base = &baseline[b];
+			}
+
+			if( base == NULL )
+			{
+				printf("  %-16s %8d not in baseline\n",r.name,r.param);
+				continue;
+			}
+
+			// Costs near zero give silly percentages, so they are compared to the larger of the two.
+			const double scale = fabs(base->value) > fabs(r.value) ? fabs(base->value) : fabs(r.value);
+			double better = scale > 0.0 ? ((r.value - base->value) * 100.0) / scale : 0.0;
+			if( !r.higherIsBetter )
+				better = -better;
+
+			const bool regressed = better < -tolerance;
+			if( regressed )
+				regressions++;
+
+			printf("  %-16s %8d %14.2f -> %14.2f %s %+7.1f%%%s\n",r.name,r.param,base->value,r.value,r.unit,better,regressed ? " REGRESSION" : "");
+		}
+		printf("%d regressions\n",regressions);
+		return regressions;
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	bool display = false;
+	double seconds = 1.0;
+	double tolerance = 10.0;
+	const char* outFile = "bench.json";
+	const char* baselineFile = NULL;
+	for( int arg = 1 ; arg < argc ; arg++ )
+	{
+		if( strcmp(argv[arg],"-display") == 0 )
+		{
+			display = true;
+		}
+		else if( strcmp(argv[arg],"-seconds") == 0 && arg + 1 < argc )
+		{
+			char* end;
+			seconds = strtod(argv[++arg],&end);
+			if( end == argv[arg] || *end != 0 || !(seconds > 0.0) || isinf(seconds) )
+			{
+				printf("-seconds must be a number greater than 0, not %s\n",argv[arg]);
+				return 1;
+			}
+		}
+		else if( strcmp(argv[arg],"-out") == 0 && arg + 1 < argc )
+		{
+			outFile = argv[++arg];
+		}
+		else if( strcmp(argv[arg],"-baseline") == 0 && arg + 1 < argc )
+		{
+			baselineFile = argv[++arg];
+		}
+		else if( strcmp(argv[arg],"-tolerance") == 0 && arg + 1 < argc )
+		{
+			tolerance = atof(argv[++arg]);
+		}
+		else
+		{
+			printf("Usage: bench [-display] [-seconds 1.0] [-out bench.json] [-baseline base.json] [-tolerance 10]\n");
+			return 1;
+		}
+	}
+
+	BogDog::OpenGLES_2_0 gl;
+	if( (display ? gl.Create(false) : gl.CreateHeadless(640,480)) == false )
+	{
+		return 1;
+	}
+
+	Bench bench(gl,seconds);
+	bench.Run();
+
+#ifdef PLATFORM_NULL
+	// Only the engine's CPU cost was measured, show what it asked of GL.
+	BogDog::NullGL::PrintReport();
+#endif
+
+	if( !bench.WriteJSON(outFile) )
+	{
+		return 1;
+	}
+
+	if( baselineFile != NULL )
+	{
+		const int regressions = bench.CompareBaseline(baselineFile,tolerance);
+		if( regressions < 0 )
+			return 1;
+		if( regressions > 0 )
+			return 2;
+	}
+	return 0;
+}